@@ -0,0 +1,148 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef PFS_CPU_USAGE_HPP
+#define PFS_CPU_USAGE_HPP
+
+#include <vector>
+
+#include "types.hpp"
+
+namespace pfs {
+
+// The share of time spent in every state [unit: percent]
+// Guest time is also accounted in 'user' and 'nice', as the kernel does.
+struct cpu_utilization
+{
+    double user       = 0;
+    double nice       = 0;
+    double system     = 0;
+    double idle       = 0;
+    double iowait     = 0;
+    double irq        = 0;
+    double softirq    = 0;
+    double steal      = 0;
+    double guest      = 0;
+    double guest_nice = 0;
+
+    // Anything but idle and iowait
+    double busy = 0;
+};
+
+// Statistics of one utilization field over the samples in the history
+struct cpu_usage_window
+{
+    size_t samples = 0;
+    double min     = 0;
+    double max     = 0;
+    double mean    = 0;
+    double p95     = 0;
+};
+
+/*
+ * Compute the per-CPU and total utilization out of successive samples of
+ * the CPU times (e.g. 'procfs::get_stat(stat, proc_stat::section::CPUS)').
+ *
+ * Every update is compared to the previous one. CPUs are identified by
+ * their id, so CPUs going offline and online are handled: a CPU that shows
+ * up (again) starts with a baseline, and reports no utilization until its
+ * next sample. Same for counters that went backwards.
+ *
+ * The last 'history' utilizations of every CPU are kept in a ring buffer,
+ * for computing statistics over a rolling window.
+ * Memory is only allocated when a CPU with a higher id than seen before
+ * shows up, so sampling at a fixed set of CPUs doesn't allocate.
+ * Not thread-safe.
+ */
+class cpu_usage_tracker final
+{
+public:
+    explicit cpu_usage_tracker(size_t history = 60);
+
+    cpu_usage_tracker(const cpu_usage_tracker&) = default;
+    cpu_usage_tracker(cpu_usage_tracker&&)      = default;
+
+    cpu_usage_tracker& operator=(const cpu_usage_tracker&) = default;
+    cpu_usage_tracker& operator=(cpu_usage_tracker&&) = default;
+
+public: // API
+    void update(const proc_stat& stat);
+    void update(const proc_stat::sequence<proc_stat::cpu>& cpus);
+
+    // The utilization over the interval between the last two samples
+    const cpu_utilization& total() const;
+
+    // Throws std::out_of_range for ids that were never seen
+    const cpu_utilization& get_cpu(int id) const;
+
+    // One more than the highest CPU id seen
+    size_t cpus() const;
+
+    // Whether the CPU was part of the last sample
+    bool is_online(int id) const;
+
+    // Statistics of a single field (e.g. '&cpu_utilization::busy') over the
+    // last 'samples' utilizations (or all of them, when 0).
+    cpu_usage_window get_total_window(double cpu_utilization::*field,
+                                      size_t samples = 0) const;
+    cpu_usage_window get_cpu_window(int id, double cpu_utilization::*field,
+                                    size_t samples = 0) const;
+
+    size_t history() const;
+
+private:
+    struct cpu_state
+    {
+        proc_stat::cpu last;
+        bool has_last = false; // Whether 'last' is a valid baseline
+        bool online   = false;
+
+        cpu_utilization current;
+
+        // The ring buffer, in the shared history storage
+        size_t head  = 0; // The next slot to write
+        size_t count = 0;
+    };
+
+private:
+    void update_state(cpu_state& state, const proc_stat::cpu& cpu,
+                      cpu_utilization* history);
+
+    const cpu_state& get_state(int id) const;
+
+    cpu_usage_window compute_window(const cpu_state& state,
+                                    const cpu_utilization* history,
+                                    double cpu_utilization::*field,
+                                    size_t samples) const;
+
+private:
+    size_t _history;
+
+    cpu_state _total;
+    std::vector<cpu_utilization> _total_history;
+
+    std::vector<cpu_state> _cpus; // By id
+    // 'history' slots per CPU, by id
+    std::vector<cpu_utilization> _cpus_history;
+
+    // For computing percentiles without allocating
+    mutable std::vector<double> _scratch;
+};
+
+} // namespace pfs
+
+#endif // PFS_CPU_USAGE_HPP
@@ -46,16 +46,20 @@ public: // Getters
     std::string get_target() const;
     struct stat get_target_stat() const;
 
+    fd_info get_info() const;
+
 private:
     friend class task;
-    fd(const std::string& fds_root, int num);
+    fd(const std::string& task_root, int num);
 
 private:
-    static std::string build_link_path(const std::string& fds_root, int num);
+    static std::string build_link_path(const std::string& task_root, int num);
+    static std::string build_info_path(const std::string& task_root, int num);
 
 private:
     const int _num;
     const std::string _link;
+    const std::string _info;
 };
 
 } // namespace pfs
@@ -0,0 +1,65 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef PFS_KPAGE_TABLE_HPP
+#define PFS_KPAGE_TABLE_HPP
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "types.hpp"
+
+namespace pfs {
+
+/*
+ * An API to the physical page tables /proc/kpageflags and /proc/kpagecount.
+ * Both files hold a 64-bit value per PFN, and can only be read with
+ * CAP_SYS_ADMIN. See proc(5) for more information.
+ */
+class kpage_table final
+{
+public:
+    kpage_table(const kpage_table&) = delete;
+    kpage_table(kpage_table&& other);
+
+    kpage_table& operator=(const kpage_table&) = delete;
+    kpage_table& operator=(kpage_table&&) = delete;
+
+    ~kpage_table();
+
+public: // API
+    uint64_t read(uint64_t pfn);
+
+    // Return the value for every page, in the same order.
+    // Pages that are not present (Or whose PFN is hidden) get a zero value.
+    // Consecutive PFNs are fetched using a single read.
+    std::vector<uint64_t> read(const std::vector<pagemap_entry>& pages);
+
+private:
+    friend class procfs;
+    kpage_table(const std::string& path);
+
+private:
+    const std::string _path;
+    int _fd;
+};
+
+} // namespace pfs
+
+#endif // PFS_KPAGE_TABLE_HPP
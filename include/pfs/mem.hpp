@@ -42,6 +42,11 @@ public: // API
     std::vector<uint8_t> read(const mem_region& region);
     std::vector<uint8_t> read(loff_t offset, size_t len);
 
+    // Read multiple regions, one read per region.
+    // Useful with the output of pagemap::read_soft_dirty.
+    std::vector<std::vector<uint8_t>>
+    read(const std::vector<mem_region>& regions);
+
 private:
     friend class task;
     mem(const std::string& path);
@@ -18,11 +18,14 @@
 #define PFS_NET_HPP
 
 #include <functional>
+#include <iosfwd>
 #include <string>
 #include <vector>
 
 #include "types.hpp"
 #include "filter.hpp"
+#include "net_dev_sampler.hpp"
+#include "route_table.hpp"
 
 namespace pfs {
 
@@ -48,11 +51,32 @@ public:
     using netlink_socket_filter = std::function<filter::action(const netlink_socket&)>;
     using unix_socket_filter = std::function<filter::action(const unix_socket&)>;
     using net_route_filter = std::function<filter::action(const net_route&)>;
+    using net_ipv6_route_filter = std::function<filter::action(const net_ipv6_route&)>;
     using net_arp_filter = std::function<filter::action(const net_arp&)>;
+    using conntrack_handler = std::function<void(const conntrack_entry&)>;
+
+    // Where TCP, UDP and unix sockets are collected from.
+    // 'sock_diag' is much faster on hosts with many sockets, and works
+    // unprivileged, but only for the network namespace of the caller.
+    // 'automatic' uses sock_diag when possible, and falls back to the
+    // text files otherwise.
+    // Note: Some fields, such as skbuff and ref_count, are not reported by
+    // sock_diag, and are left zeroed.
+    enum class backend
+    {
+        automatic,
+        procfs,
+        sock_diag,
+    };
 
 public:
+    void set_backend(backend b);
+
     std::vector<net_device> get_dev(net_device_filter filter = nullptr) const;
 
+    // Open the dev file for sampling it repeatedly (See net_dev_sampler)
+    net_dev_sampler get_dev_sampler() const;
+
     std::vector<net_socket> get_icmp(net_socket_filter filter = nullptr) const;
     std::vector<net_socket> get_icmp6(net_socket_filter filter = nullptr) const;
     std::vector<net_socket> get_raw(net_socket_filter filter = nullptr) const;
@@ -61,6 +85,30 @@ public:
     std::vector<net_socket> get_tcp6(net_socket_filter filter = nullptr) const;
     std::vector<net_socket> get_udp(net_socket_filter filter = nullptr) const;
     std::vector<net_socket> get_udp6(net_socket_filter filter = nullptr) const;
+
+    // Same as above, but only sockets that match the query are collected.
+    // When using sock_diag, the query is checked by the kernel itself.
+    std::vector<net_socket> get_tcp(const net_socket_query& query,
+                                    net_socket_filter filter = nullptr) const;
+    std::vector<net_socket> get_tcp6(const net_socket_query& query,
+                                     net_socket_filter filter = nullptr) const;
+    std::vector<net_socket> get_udp(const net_socket_query& query,
+                                    net_socket_filter filter = nullptr) const;
+    std::vector<net_socket> get_udp6(const net_socket_query& query,
+                                     net_socket_filter filter = nullptr) const;
+
+    // Same as above, but the sockets replace the content of 'table'.
+    // Reusing a table across calls avoids allocating per collection, and
+    // the text files are parsed in place, without allocating per line.
+    void collect_tcp(net_socket_table& table,
+                     const net_socket_query& query = net_socket_query()) const;
+    void collect_tcp6(net_socket_table& table,
+                      const net_socket_query& query = net_socket_query()) const;
+    void collect_udp(net_socket_table& table,
+                     const net_socket_query& query = net_socket_query()) const;
+    void collect_udp6(net_socket_table& table,
+                      const net_socket_query& query = net_socket_query()) const;
+
     std::vector<net_socket> get_udplite(net_socket_filter filter = nullptr) const;
     std::vector<net_socket> get_udplite6(net_socket_filter filter = nullptr) const;
 
@@ -68,10 +116,57 @@ public:
 
     std::vector<unix_socket> get_unix(unix_socket_filter filter = nullptr) const;
 
+    // Same as above, but only sockets that match the query are collected.
+    // When using sock_diag, the states are checked by the kernel itself, and
+    // the extra information requested by the query is collected as well.
+    std::vector<unix_socket> get_unix(const unix_socket_query& query,
+                                      unix_socket_filter filter = nullptr) const;
+
+    // Aggregate the tcp_info of every TCP socket into per-group histograms.
+    // Sockets are aggregated while they are received, and never collected.
+    // Requires sock_diag, and throws std::runtime_error when it can't be used.
+    std::vector<tcp_health> get_tcp_health(
+        const tcp_health_options& options = tcp_health_options()) const;
+
     std::vector<net_route> get_route(net_route_filter filter = nullptr) const;
 
+    std::vector<net_ipv6_route> get_ipv6_route(
+        net_ipv6_route_filter filter = nullptr) const;
+
+    // Build a longest-prefix-match table out of the IPv4 and IPv6 routes
+    route_table get_route_table() const;
+
     std::vector<net_arp> get_arp(net_arp_filter filter = nullptr) const;
 
+    // Stream the connection tracking table, one entry at a time.
+    // The same entry is reused for every call, so memory usage doesn't
+    // depend on the size of the table. Requires the nf_conntrack module.
+    void for_each_conntrack(const conntrack_handler& handler) const;
+
+    // Aggregate the connection tracking table while it is streamed.
+    // Groups are sorted by the number of entries, in descending order.
+    std::vector<conntrack_summary> get_conntrack_summary(
+        const conntrack_summary_options& options =
+            conntrack_summary_options()) const;
+
+    // Protocol counters, as printed by /proc/net/snmp and /proc/net/netstat.
+    // Only the counters that are part of the output are parsed.
+    net_snmp get_snmp() const;
+    net_netstat get_netstat() const;
+
+    net_sockstat get_sockstat() const;
+    net_sockstat get_sockstat6() const;
+
+    // Read the snmp and netstat counters, along with the time they were read
+    // at. Rates are computed by comparing two samples (see rates_since).
+    net_stats_sample get_stats_sample() const;
+
+    // Per-CPU counters of the packets handled by the networking softirqs
+    std::vector<net_softnet_stat> get_softnet_stat() const;
+
+    // Same as above, along with the time they were read at (See rates_since)
+    net_softnet_sample get_softnet_sample() const;
+
 private:
     friend class task;
     net(const std::string& parent_root);
@@ -80,6 +175,27 @@ private:
     std::vector<net_socket> get_net_sockets(const std::string& file,
             net_socket_filter filter = nullptr) const;
 
+    std::vector<net_socket> get_inet_sockets(const std::string& file,
+            int family, int protocol, const net_socket_query& query,
+            net_socket_filter filter) const;
+
+    // Parse the sockets of a text file that match the query. Lines that
+    // can't match are skipped without being parsed.
+    void parse_inet_sockets(const std::string& file,
+            const net_socket_query& query,
+            const std::function<void(const net_socket&)>& handler) const;
+
+    void collect_inet_sockets(const std::string& file, int family,
+            int protocol, const net_socket_query& query,
+            net_socket_table& table) const;
+
+    bool use_sock_diag() const;
+    bool is_caller_netns() const;
+
+    template <typename T>
+    T parse_counters_file(const std::string& file,
+                          void (*parser)(std::istream&, T&)) const;
+
     static std::string build_net_root(const std::string& parent_root);
 
 private:
@@ -87,6 +203,7 @@ private:
     // be looking at a net namespace of a specific process.
     const std::string _parent_root;
     const std::string _net_root;
+    backend _backend;
 };
 
 } // namespace pfs
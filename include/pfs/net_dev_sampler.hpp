@@ -0,0 +1,113 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef PFS_NET_DEV_SAMPLER_HPP
+#define PFS_NET_DEV_SAMPLER_HPP
+
+#include <stdint.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "types.hpp"
+
+namespace pfs {
+
+// Over the interval between the last two samples [unit: 1/sec]
+struct net_device_rates
+{
+    double rx_bytes   = 0;
+    double rx_packets = 0;
+    double rx_errs    = 0;
+    double rx_drop    = 0;
+    double tx_bytes   = 0;
+    double tx_packets = 0;
+    double tx_errs    = 0;
+    double tx_drop    = 0;
+};
+
+struct net_device_sample
+{
+    net_device counters;
+    net_device_rates rates;
+    // Whether the interface was part of the last sample.
+    // Rates are zero for interfaces that are missing or were just (re)added.
+    bool present;
+};
+
+/*
+ * Sample /proc/net/dev at a high frequency.
+ * Notes:
+ * The file is opened once and re-read using pread, and every sample is
+ * parsed in place into a table that is only extended when a new interface
+ * shows up. Once the interfaces are known, sampling doesn't allocate.
+ * Every interface keeps its index for the lifetime of the sampler, even
+ * if it's removed. Counters are assumed to wrap around at 64 bits.
+ */
+class net_dev_sampler final
+{
+public:
+    net_dev_sampler(const net_dev_sampler&) = delete;
+    net_dev_sampler(net_dev_sampler&& other);
+
+    net_dev_sampler& operator=(const net_dev_sampler&) = delete;
+    net_dev_sampler& operator=(net_dev_sampler&&) = delete;
+
+    ~net_dev_sampler();
+
+public: // API
+    // Read the counters of all the interfaces, and update their rates.
+    // The first sample only sets a baseline, and so does a sample in which
+    // the counters of an interface went backwards (i.e. it was re-created).
+    void sample();
+
+    const std::vector<net_device_sample>& interfaces() const;
+
+    // Return the index of an interface, or 'npos' if it was never seen
+    size_t find(const std::string& interface) const;
+
+    // When the last sample was taken
+    std::chrono::steady_clock::time_point time() const;
+
+    static const size_t npos;
+
+private:
+    friend class net;
+    net_dev_sampler(const std::string& path);
+
+private:
+    // Read the whole file into '_buffer', growing it if needed
+    size_t read_file();
+
+    // Find an interface by name, starting with the index it had last time
+    size_t find(const char* begin, const char* end, size_t hint) const;
+
+private:
+    const std::string _path;
+    int _fd;
+
+    std::vector<char> _buffer;
+    std::vector<net_device_sample> _interfaces;
+    std::vector<char> _was_present; // Scratch, indexed like '_interfaces'
+    std::chrono::steady_clock::time_point _time;
+    bool _sampled;
+};
+
+} // namespace pfs
+
+#endif // PFS_NET_DEV_SAMPLER_HPP
@@ -0,0 +1,89 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef PFS_PAGEMAP_HPP
+#define PFS_PAGEMAP_HPP
+
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+
+#include "types.hpp"
+
+namespace pfs {
+
+/*
+ * An API to /proc/[pid]/pagemap. See proc(5) for more information.
+ * Notes:
+ * The file holds a 64-bit entry per virtual page, so reading a range
+ * translates into a single sequential read of the matching entries.
+ * Since 4.0, reading the PFN requires CAP_SYS_ADMIN (It reads as zero
+ * otherwise), and since 4.2 opening the file requires ptrace access.
+ */
+class pagemap final
+{
+public:
+    pagemap(const pagemap&) = delete;
+    pagemap(pagemap&& other);
+
+    pagemap& operator=(const pagemap&) = delete;
+    pagemap& operator=(pagemap&&) = delete;
+
+    ~pagemap();
+
+public: // API
+    // Return an entry for every page in the range.
+    // Entry 'i' represents the page at 'start_address + i * page_size()'.
+    std::vector<pagemap_entry> read(const mem_region& region);
+    std::vector<pagemap_entry> read(size_t start_address, size_t end_address);
+
+    // Same as 'read', but keeps only the present and swapped bits.
+    // Uses a fixed-size scratch buffer, so memory usage stays low
+    // even when scanning huge regions.
+    page_residency read_residency(const mem_region& region);
+    page_residency read_residency(size_t start_address, size_t end_address);
+
+    // Return the parts of the region whose pages were written since the
+    // soft-dirty bits were last cleared (See task::clear_refs).
+    // Every returned region is a copy of the original one, narrowed down to
+    // a run of consecutive dirty pages, so it can be passed to mem::read.
+    // Runs separated by up to 'max_gap_pages' clean pages are merged, trading
+    // some extra bytes for fewer reads.
+    std::vector<mem_region> read_soft_dirty(const mem_region& region,
+                                            size_t max_gap_pages = 0);
+
+public: // Utilities
+    static size_t page_size();
+
+private:
+    friend class task;
+    pagemap(const std::string& path);
+
+private:
+    // Read entries for 'count' pages starting at page index 'first'.
+    // Returns the number of entries actually read.
+    size_t read_entries(size_t first, size_t count, pagemap_entry* out);
+
+private:
+    const std::string _path;
+    int _fd;
+};
+
+} // namespace pfs
+
+#endif // PFS_PAGEMAP_HPP
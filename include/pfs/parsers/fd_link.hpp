@@ -0,0 +1,42 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef PFS_PARSERS_FD_LINK_HPP
+#define PFS_PARSERS_FD_LINK_HPP
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "pfs/types.hpp"
+
+namespace pfs {
+namespace impl {
+namespace parsers {
+
+// Classify an fd by the target of its link, without touching the target.
+// Sets 'inode' for sockets, pipes and namespaces, and INVALID_INODE otherwise.
+fd_kind parse_fd_link(const char* link, size_t size, ino_t& inode);
+
+// Parse the target of an fd link that refers to a socket ("socket:[<inode>]").
+// Returns false if the link refers to anything else.
+bool parse_socket_link(const char* link, size_t size, ino_t& inode);
+
+} // namespace parsers
+} // namespace impl
+} // namespace pfs
+
+#endif // PFS_PARSERS_FD_LINK_HPP
@@ -18,6 +18,7 @@
 #define PFS_PARSERS_FILE_PARSER_HPP
 
 #include <fstream>
+#include <istream>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -47,6 +48,11 @@ public:
             throw parser_error("Couldn't open file", path);
         }
 
+        return parse(in, keys);
+    }
+
+    Output parse(std::istream& in, const std::set<std::string>& keys = {})
+    {
         Output output;
 
         std::string line;
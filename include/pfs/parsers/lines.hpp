@@ -17,8 +17,10 @@
 #ifndef PFS_PARSERS_GENERIC_HPP
 #define PFS_PARSERS_GENERIC_HPP
 
+#include <cerrno>
 #include <fstream>
 #include <string>
+#include <system_error>
 
 #include "pfs/parser_error.hpp"
 #include "pfs/utils.hpp"
@@ -42,7 +44,8 @@ void parse_file_lines(
     std::ifstream in(path);
     if (!in)
     {
-        throw std::runtime_error("Couldn't open file");
+        throw std::system_error(errno, std::system_category(),
+                                "Couldn't open file");
     }
 
     std::string line;
@@ -19,6 +19,7 @@
 
 #include <string>
 
+#include "pfs/string_pool.hpp"
 #include "pfs/types.hpp"
 
 namespace pfs {
@@ -27,6 +28,9 @@ namespace parsers {
 
 mem_region parse_maps_line(const std::string& line);
 
+compact_mem_region parse_compact_maps_line(const std::string& line,
+                                           string_pool& pool);
+
 } // namespace parsers
 } // namespace impl
 } // namespace pfs
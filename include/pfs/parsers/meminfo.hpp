@@ -20,12 +20,19 @@
 #include <functional>
 #include <string>
 
+#include "pfs/types.hpp"
+
 namespace pfs {
 namespace impl {
 namespace parsers {
 
 std::pair<std::string, size_t> parse_meminfo_line(const std::string& line);
 
+// Parse the whole file into a reusable output. Known keys are mapped to their
+// fields through a static table, and lines are parsed in place, so only
+// unknown keys allocate (and not when the output is reused).
+void parse_meminfo(const std::string& path, meminfo& out);
+
 } // namespace parsers
 } // namespace impl
 } // namespace pfs
@@ -0,0 +1,45 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef PFS_PARSERS_NET_COUNTERS_HPP
+#define PFS_PARSERS_NET_COUNTERS_HPP
+
+#include <istream>
+
+#include "pfs/types.hpp"
+
+namespace pfs {
+namespace impl {
+namespace parsers {
+
+// Parse files of paired header and value lines, e.g.:
+// Tcp: RtoAlgorithm RtoMin RtoMax MaxConn ActiveOpens ...
+// Tcp: 1 200 120000 -1 2016 ...
+// Counters that aren't part of the output are skipped.
+void parse_snmp(std::istream& in, net_snmp& out);
+void parse_netstat(std::istream& in, net_netstat& out);
+
+// Parse files of inline key and value pairs, e.g.:
+// TCP: inuse 4 orphan 0 tw 5 alloc 4 mem 0
+// Works for both sockstat and sockstat6.
+void parse_sockstat(std::istream& in, net_sockstat& out);
+
+} // namespace parsers
+} // namespace impl
+} // namespace pfs
+
+#endif // PFS_PARSERS_NET_COUNTERS_HPP
@@ -27,6 +27,8 @@ namespace parsers {
 
 net_route parse_net_route_line(const std::string& line);
 
+net_ipv6_route parse_net_ipv6_route_line(const std::string& line);
+
 } // namespace parsers
 } // namespace impl
 } // namespace pfs
@@ -18,6 +18,7 @@
 #define PFS_PARSERS_NET_SOCKET_HPP
 
 #include <string>
+#include <vector>
 
 #include "pfs/types.hpp"
 
@@ -27,6 +28,37 @@ namespace parsers {
 
 net_socket parse_net_socket_line(const std::string& line);
 
+// Same as above, but parses the columns of [begin, end) in place, without
+// allocating (unless the line is corrupted).
+void parse_net_socket(const char* begin, const char* end, net_socket& out);
+
+// Checks a query against the raw columns of a net socket line, so that most
+// of the lines that can't match it are skipped without being parsed.
+// The state, the ports and the uid are checked in place. Addresses aren't,
+// so lines that pass still need to be checked against the query once parsed.
+class net_socket_prefilter final
+{
+public:
+    explicit net_socket_prefilter(const net_socket_query& query);
+
+    // False only if the line can't match the query. Lines that seem to be
+    // corrupted pass, so that the parser can report them.
+    bool matches(const char* begin, const char* end) const;
+
+private:
+    using port_set = std::vector<uint64_t>; // A bit per port, or empty
+
+    static port_set make_port_set(const std::vector<uint16_t>& ports);
+    static bool has_port(const port_set& ports, const char* column_begin,
+                         const char* column_end);
+
+private:
+    uint32_t _states; // A bit per state, or 0
+    port_set _local_ports;
+    port_set _remote_ports;
+    std::vector<uid_t> _uids;
+};
+
 } // namespace parsers
 } // namespace impl
 } // namespace pfs
@@ -19,25 +19,19 @@
 
 #include <string>
 
-#include "file_parser.hpp"
 #include "pfs/types.hpp"
 
 namespace pfs {
 namespace impl {
 namespace parsers {
 
-class proc_stat_parser : public file_parser<proc_stat>
-{
-public:
-    proc_stat_parser() : file_parser<proc_stat>(DELIM, PARSERS, key_remap) {}
-
-private:
-    static void key_remap(std::string& key);
-
-private:
-    static const char DELIM;
-    static const value_parsers PARSERS;
-};
+// Parse the sections of the file that are in the mask into a reusable output.
+// The file is read in fixed-size chunks and parsed in place, and the vectors
+// of the output keep their capacity, so parsing into the same output again
+// doesn't allocate. Sections that aren't in the mask are skipped without
+// being parsed, and are reset.
+void parse_proc_stat(const std::string& path, unsigned sections,
+                     proc_stat& out);
 
 } // namespace parsers
 } // namespace impl
@@ -21,9 +21,14 @@
 
 #include <set>
 #include <string>
+#include <system_error>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "cpu_usage.hpp"
+#include "kpage_table.hpp"
 #include "task.hpp"
 #include "types.hpp"
 
@@ -34,6 +39,14 @@ class procfs final
 public:
     static const std::string DEFAULT_ROOT;
 
+    // Where to collect memory mappings from. 'smaps' provides memory usage
+    // information, at a much higher cost.
+    enum class mapping_source
+    {
+        maps,
+        smaps,
+    };
+
 public:
     procfs(const std::string& root = DEFAULT_ROOT);
 
@@ -47,9 +60,54 @@ public: // Task API
     task get_task(int task_id = getpid()) const;
     std::set<task> get_processes() const;
 
+    // Collect the maps of all the processes, using 'workers' threads
+    // (Zero means a thread per hardware thread).
+    // Pathnames are interned into the pool, which can be shared between
+    // calls. Processes that exit or can't be read are skipped.
+    std::unordered_map<int, std::vector<compact_mem_region>>
+    get_processes_maps(string_pool& pool, size_t workers = 0) const;
+
+    // Collect the NUMA placement of all the processes (kB per node, see
+    // task::get_numa_usage), using 'workers' threads, same as
+    // get_processes_maps. Processes that exit or can't be read are skipped.
+    std::unordered_map<int, std::vector<size_t>>
+    get_processes_numa_usage(size_t workers = 0) const;
+
+    // Group the file-backed mappings of all the processes by (device, inode),
+    // to find how much memory every mapped file really costs.
+    // Collection is done using 'workers' threads, same as get_processes_maps.
+    // Objects are sorted by descending PSS, and then by mapped size.
+    std::vector<mapped_object>
+    get_mapped_objects(mapping_source source = mapping_source::smaps,
+                       size_t workers        = 0) const;
+
+    // Map every socket inode to the file descriptors that refer to it,
+    // using 'workers' threads, same as get_processes_maps.
+    // The fd links are only read, and never stat'ed, so a single pass over
+    // all the processes is enough to match every socket returned by pfs::net
+    // with its owners. Processes that exit or can't be read are skipped.
+    std::unordered_multimap<ino_t, socket_owner>
+    get_socket_owners(size_t workers = 0) const;
+
 public: // Network API
     net get_net(int task_id = getpid()) const;
 
+    // Group all the processes by their network namespace, using 'workers'
+    // threads, same as get_processes_maps. Namespaces are sorted by inode.
+    // Processes that exit or can't be read are skipped.
+    std::vector<net_namespace> get_net_namespaces(size_t workers = 0) const;
+
+    // Call 'collect' exactly once per network namespace, with the 'net' of
+    // one of its members, and return what it returned along with the
+    // namespace. Tools that iterate processes should use this, instead of
+    // reading the same tables once per process.
+    // If a member exits before 'collect' is done (or its pid is reused),
+    // the next member is tried. Namespaces with no member left are skipped.
+    template <typename Collector>
+    std::vector<std::pair<net_namespace,
+                          typename std::result_of<Collector(const net&)>::type>>
+    collect_net_namespaces(Collector collect, size_t workers = 0) const;
+
 public: // System API
     std::vector<zone> get_buddyinfo() const;
 
@@ -59,14 +117,41 @@ public: // System API
 
     std::unordered_map<std::string, bool> get_filesystems() const;
 
+    kpage_table get_kpagecount() const;
+    kpage_table get_kpageflags() const;
+
     load_average get_loadavg() const;
 
     uptime get_uptime() const;
 
-    proc_stat get_stat() const;
+    // Only the sections in the mask are parsed (See proc_stat::section),
+    // the rest are left empty.
+    proc_stat get_stat(unsigned sections = proc_stat::section::ALL) const;
+
+    // Same as above, but parses into an existing output. Its vectors keep
+    // their capacity, so sampling the file repeatedly doesn't allocate.
+    // Successive samples can be turned into utilization using a
+    // cpu_usage_tracker.
+    void get_stat(proc_stat& out,
+                  unsigned sections = proc_stat::section::ALL) const;
+
+    // The per-CPU interrupt and softirq counters. See irq_matrix::deltas_since
+    // for finding the IRQs that are handled by a single CPU.
+    irq_matrix get_interrupts() const;
+    irq_matrix get_softirqs() const;
+
+    // Same as above, but parses into an existing output, which keeps its
+    // capacity across calls
+    void get_interrupts(irq_matrix& out) const;
+    void get_softirqs(irq_matrix& out) const;
 
     std::unordered_map<std::string, size_t> get_meminfo() const;
 
+    // Same as above, but into named fields, and keys that don't have one are
+    // kept in 'meminfo::other'. Parsing into the same output again doesn't
+    // allocate, so prefer it for sampling.
+    void get_meminfo(meminfo& out) const;
+
     std::vector<module> get_modules() const;
 
     std::string get_version() const;
@@ -77,10 +162,61 @@ private: // Private utilities
     static std::string build_root(std::string root);
     static void validate_root(const std::string& root);
 
+    // Call 'fn' for every process, using up to 'workers' threads, and return
+    // the results by pid. Processes that exit or are inaccessible while
+    // 'fn' runs are left out, while any other error is thrown.
+    template <typename T, typename Fn>
+    std::vector<std::pair<int, T>> for_each_process(size_t workers,
+                                                    Fn fn) const;
+
+    // Whether the error is caused by a process that exited, or that the
+    // caller isn't allowed to inspect
+    static bool is_process_unavailable(const std::system_error& err);
+
 private:
     const std::string _root;
 };
 
+template <typename Collector>
+std::vector<std::pair<net_namespace,
+                      typename std::result_of<Collector(const net&)>::type>>
+procfs::collect_net_namespaces(Collector collect, size_t workers) const
+{
+    static const std::string NET_NS("net");
+
+    std::vector<std::pair<net_namespace,
+                          typename std::result_of<Collector(const net&)>::type>>
+        output;
+
+    for (auto& ns : get_net_namespaces(workers))
+    {
+        for (int pid : ns.pids)
+        {
+            try
+            {
+                auto task   = get_task(pid);
+                auto result = collect(task.get_net());
+
+                // Make sure the pid wasn't reused by another process
+                if (task.get_ns(NET_NS) == ns.inode)
+                {
+                    output.emplace_back(std::move(ns), std::move(result));
+                    break;
+                }
+            }
+            catch (const std::system_error& err)
+            {
+                if (!is_process_unavailable(err))
+                {
+                    throw;
+                }
+            }
+        }
+    }
+
+    return output;
+}
+
 } // namespace pfs
 
 #endif // PFS_PROCFS_HPP
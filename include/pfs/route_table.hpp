@@ -0,0 +1,104 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef PFS_ROUTE_TABLE_HPP
+#define PFS_ROUTE_TABLE_HPP
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "types.hpp"
+
+namespace pfs {
+
+struct route_entry
+{
+    ip destination;
+    unsigned int prefix_len;
+    ip gateway; // The unspecified address for directly connected routes
+    std::string iface;
+    unsigned int flags;
+    unsigned int metric;
+};
+
+/*
+ * A longest-prefix-match table for finding the route of a destination.
+ * Notes:
+ * Routes are expanded into multibit tries, so a lookup takes a few
+ * dependent memory reads and no comparisons: Up to 3 for IPv4 (16-8-8
+ * strides) and up to 15 for IPv6 (16 and then 8 bits per level).
+ * When several routes share a prefix, the one with the lowest metric wins.
+ * Routes that aren't up are ignored.
+ * The table is immutable. To pick up routing changes, build a new one.
+ */
+class route_table final
+{
+public:
+    route_table(const std::vector<net_route>& routes,
+                const std::vector<net_ipv6_route>& ipv6_routes = {});
+
+public: // API
+    // Return the route for the destination, or nullptr if there isn't any
+    const route_entry* lookup(const ip& destination) const;
+
+    // Same as above, for many destinations at once.
+    // 'out' is resized to hold the route of every destination.
+    void lookup(const std::vector<ip>& destinations,
+                std::vector<const route_entry*>& out) const;
+
+    const std::vector<route_entry>& routes() const;
+
+private:
+    // A multibit trie of big-endian keys, with a 16-bit root and 8-bit
+    // nodes. Every slot holds either a value or a child node.
+    class trie
+    {
+    public:
+        // Prefixes must be inserted from the shortest to the longest.
+        // Values must be non-zero, and below 'CHILD'.
+        void insert(const uint8_t* key, unsigned int prefix_len,
+                    uint32_t value);
+
+        // Return the value of the longest matching prefix, or zero
+        uint32_t lookup(const uint8_t* key) const;
+
+        const uint32_t* root_slot(const uint8_t* key) const;
+
+    private:
+        uint32_t add_node(uint32_t fill);
+
+    public:
+        static const uint32_t CHILD = 0x80000000;
+
+    private:
+        std::vector<uint32_t> _root;
+        std::vector<uint32_t> _nodes;
+    };
+
+    const trie& get_trie(const ip& destination) const;
+
+private:
+    std::vector<route_entry> _routes;
+    trie _ipv4;
+    trie _ipv6;
+};
+
+} // namespace pfs
+
+#endif // PFS_ROUTE_TABLE_HPP
@@ -0,0 +1,95 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef PFS_SOCK_DIAG_HPP
+#define PFS_SOCK_DIAG_HPP
+
+#include <linux/inet_diag.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/tcp.h>
+#include <linux/unix_diag.h>
+
+#include <functional>
+#include <vector>
+
+#include "pfs/types.hpp"
+
+namespace pfs {
+namespace impl {
+namespace sock_diag {
+
+// A NETLINK_SOCK_DIAG socket. Note that the kernel only reports sockets of
+// the network namespace of the thread that created the socket.
+class diag_socket final
+{
+public:
+    diag_socket();
+    ~diag_socket();
+
+    diag_socket(const diag_socket&) = delete;
+    diag_socket& operator=(const diag_socket&) = delete;
+
+    // Send a dump request, and call 'handler' for every message received
+    // in response. Throws std::system_error if the kernel reports an error.
+    void dump(const std::vector<char>& request,
+              const std::function<void(const nlmsghdr&)>& handler);
+
+private:
+    int _fd;
+    std::vector<char> _buffer;
+};
+
+using inet_handler =
+    std::function<void(const inet_diag_msg& msg, const nlmsghdr& header)>;
+
+// Dump all the sockets of the given family and protocol that match the
+// query. The query is checked by the kernel itself, except for the uids.
+// 'extensions' is a mask of (1 << (INET_DIAG_XXX - 1)) attributes to request.
+void dump_inet(uint8_t family, uint8_t protocol,
+               const net_socket_query& query, uint8_t extensions,
+               const inet_handler& handler);
+
+using unix_handler =
+    std::function<void(const unix_diag_msg& msg, const nlmsghdr& header)>;
+
+// Dump all the unix sockets in one of the query's states, along with the
+// extra information requested by the query.
+void dump_unix(const unix_socket_query& query, const unix_handler& handler);
+
+// Find an attribute of a message. Returns nullptr if it doesn't exist.
+const rtattr* find_attribute(const nlmsghdr& header, size_t header_size,
+                             unsigned short type);
+
+// Copy the tcp_info of a message requested with INET_DIAG_INFO into 'info'.
+// Older kernels report a shorter tcp_info, in which case the fields they
+// don't know are zeroed. Returns the number of bytes reported (0 if none).
+size_t read_tcp_info(const nlmsghdr& header, tcp_info& info);
+
+// Build the bytecode the kernel uses to filter sockets by port and address.
+// States are filtered separately, and aren't part of the bytecode.
+std::vector<char> build_inet_bytecode(const net_socket_query& query);
+
+net_socket to_net_socket(const inet_diag_msg& msg);
+
+unix_socket to_unix_socket(const unix_diag_msg& msg, const nlmsghdr& header);
+
+} // namespace sock_diag
+} // namespace impl
+} // namespace pfs
+
+#endif // PFS_SOCK_DIAG_HPP
@@ -0,0 +1,104 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef PFS_SOCKET_SNAPSHOT_HPP
+#define PFS_SOCKET_SNAPSHOT_HPP
+
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
+#include "types.hpp"
+
+namespace pfs {
+
+/*
+ * An immutable snapshot of sockets, indexed for O(1) lookups by inode,
+ * by local address and by 4-tuple.
+ * The snapshot has no internal state that changes after construction, so it
+ * can be shared across threads without locking.
+ * Sockets with no inode (e.g. in TIME_WAIT) can only be found by address.
+ */
+class socket_snapshot final
+{
+public:
+    // Takes the output of 'net::get_tcp', 'net::get_udp', etc.
+    // Sockets of several protocols can be mixed, but note that a TCP and a
+    // UDP socket may be bound to the same local address.
+    explicit socket_snapshot(std::vector<net_socket> sockets,
+                             std::vector<unix_socket> unix_sockets = {});
+
+    socket_snapshot(const socket_snapshot&) = delete;
+    // Leaves 'other' empty, but still valid for lookups
+    socket_snapshot(socket_snapshot&& other);
+
+    socket_snapshot& operator=(const socket_snapshot&) = delete;
+    socket_snapshot& operator=(socket_snapshot&&) = delete;
+
+public: // API
+    const std::vector<net_socket>& sockets() const;
+    const std::vector<unix_socket>& unix_sockets() const;
+
+    // All the lookups return nullptr if there is no such socket
+    const net_socket* find_by_inode(ino_t inode) const;
+    const unix_socket* find_unix_by_inode(ino_t inode) const;
+
+    // Find a socket bound to the local address. If there is none, a socket
+    // bound to the wildcard address of the same family, on the same port,
+    // is returned instead (e.g. A listener on 0.0.0.0).
+    // When several sockets share the address (e.g. A listener and the
+    // connections it accepted), the first one is returned.
+    const net_socket* find_by_local(const ip& local_ip,
+                                    uint16_t local_port) const;
+
+    // Call 'handler' for every socket bound to exactly the local address,
+    // in the order they were given. Returns the number of sockets found.
+    // Note: 'handler' can be nullptr. Use this to count the sockets.
+    size_t for_each_local(const ip& local_ip, uint16_t local_port,
+            const std::function<void(const net_socket&)>& handler) const;
+
+    const net_socket* find_by_tuple(const ip& local_ip, uint16_t local_port,
+                                    const ip& remote_ip,
+                                    uint16_t remote_port) const;
+
+private:
+    using index = std::vector<uint32_t>;
+
+    static const uint32_t NONE = UINT32_MAX;
+
+    uint32_t find_local(const ip& local_ip, uint16_t local_port) const;
+
+private:
+    std::vector<net_socket> _sockets;
+    std::vector<unix_socket> _unix_sockets;
+
+    // Open addressing tables of socket indices, with linear probing.
+    // Their sizes are powers of 2, and NONE marks an empty slot.
+    index _by_inode;
+    index _by_unix_inode;
+    index _by_local;
+    index _by_tuple;
+
+    // Chains the sockets that share a local address, after the one in
+    // '_by_local'
+    index _next_local;
+};
+
+} // namespace pfs
+
+#endif // PFS_SOCKET_SNAPSHOT_HPP
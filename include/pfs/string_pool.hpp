@@ -0,0 +1,77 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef PFS_STRING_POOL_HPP
+#define PFS_STRING_POOL_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace pfs {
+
+/*
+ * A thread-safe pool of interned strings.
+ * Every distinct string is stored once, and is represented by a 32-bit id.
+ * Ids are never reused, and references returned by 'get' remain valid for the
+ * lifetime of the pool.
+ */
+class string_pool final
+{
+public:
+    using id_type = uint32_t;
+
+    // The id of the empty string, which is always interned
+    static const id_type EMPTY_ID = 0;
+
+public:
+    string_pool();
+
+    string_pool(const string_pool&) = delete;
+    string_pool(string_pool&&)      = delete;
+
+    string_pool& operator=(const string_pool&) = delete;
+    string_pool& operator=(string_pool&&) = delete;
+
+public: // API
+    // Return the id of the string, interning it if needed.
+    // Doesn't allocate if the string is already interned.
+    id_type intern(const char* data, size_t size);
+    id_type intern(const std::string& str);
+
+    // Throws std::out_of_range for unknown ids
+    const std::string& get(id_type id) const;
+
+    // The number of distinct strings in the pool, including the empty one
+    size_t size() const;
+
+private:
+    static uint64_t hash(const char* data, size_t size);
+
+private:
+    mutable std::mutex _mutex;
+    std::deque<std::string> _strings;
+    std::unordered_multimap<uint64_t, id_type> _ids;
+};
+
+} // namespace pfs
+
+#endif // PFS_STRING_POOL_HPP
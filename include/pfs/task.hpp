@@ -25,6 +25,8 @@
 #include "fd.hpp"
 #include "mem.hpp"
 #include "net.hpp"
+#include "pagemap.hpp"
+#include "string_pool.hpp"
 #include "types.hpp"
 
 namespace pfs {
@@ -67,7 +69,17 @@ public: // Getters
 
     std::set<ino_t> get_fds_inodes() const;
 
+    // A compact alternative to get_fds(), which never stats the fd targets.
+    // Every fd is classified by its link text, which is enough to match
+    // sockets and pipes by their inodes.
+    fd_table get_fd_table() const;
+
+    // Same as calling fd::get_info() for every fd, but all the files are
+    // opened relative to a single fdinfo directory fd.
+    std::unordered_map<int, fd_info> get_fdinfo() const;
+
     std::vector<mem_region> get_maps() const;
+    std::vector<compact_mem_region> get_maps(string_pool& pool) const;
 
     mem get_mem() const;
 
@@ -79,8 +91,26 @@ public: // Getters
 
     std::unordered_map<std::string, ino_t> get_ns() const;
 
+    // Regions are listed in the same order as in get_maps(), and can be
+    // matched to them by their start address.
+    std::vector<numa_region> get_numa_maps() const;
+
+    // The regions of get_maps(), joined with their numa_maps entries.
+    // The files are read one after the other, so regions that were mapped
+    // or unmapped in between are left out.
+    std::vector<std::pair<mem_region, numa_region>> get_maps_with_numa() const;
+
+    // The total resident memory of the task on every NUMA node, in kB
+    // (Indexed by node id).
+    std::vector<size_t> get_numa_usage() const;
+
+    pagemap get_pagemap() const;
+    std::vector<pagemap_entry> get_pagemap(const mem_region& region) const;
+
     std::string get_root() const;
 
+    std::vector<smaps_region> get_smaps() const;
+
     task_stat get_stat() const;
 
     io_stats get_io() const;
@@ -96,6 +126,12 @@ public: // Getters
     std::vector<id_map> get_uid_map() const;
     std::vector<id_map> get_gid_map() const;
 
+public: // Actions
+    // Requires ptrace access to the task.
+    // To track changed pages: clear the soft-dirty bits, wait, and then
+    // use pagemap::read_soft_dirty to get the pages written in-between.
+    void clear_refs(clear_refs_mode mode) const;
+
 private:
     friend class procfs;
     task(const std::string& procfs_root, int id);
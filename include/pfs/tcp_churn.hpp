@@ -0,0 +1,198 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef PFS_TCP_CHURN_HPP
+#define PFS_TCP_CHURN_HPP
+
+#include <stdint.h>
+
+#include <array>
+#include <chrono>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "types.hpp"
+
+namespace pfs {
+
+struct tcp_churn_event
+{
+    enum class type
+    {
+        opened,
+        closed,
+        state_changed,
+    };
+
+    type event_type;
+
+    ip local_ip;
+    uint16_t local_port;
+    ip remote_ip;
+    uint16_t remote_port;
+    ino_t inode; // As first seen, even once the socket is orphaned
+
+    // The current state, or the last state seen for closed connections
+    net_socket::net_state state;
+    // Same as 'state', except for state changes
+    net_socket::net_state previous_state;
+};
+
+struct tcp_remote_churn
+{
+    ip remote_ip;
+    size_t connections; // Currently open
+    // Since the remote was first seen. Remotes with no open connections and
+    // no recent activity are forgotten.
+    uint64_t opened;
+    uint64_t closed;
+
+    // Over the interval between the last two snapshots [unit: 1/sec]
+    double open_rate;
+    double close_rate;
+};
+
+/*
+ * Track TCP connections across successive snapshots, and report the
+ * connections that were opened, closed or changed their state in between.
+ * A connection is identified by its 4-tuple and inode. Once closed, the
+ * kernel reports the socket with inode 0 (e.g. in TIME_WAIT), which is
+ * treated as a state change of the same connection. A different non-zero
+ * inode is a new connection, so the previous one is reported as closed.
+ *
+ * Only the last state of every live connection is kept, in a hash table
+ * that is swept using generations, so memory is bounded by the number of
+ * live connections rather than by two full snapshots.
+ *
+ * A snapshot can come from any source. To avoid collecting the sockets,
+ * feed them from a filter:
+ *
+ *   tracker.begin();
+ *   net.get_tcp([&](const net_socket& s) {
+ *       tracker.add(s, handler);
+ *       return filter::action::drop;
+ *   });
+ *   tracker.end(handler);
+ *
+ * The first snapshot is a baseline, and reports no events.
+ * Not thread-safe.
+ */
+class tcp_churn_tracker final
+{
+public:
+    using event_handler = std::function<void(const tcp_churn_event&)>;
+
+public:
+    tcp_churn_tracker();
+
+    tcp_churn_tracker(const tcp_churn_tracker&) = delete;
+    tcp_churn_tracker(tcp_churn_tracker&&)      = default;
+
+    tcp_churn_tracker& operator=(const tcp_churn_tracker&) = delete;
+    tcp_churn_tracker& operator=(tcp_churn_tracker&&) = default;
+
+public: // API
+    // Process a whole snapshot (e.g. the output of 'net::get_tcp' or
+    // 'net::collect_tcp'). 'handler' can be nullptr.
+    void update(const std::vector<net_socket>& sockets,
+                const event_handler& handler = nullptr);
+    void update(const net_socket_table& table,
+                const event_handler& handler = nullptr);
+
+    // Process a snapshot one socket at a time.
+    // Connections that weren't added since 'begin' are reported as closed
+    // by 'end'.
+    void begin();
+    void add(const net_socket& socket, const event_handler& handler = nullptr);
+    void end(const event_handler& handler = nullptr);
+
+    // The number of open connections in the given state
+    size_t count(net_socket::net_state state) const;
+
+    // The number of open connections
+    size_t size() const;
+
+    std::vector<tcp_remote_churn> get_remote_churn() const;
+
+private:
+    struct entry
+    {
+        uint64_t hash;
+        ip local_ip;
+        uint16_t local_port;
+        ip remote_ip;
+        uint16_t remote_port;
+        ino_t inode;
+        net_socket::net_state state;
+        uint32_t generation = 0;
+        bool used           = false;
+    };
+
+    struct remote_state
+    {
+        size_t connections = 0;
+        uint64_t opened    = 0;
+        uint64_t closed    = 0;
+
+        // Since the last snapshot
+        uint64_t recently_opened = 0;
+        uint64_t recently_closed = 0;
+
+        double open_rate  = 0;
+        double close_rate = 0;
+    };
+
+    struct ip_hash
+    {
+        size_t operator()(const ip& addr) const;
+    };
+
+    static const size_t STATES =
+        static_cast<size_t>(net_socket::net_state::closing) + 1;
+
+private:
+    void add(const ip& local_ip, uint16_t local_port, const ip& remote_ip,
+             uint16_t remote_port, ino_t inode, net_socket::net_state state,
+             const event_handler& handler);
+
+    size_t find(const ip& local_ip, uint16_t local_port, const ip& remote_ip,
+                uint16_t remote_port, ino_t inode, uint64_t hash) const;
+    void erase(size_t pos);
+    void grow();
+
+    void on_opened(const entry& e, const event_handler& handler);
+    void on_closed(const entry& e, const event_handler& handler);
+
+    static tcp_churn_event make_event(tcp_churn_event::type type,
+                                      const entry& e);
+
+private:
+    std::vector<entry> _entries; // Open addressing, with linear probing
+    size_t _size;
+    uint32_t _generation;
+    bool _baseline;
+
+    std::array<size_t, STATES> _states;
+    std::unordered_map<ip, remote_state, ip_hash> _remotes;
+
+    std::chrono::steady_clock::time_point _last_end;
+};
+
+} // namespace pfs
+
+#endif // PFS_TCP_CHURN_HPP
@@ -340,6 +340,171 @@ struct mem_region
     }
 };
 
+// Hint: See 'show_smap @ task_mmu.c'
+struct smaps_region
+{
+    // Note: All values are in kB!
+
+    mem_region region;
+    size_t size            = 0;
+    size_t rss             = 0;
+    size_t pss             = 0;
+    size_t shared_clean    = 0;
+    size_t shared_dirty    = 0;
+    size_t private_clean   = 0;
+    size_t private_dirty   = 0;
+    size_t referenced      = 0;
+    size_t anonymous       = 0;
+    size_t anon_huge_pages = 0;
+    size_t swap            = 0;
+    size_t swap_pss        = 0; // Since 4.3
+    size_t locked          = 0;
+
+    // NOTE: Additional fields will be added upon request
+};
+
+// Hint: See 'show_numa_map' in fs/proc/task_mmu.c
+struct numa_region
+{
+    // Note: All counters are in pages of 'page_size_kb' kB!
+
+    size_t start_address = 0; // Same as the matching mem_region
+    std::string policy;       // E.g. "default", "bind:0-1", "interleave:0-3"
+    std::string pathname;     // Escaped, and only set for file mappings
+    bool is_heap         = false;
+    bool is_stack        = false;
+    bool is_huge         = false;
+    size_t anon          = 0;
+    size_t dirty         = 0;
+    size_t mapped        = 0;
+    size_t mapmax        = 0;
+    size_t swapcache     = 0;
+    size_t active        = 0;
+    size_t writeback     = 0;
+    size_t page_size_kb  = 0;
+    std::vector<size_t> node_pages; // Indexed by NUMA node id
+};
+
+// A file mapped by one or more processes, identified by (device, inode).
+// Hint: The real cost of the object is its PSS, which is split into the
+// unique bytes (Pages mapped by a single process, counted in full), and the
+// shared PSS bytes (Each mapper's share of the pages mapped by several).
+// Private and shared bytes are the resident pages, not divided between the
+// mappers, so their sum is the RSS.
+struct mapped_object
+{
+    dev_t device  = 0;
+    ino_t inode   = INVALID_INODE;
+    std::string pathname; // As seen by one of the mappers
+    size_t mappers          = 0; // Number of processes
+    size_t mapped_bytes     = 0; // Total virtual size across all mappers
+    size_t rss_bytes        = 0; // Only when collected from smaps
+    size_t pss_bytes        = 0; // Only when collected from smaps
+    size_t unique_bytes     = 0; // Only when collected from smaps
+    size_t shared_pss_bytes = 0; // Only when collected from smaps
+    size_t swap_pss_bytes   = 0; // Only when collected from smaps (Since 4.3)
+    size_t private_bytes    = 0; // Only when collected from smaps
+    size_t shared_bytes     = 0; // Only when collected from smaps
+};
+
+// Same as mem_region, but the pathname is interned into a string_pool.
+// Useful when collecting the maps of many processes, which mostly map the
+// same few files.
+struct compact_mem_region
+{
+    size_t start_address = 0;
+    size_t end_address   = 0;
+    mem_perm perm;
+    size_t offset        = 0;
+    dev_t device         = 0;
+    ino_t inode          = INVALID_INODE;
+    uint32_t pathname_id = 0; // Zero is the empty pathname
+
+    bool operator<(const compact_mem_region& rhs) const
+    {
+        return start_address < rhs.start_address;
+    }
+};
+
+// Values accepted by /proc/[pid]/clear_refs
+enum class clear_refs_mode
+{
+    all        = 1, // Referenced bits of all the pages
+    anonymous  = 2, // Referenced bits of anonymous pages
+    file       = 3, // Referenced bits of file-mapped pages
+    soft_dirty = 4, // Soft-dirty bits of all the pages (Since 3.11)
+    peak_rss   = 5, // Reset the peak RSS (Since 4.0)
+};
+
+// Hint: See 'Documentation/admin-guide/mm/pagemap.rst'
+struct pagemap_entry
+{
+    using raw_type = uint64_t;
+
+    explicit pagemap_entry(raw_type raw = 0);
+
+    bool is_present() const;
+    bool is_swapped() const;
+    bool is_file_or_shared_anon() const;
+    bool is_exclusive() const;  // Since 4.2
+    bool is_soft_dirty() const; // Since 3.11
+
+    // Valid only when the page is present.
+    // Zero when the reader lacks CAP_SYS_ADMIN (Since 4.2).
+    uint64_t pfn() const;
+
+    // Valid only when the page is swapped
+    unsigned swap_type() const;
+    uint64_t swap_offset() const;
+
+    bool operator==(const pagemap_entry& rhs) const;
+
+    raw_type raw;
+};
+
+// A bitmap per state, where bit 'i' represents the page at
+// 'start_address + i * page_size'.
+struct page_residency
+{
+    size_t start_address = 0;
+    size_t page_size     = 0;
+    std::vector<bool> present;
+    std::vector<bool> swapped;
+};
+
+// Bit indexes of the values returned by /proc/kpageflags.
+// Hint: See 'include/uapi/linux/kernel-page-flags.h'
+enum class kpage_flag
+{
+    locked        = 0,
+    error         = 1,
+    referenced    = 2,
+    uptodate      = 3,
+    dirty         = 4,
+    lru           = 5,
+    active        = 6,
+    slab          = 7,
+    writeback     = 8,
+    reclaim       = 9,
+    buddy         = 10,
+    mmap          = 11,
+    anon          = 12,
+    swapcache     = 13,
+    swapbacked    = 14,
+    compound_head = 15,
+    compound_tail = 16,
+    huge          = 17,
+    unevictable   = 18,
+    hwpoison      = 19,
+    nopage        = 20,
+    ksm           = 21,
+    thp           = 22,
+    offline       = 23,
+    zero_page     = 24,
+    idle          = 25,
+    pgtable       = 26,
+};
+
 struct module
 {
     enum class state
@@ -367,6 +532,73 @@ struct uptime
     std::chrono::steady_clock::duration idle_time;
 };
 
+// Hint: See 'https://docs.kernel.org/filesystems/proc.html#meminfo'
+// [unit: kB], unless noted otherwise.
+// Fields that the kernel doesn't print (e.g. depending on its config) are 0.
+struct meminfo
+{
+    uint64_t mem_total{0};
+    uint64_t mem_free{0};
+    uint64_t mem_available{0};
+    uint64_t buffers{0};
+    uint64_t cached{0};
+    uint64_t swap_cached{0};
+    uint64_t active{0};
+    uint64_t inactive{0};
+    uint64_t active_anon{0};
+    uint64_t inactive_anon{0};
+    uint64_t active_file{0};
+    uint64_t inactive_file{0};
+    uint64_t unevictable{0};
+    uint64_t mlocked{0};
+    uint64_t swap_total{0};
+    uint64_t swap_free{0};
+    uint64_t zswap{0};
+    uint64_t zswapped{0};
+    uint64_t dirty{0};
+    uint64_t writeback{0};
+    uint64_t anon_pages{0};
+    uint64_t mapped{0};
+    uint64_t shmem{0};
+    uint64_t kreclaimable{0};
+    uint64_t slab{0};
+    uint64_t sreclaimable{0};
+    uint64_t sunreclaim{0};
+    uint64_t kernel_stack{0};
+    uint64_t page_tables{0};
+    uint64_t sec_page_tables{0};
+    uint64_t nfs_unstable{0};
+    uint64_t bounce{0};
+    uint64_t writeback_tmp{0};
+    uint64_t commit_limit{0};
+    uint64_t committed_as{0};
+    uint64_t vmalloc_total{0};
+    uint64_t vmalloc_used{0};
+    uint64_t vmalloc_chunk{0};
+    uint64_t percpu{0};
+    uint64_t hardware_corrupted{0};
+    uint64_t anon_huge_pages{0};
+    uint64_t shmem_huge_pages{0};
+    uint64_t shmem_pmd_mapped{0};
+    uint64_t file_huge_pages{0};
+    uint64_t file_pmd_mapped{0};
+    uint64_t cma_total{0};
+    uint64_t cma_free{0};
+    uint64_t huge_pages_total{0};   // [unit: pages]
+    uint64_t huge_pages_free{0};    // [unit: pages]
+    uint64_t huge_pages_rsvd{0};    // [unit: pages]
+    uint64_t huge_pages_surp{0};    // [unit: pages]
+    uint64_t hugepagesize{0};
+    uint64_t hugetlb{0};
+    uint64_t direct_map_4k{0};
+    uint64_t direct_map_2m{0};
+    uint64_t direct_map_1g{0};
+
+    // Keys that don't have a field (e.g. added by newer kernels), in the
+    // order of the file
+    std::vector<std::pair<std::string, uint64_t>> other;
+};
+
 struct load_average
 {
     double last_1min;
@@ -379,15 +611,32 @@ struct load_average
 
 struct proc_stat
 {
+    // Sections of the file, that are OR-ed into a mask of sections to parse
+    struct section
+    {
+        static constexpr unsigned CPUS      = 1 << 0; // Total and per-CPU
+        static constexpr unsigned INTR      = 1 << 1;
+        static constexpr unsigned CTXT      = 1 << 2;
+        static constexpr unsigned BTIME     = 1 << 3;
+        static constexpr unsigned PROCESSES = 1 << 4;
+        static constexpr unsigned PROCS     = 1 << 5; // Running and blocked
+        static constexpr unsigned SOFTIRQ   = 1 << 6;
+        static constexpr unsigned ALL       = ~0U;
+    };
+
     template <typename T>
     struct sequence
     {
-        T total;
+        T total{};
         std::vector<T> per_item;
     };
 
     struct cpu
     {
+        // The N of 'cpuN', or -1 for the total. Offline CPUs are omitted,
+        // so it doesn't always match the index in 'per_item'.
+        int id{-1};
+
         unsigned long long user{0};
         unsigned long long nice{0};
         unsigned long long system{0};
@@ -402,14 +651,67 @@ struct proc_stat
 
     sequence<cpu> cpus;
     sequence<unsigned long long> intr;
-    unsigned long long ctxt;
+    unsigned long long ctxt{0};
     std::chrono::system_clock::time_point btime;
-    unsigned long long processes;
-    size_t procs_running;
-    size_t procs_blocked;
+    unsigned long long processes{0};
+    size_t procs_running{0};
+    size_t procs_blocked{0};
     sequence<unsigned long long> softirq;
 };
 
+// The activity of a single row between two IRQ matrices
+struct irq_delta
+{
+    size_t row;     // In the newer matrix
+    uint64_t total; // Over all the CPUs
+
+    // The CPU that handled most of them, and its share of the total [0-1].
+    // A share close to 1 on a busy row means the IRQ isn't spread.
+    // Rows that aren't per-CPU (See irq_matrix::counts) always are.
+    int top_cpu;
+    uint64_t top_count;
+    double concentration;
+};
+
+// The per-CPU counters of /proc/interrupts and /proc/softirqs
+struct irq_matrix
+{
+    // The ids of the columns. Offline CPUs are omitted.
+    std::vector<int> cpus;
+
+    // Per row: The label (e.g. '24', 'NMI' or 'NET_RX'), and whatever follows
+    // the counters (e.g. 'IO-APIC 2-edge timer'), if anything
+    std::vector<std::string> names;
+    std::vector<std::string> descriptions;
+
+    // Row-major, 'cpus.size()' counters per row.
+    // Rows with a single counter that isn't per-CPU (e.g. 'ERR') have it in
+    // the first column, and zeros in the rest.
+    std::vector<uint64_t> counts;
+
+    size_t rows() const { return names.size(); }
+    size_t columns() const { return cpus.size(); }
+
+    const uint64_t* row(size_t index) const
+    {
+        return counts.data() + index * cpus.size();
+    }
+
+    uint64_t at(size_t row, size_t column) const
+    {
+        return counts[row * cpus.size() + column];
+    }
+
+    // The rows that changed since the previous matrix, sorted by their total,
+    // in descending order. Rows and CPUs are matched by their labels and ids,
+    // and those that aren't part of both matrices are skipped.
+    std::vector<irq_delta> deltas_since(const irq_matrix& previous) const;
+
+    // Same as above, but the deltas replace the content of 'out'
+    void deltas_since(const irq_matrix& previous,
+                      std::vector<irq_delta>& out) const;
+};
+
 struct mount
 {
     unsigned id;
@@ -535,6 +837,56 @@ struct net_socket
     }
 };
 
+// Sockets stored column by column, so that scanning a single field of many
+// sockets touches only that field. Collecting into the same table again
+// reuses its memory.
+struct net_socket_table
+{
+    std::vector<size_t> slot;
+    std::vector<ip> local_ip;
+    std::vector<uint16_t> local_port;
+    std::vector<ip> remote_ip;
+    std::vector<uint16_t> remote_port;
+    std::vector<net_socket::net_state> socket_net_state;
+    std::vector<size_t> tx_queue;
+    std::vector<size_t> rx_queue;
+    std::vector<net_socket::timer> timer_active;
+    std::vector<size_t> timer_expire_jiffies;
+    std::vector<size_t> retransmits;
+    std::vector<uid_t> uid;
+    std::vector<size_t> timeouts;
+    std::vector<ino_t> inode;
+    std::vector<int> ref_count;
+    std::vector<size_t> skbuff;
+
+    size_t size() const;
+    bool empty() const;
+
+    void clear();
+    void reserve(size_t count);
+    void push_back(const net_socket& socket);
+
+    // Throws std::out_of_range if the index is out of range
+    net_socket at(size_t index) const;
+};
+
+// Sockets to look for. Every non-empty list must match at least one of its
+// values, and an empty query matches all the sockets.
+// Unlike a filter, a query can be checked by the kernel itself, when
+// sockets are collected using sock_diag.
+struct net_socket_query
+{
+    std::set<net_socket::net_state> states;
+    std::vector<uint16_t> local_ports;
+    std::vector<uint16_t> remote_ports;
+    std::vector<ip> local_ips;
+    std::vector<ip> remote_ips;
+    std::vector<uid_t> uids; // Always checked in user-space
+
+    bool empty() const;
+    bool matches(const net_socket& socket) const;
+};
+
 // Hint: See 'unix_seq_show @ af_unix.c'
 struct unix_socket
 {
@@ -564,12 +916,35 @@ struct unix_socket
     ino_t inode;
     std::string path;
 
+    // Only reported by sock_diag, and only when requested by the query
+    ino_t peer_inode = INVALID_INODE;
+    std::vector<ino_t> pending_connections; // Listening sockets only
+    uint32_t rqueue  = 0; // Listening: Pending connections, Else: Bytes
+    uint32_t wqueue  = 0; // Listening: Max backlog, Else: Bytes
+    ino_t vfs_inode  = INVALID_INODE; // Of the bound path
+    dev_t vfs_device = 0;
+
     bool operator<(const unix_socket& rhs) const
     {
         return (skbuff < rhs.skbuff) || (inode < rhs.inode);
     }
 };
 
+// Unix sockets to look for, and the extra information to collect.
+// The extra information is only available when using sock_diag.
+struct unix_socket_query
+{
+    // The socket's internal state. Unlike unix_socket::state, this tells
+    // listening sockets apart, e.g. 'listen', 'established' or 'close'.
+    std::set<net_socket::net_state> states;
+
+    bool show_peer  = false; // Peer inode, and pending connections
+    bool show_rqlen = false; // Queue lengths
+    bool show_vfs   = false; // Inode and device of the bound path
+
+    bool matches(const unix_socket& socket) const;
+};
+
 struct netlink_socket
 {
     size_t skbuff    = 0;
@@ -589,6 +964,167 @@ struct netlink_socket
     }
 };
 
+// The kind of object an fd refers to, as seen from the fd link text
+enum class fd_kind
+{
+    unknown,
+    file,       // Any path, including devices and deleted files
+    memfd,      // /memfd:<name> (deleted)
+    socket,     // socket:[<inode>]
+    pipe,       // pipe:[<inode>]
+    ns,         // <type>:[<inode>], e.g. net:[4026531840]
+    eventpoll,  // anon_inode:[eventpoll]
+    eventfd,    // anon_inode:[eventfd]
+    timerfd,    // anon_inode:[timerfd]
+    signalfd,   // anon_inode:[signalfd]
+    inotify,    // anon_inode:inotify
+    fanotify,   // anon_inode:[fanotify]
+    pidfd,      // anon_inode:[pidfd]
+    anon_inode, // Any other anonymous inode, e.g. anon_inode:[io_uring]
+};
+
+struct fd_entry
+{
+    int num              = -1;
+    fd_kind kind         = fd_kind::unknown;
+    ino_t inode          = INVALID_INODE; // Only for sockets, pipes and ns
+    size_t target_offset = 0;             // Into fd_table::targets
+    size_t target_size   = 0;
+};
+
+// The fds of a task, classified by their link text only.
+// All the link targets are stored back to back in a single buffer.
+struct fd_table
+{
+    std::vector<fd_entry> entries; // Sorted by fd number
+    std::string targets;
+
+    std::string target(const fd_entry& entry) const
+    {
+        return targets.substr(entry.target_offset, entry.target_size);
+    }
+};
+
+// Hint: See 'seq_show' in fs/proc/fd.c, and the 'show_fdinfo' callbacks.
+// Type-specific fields are only set for fds of the matching kind.
+struct fd_info
+{
+    // A file descriptor watched by an epoll instance
+    struct epoll_target
+    {
+        int fd          = -1;
+        uint32_t events = 0;
+        uint64_t data   = 0;
+        ino_t inode     = INVALID_INODE;
+        dev_t device    = 0;
+    };
+
+    struct inotify_watch
+    {
+        int wd        = -1;
+        ino_t inode   = INVALID_INODE;
+        dev_t device  = 0;
+        uint32_t mask = 0;
+    };
+
+    struct timer
+    {
+        int clock_id      = 0;
+        uint64_t ticks    = 0;
+        int settime_flags = 0;
+        std::chrono::nanoseconds value{0};
+        std::chrono::nanoseconds interval{0};
+    };
+
+    long long pos = 0;
+    int flags     = 0;
+    int mnt_id    = 0;
+    ino_t inode   = INVALID_INODE; // Since 5.1
+
+    uint64_t eventfd_count = 0;
+    std::vector<epoll_target> epoll_targets;
+    std::vector<inotify_watch> inotify_watches;
+    timer timerfd;
+    signal_mask signalfd_mask;
+    pid_t pidfd_pid = 0; // Since 5.2, -1 once the process is reaped
+};
+
+// A file descriptor that refers to a socket.
+// Use the socket inode to match it with the sockets returned by pfs::net.
+struct socket_owner
+{
+    int pid = 0;
+    int fd  = -1;
+};
+
+// A network namespace, and the processes that are members of it
+struct net_namespace
+{
+    ino_t inode = INVALID_INODE;
+    std::vector<int> pids; // Sorted
+};
+
+// A histogram with fixed power-of-two buckets: Bucket 0 counts zeros,
+// and bucket i counts the values in [2^(i-1), 2^i).
+struct log2_histogram
+{
+    static const size_t BUCKETS = 65;
+
+    std::array<uint64_t, BUCKETS> buckets = {{}};
+    uint64_t count = 0;
+    uint64_t sum   = 0;
+    uint64_t min   = UINT64_MAX;
+    uint64_t max   = 0;
+
+    void add(uint64_t value);
+
+    // Zero if the histogram is empty
+    uint64_t mean() const;
+
+    // An upper bound of the given percentile [0-100], based on the bucket
+    // that holds it. Zero if the histogram is empty.
+    uint64_t percentile(double p) const;
+};
+
+// The TCP health of a group of sockets, based on the kernel's tcp_info.
+// Hint: See 'tcp_get_info @ tcp.c'
+struct tcp_health
+{
+    enum class grouping
+    {
+        remote_subnet,
+        local_port,
+        owner,
+    };
+
+    // The group key. Only the fields of the grouping used are set.
+    ip remote_subnet;
+    uint8_t prefix_len  = 0;
+    uint16_t local_port = 0;
+    int pid             = 0; // Zero if the owner is unknown
+
+    size_t sockets = 0;
+    log2_histogram rtt;           // Smoothed round trip time [unit: us]
+    log2_histogram rttvar;        // Round trip time variance [unit: us]
+    log2_histogram snd_cwnd;      // Congestion window [unit: segments]
+    log2_histogram total_retrans; // Retransmitted segments over the lifetime
+    log2_histogram delivery_rate; // Since 4.9 [unit: bytes/sec]
+    log2_histogram unacked;       // Segments in flight
+};
+
+struct tcp_health_options
+{
+    tcp_health::grouping group_by = tcp_health::grouping::remote_subnet;
+    uint8_t ipv4_prefix_len       = 24;
+    uint8_t ipv6_prefix_len       = 64;
+
+    // Sockets to include. Listening sockets are never included.
+    net_socket_query query;
+
+    // Required when grouping by owner. See 'procfs::get_socket_owners'.
+    const std::unordered_multimap<ino_t, socket_owner>* owners = nullptr;
+};
+
 struct cgroup_controller
 {
     std::string subsys_name;
@@ -627,6 +1163,102 @@ struct net_route
     unsigned int irtt;
 };
 
+// Hint: See 'ipv6_route_native_seq_show @ ip6_fib.c'
+struct net_ipv6_route
+{
+    ip destination;
+    unsigned int destination_prefix_len;
+    ip source;
+    unsigned int source_prefix_len;
+    ip next_hop;
+    unsigned int metric;
+    unsigned int refcnt;
+    unsigned int use;
+    unsigned int flags;
+    std::string iface;
+};
+
+// Hint: See 'ct_seq_show @ nf_conntrack_standalone.c'
+struct conntrack_entry
+{
+    // Only TCP connections have a state, other protocols are 'none', except
+    // for SCTP and DCCP, whose states are 'other'.
+    enum class state
+    {
+        none,
+        syn_sent,
+        syn_recv,
+        established,
+        fin_wait,
+        close_wait,
+        last_ack,
+        time_wait,
+        close,
+        syn_sent2,
+        other,
+    };
+
+    struct tuple
+    {
+        ip src;
+        ip dst;
+        uint16_t src_port = 0; // Zero for protocols without ports (e.g. ICMP)
+        uint16_t dst_port = 0;
+    };
+
+    int family       = 0; // AF_INET or AF_INET6
+    uint8_t protocol = 0; // IPPROTO_*
+    state conn_state = state::none;
+    uint32_t timeout = 0; // [unit: sec]
+
+    tuple original;
+    tuple reply;
+
+    // Only set when accounting is enabled (See 'nf_conntrack_acct')
+    bool has_counters         = false;
+    uint64_t original_packets = 0;
+    uint64_t original_bytes   = 0;
+    uint64_t reply_packets    = 0;
+    uint64_t reply_bytes      = 0;
+
+    bool assured   = false;
+    bool unreplied = false;
+    uint32_t mark  = 0;
+    uint16_t zone  = 0;
+};
+
+struct conntrack_summary
+{
+    enum class grouping
+    {
+        state,
+        destination_port,
+        source_subnet,
+    };
+
+    // The group key. Only the fields of the grouping used are set.
+    conntrack_entry::state conn_state = conntrack_entry::state::none;
+    uint8_t protocol          = 0;
+    uint16_t destination_port = 0;
+    ip source_subnet;
+    uint8_t prefix_len = 0;
+
+    size_t entries   = 0;
+    size_t assured   = 0;
+    size_t unreplied = 0;
+
+    // Both directions, only when accounting is enabled
+    uint64_t packets = 0;
+    uint64_t bytes   = 0;
+};
+
+struct conntrack_summary_options
+{
+    conntrack_summary::grouping group_by = conntrack_summary::grouping::state;
+    uint8_t ipv4_prefix_len              = 24;
+    uint8_t ipv6_prefix_len              = 64;
+};
+
 struct net_arp
 {
     std::string ip_address;
@@ -637,6 +1269,205 @@ struct net_arp
     std::string device;
 };
 
+// The counters of /proc/net/snmp that signal network trouble.
+// Counters that the kernel doesn't report are left zeroed.
+// Hint: See 'snmp_seq_show @ proc.c'
+struct net_snmp
+{
+    // Ip
+    uint64_t ip_in_receives       = 0;
+    uint64_t ip_in_hdr_errors     = 0;
+    uint64_t ip_in_addr_errors    = 0;
+    uint64_t ip_forw_datagrams    = 0;
+    uint64_t ip_in_unknown_protos = 0;
+    uint64_t ip_in_discards       = 0;
+    uint64_t ip_in_delivers       = 0;
+    uint64_t ip_out_requests      = 0;
+    uint64_t ip_out_discards      = 0;
+    uint64_t ip_out_no_routes     = 0;
+    uint64_t ip_reasm_fails       = 0;
+    uint64_t ip_frag_fails        = 0;
+
+    // Icmp
+    uint64_t icmp_in_msgs           = 0;
+    uint64_t icmp_in_errors         = 0;
+    uint64_t icmp_in_csum_errors    = 0;
+    uint64_t icmp_in_dest_unreachs  = 0;
+    uint64_t icmp_out_msgs          = 0;
+    uint64_t icmp_out_errors        = 0;
+    uint64_t icmp_out_dest_unreachs = 0;
+
+    // Tcp
+    uint64_t tcp_active_opens   = 0;
+    uint64_t tcp_passive_opens  = 0;
+    uint64_t tcp_attempt_fails  = 0;
+    uint64_t tcp_estab_resets   = 0;
+    uint64_t tcp_curr_estab     = 0; // A gauge, not a counter
+    uint64_t tcp_in_segs        = 0;
+    uint64_t tcp_out_segs       = 0;
+    uint64_t tcp_retrans_segs   = 0;
+    uint64_t tcp_in_errs        = 0;
+    uint64_t tcp_out_rsts       = 0;
+    uint64_t tcp_in_csum_errors = 0;
+
+    // Udp
+    uint64_t udp_in_datagrams   = 0;
+    uint64_t udp_no_ports       = 0;
+    uint64_t udp_in_errors      = 0;
+    uint64_t udp_out_datagrams  = 0;
+    uint64_t udp_rcvbuf_errors  = 0;
+    uint64_t udp_sndbuf_errors  = 0;
+    uint64_t udp_in_csum_errors = 0;
+};
+
+// The counters of /proc/net/netstat that signal network trouble.
+// Counters that the kernel doesn't report are left zeroed.
+// Hint: See 'netstat_seq_show @ proc.c'
+struct net_netstat
+{
+    // TcpExt
+    uint64_t syncookies_sent          = 0;
+    uint64_t syncookies_recv          = 0;
+    uint64_t syncookies_failed        = 0;
+    uint64_t embryonic_rsts           = 0;
+    uint64_t prune_called             = 0;
+    uint64_t rcv_pruned               = 0;
+    uint64_t ofo_pruned               = 0;
+    uint64_t tw                       = 0;
+    uint64_t tw_recycled              = 0;
+    uint64_t tw_killed                = 0;
+    uint64_t delayed_acks             = 0;
+    uint64_t listen_overflows         = 0;
+    uint64_t listen_drops             = 0;
+    uint64_t tcp_lost_retransmit      = 0;
+    uint64_t tcp_fast_retrans         = 0;
+    uint64_t tcp_slow_start_retrans   = 0;
+    uint64_t tcp_timeouts             = 0;
+    uint64_t tcp_memory_pressures     = 0;
+    uint64_t tcp_abort_on_data        = 0;
+    uint64_t tcp_abort_on_close       = 0;
+    uint64_t tcp_abort_on_memory      = 0;
+    uint64_t tcp_abort_on_timeout     = 0;
+    uint64_t tcp_backlog_drop         = 0;
+    uint64_t tcp_rcvq_drop            = 0;
+    uint64_t tcp_zero_window_drop     = 0;
+    uint64_t tcp_reqq_full_drop       = 0;
+    uint64_t tcp_reqq_full_do_cookies = 0;
+
+    // IpExt
+    uint64_t ip_in_no_routes      = 0;
+    uint64_t ip_in_truncated_pkts = 0;
+    uint64_t ip_in_mcast_pkts     = 0;
+    uint64_t ip_out_mcast_pkts    = 0;
+    uint64_t ip_in_bcast_pkts     = 0;
+    uint64_t ip_out_bcast_pkts    = 0;
+    uint64_t ip_in_octets         = 0;
+    uint64_t ip_out_octets        = 0;
+    uint64_t ip_in_csum_errors    = 0;
+};
+
+// The content of /proc/net/sockstat or /proc/net/sockstat6.
+// sockstat6 only reports the sockets in use (and the fragments memory).
+// Hint: See 'sockstat_seq_show @ proc.c'
+struct net_sockstat
+{
+    uint64_t sockets_used  = 0;
+    uint64_t tcp_inuse     = 0;
+    uint64_t tcp_orphan    = 0;
+    uint64_t tcp_tw        = 0;
+    uint64_t tcp_alloc     = 0;
+    uint64_t tcp_mem       = 0; // [unit: pages]
+    uint64_t udp_inuse     = 0;
+    uint64_t udp_mem       = 0; // [unit: pages]
+    uint64_t udplite_inuse = 0;
+    uint64_t raw_inuse     = 0;
+    uint64_t frag_inuse    = 0;
+    uint64_t frag_memory   = 0; // [unit: bytes]
+};
+
+// Per-second rates of the counters that signal network trouble
+struct net_stats_rates
+{
+    double tcp_in_segs       = 0;
+    double tcp_out_segs      = 0;
+    double tcp_retrans_segs  = 0;
+    double tcp_retrans_ratio = 0; // Out of the segments sent [0-1]
+    double tcp_attempt_fails = 0;
+    double tcp_estab_resets  = 0;
+    double tcp_out_rsts      = 0;
+    double tcp_in_errs       = 0;
+    double tcp_timeouts      = 0;
+
+    double listen_overflows = 0;
+    double listen_drops     = 0;
+
+    double syncookies_sent   = 0;
+    double syncookies_recv   = 0;
+    double syncookies_failed = 0;
+
+    double tcp_memory_pressures = 0;
+    double tcp_abort_on_memory  = 0;
+    double prune_called         = 0;
+
+    double udp_in_errors     = 0;
+    double udp_rcvbuf_errors = 0;
+    double udp_no_ports      = 0;
+
+    double ip_in_discards  = 0;
+    double ip_out_discards = 0;
+};
+
+// A sample of the network counters, for computing rates
+struct net_stats_sample
+{
+    std::chrono::steady_clock::time_point time;
+    net_snmp snmp;
+    net_netstat netstat;
+
+    // The rates since an earlier sample. Counters that went backwards
+    // (e.g. sampled from another network namespace) are treated as zero.
+    net_stats_rates rates_since(const net_stats_sample& previous) const;
+};
+
+// Hint: See 'softnet_seq_show @ net/core/net-procfs.c'
+struct net_softnet_stat
+{
+    // The CPU is only printed since 5.10. For older kernels, it's the line
+    // number, which doesn't match the CPU when some CPUs are offline.
+    unsigned cpu = 0;
+
+    // 32-bit counters, that wrap around
+    uint32_t processed        = 0;
+    uint32_t dropped          = 0; // The backlog was full
+    uint32_t time_squeeze     = 0; // The budget or time ran out with work left
+    uint32_t received_rps     = 0; // Since 2.6.35
+    uint32_t flow_limit_count = 0; // Since 3.11
+
+    uint32_t backlog_len = 0; // Since 5.10
+};
+
+// Over the interval between two samples [unit: 1/sec]
+struct net_softnet_rates
+{
+    unsigned cpu            = 0;
+    double processed        = 0;
+    double dropped          = 0;
+    double time_squeeze     = 0;
+    double received_rps     = 0;
+    double flow_limit_count = 0;
+};
+
+// A sample of the per-CPU softnet counters, for computing rates
+struct net_softnet_sample
+{
+    std::chrono::steady_clock::time_point time;
+    std::vector<net_softnet_stat> cpus;
+
+    // The rates of every CPU that is part of both samples
+    std::vector<net_softnet_rates>
+    rates_since(const net_softnet_sample& previous) const;
+};
+
 // Hint: See 'https://docs.kernel.org/block/stat.html'
 struct block_stat
 {
@@ -24,6 +24,7 @@
 #include <limits>
 #include <set>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include <stdexcept>
 
@@ -87,6 +88,81 @@ stot(const std::string& str, T& out, base b = base::decimal)
     out = static_cast<T>(temp);
 }
 
+// Parse a number at the beginning of the [begin, end) range, without
+// allocating. Unlike stot, leading whitespaces are NOT skipped, and parsing
+// stops at the first char that isn't a valid digit.
+// Returns a pointer past the last consumed char.
+// Throws:
+// - std::invalid_argument if there are no digits to parse
+// - std::out_of_range if the value doesn't fit in the output type
+const char* parse_number(const char* begin, const char* end,
+                         unsigned long long& out, base b = base::decimal);
+
+template <typename T>
+typename std::enable_if<std::is_unsigned<T>::value, const char*>::type
+parse_number(const char* begin, const char* end, T& out,
+             base b = base::decimal)
+{
+    unsigned long long temp;
+    static_assert(sizeof(T) <= sizeof(temp), "unsigned parse_number is ill-defined");
+
+    const char* next = parse_number(begin, end, temp, b);
+    if (temp > std::numeric_limits<T>::max())
+    {
+        throw std::out_of_range("Number doesn't fit in output type");
+    }
+
+    out = static_cast<T>(temp);
+    return next;
+}
+
+template <typename T>
+typename std::enable_if<std::is_signed<T>::value, const char*>::type
+parse_number(const char* begin, const char* end, T& out,
+             base b = base::decimal)
+{
+    bool negative = (begin != end && *begin == '-');
+
+    unsigned long long temp;
+    static_assert(sizeof(T) <= sizeof(temp), "signed parse_number is ill-defined");
+
+    const char* next = parse_number(begin + (negative ? 1 : 0), end, temp, b);
+
+    using unsigned_type = typename std::make_unsigned<T>::type;
+    auto max = static_cast<unsigned_type>(std::numeric_limits<T>::max());
+    if (temp > max + (negative ? 1ULL : 0ULL))
+    {
+        throw std::out_of_range("Number doesn't fit in output type");
+    }
+
+    out = negative ? static_cast<T>(0 - static_cast<unsigned_type>(temp))
+                   : static_cast<T>(temp);
+    return next;
+}
+
+// Same as above, but the whole [begin, end) range must be the number.
+// Throws std::invalid_argument if anything follows its digits.
+template <typename T>
+void parse_whole_number(const char* begin, const char* end, T& out,
+                        base b = base::decimal)
+{
+    if (parse_number(begin, end, out, b) != end)
+    {
+        throw std::invalid_argument("Invalid number");
+    }
+}
+
+// Whether [begin, end) is exactly the given null-terminated string
+bool equals(const char* begin, const char* end, const char* str);
+
+// Return a pointer to the first non-whitespace char in [begin, end)
+// (Or 'end' if there is none).
+const char* skip_spaces(const char* begin, const char* end);
+
+// Return a pointer to the first whitespace char in [begin, end)
+// (Or 'end' if there is none).
+const char* find_space(const char* begin, const char* end);
+
 // Iterate over all the files in a given directory.
 // Calls 'handle' for every file found.
 // Note: 'handle' can be nullptr. Use this to count the number of files in a
@@ -94,6 +170,13 @@ stot(const std::string& str, T& out, base b = base::decimal)
 size_t iterate_files(const std::string& dir, bool include_dots,
                      std::function<void(const char*)> handle);
 
+// Same as above, but iterates over the directory referred to by 'dirfd'
+// using getdents64 directly, with no allocations. Useful for huge directories.
+// Note: The directory is read from its current offset, so 'dirfd' should
+// be a freshly opened descriptor.
+size_t iterate_files(int dirfd, bool include_dots,
+                     const std::function<void(const char*)>& handle);
+
 // Count all the files under the specified directory.
 // File can be any unix file type, i.e. regular file, directory, link, etc.
 size_t count_files(const std::string& dir, bool include_dots = false);
@@ -126,6 +209,13 @@ std::string readlink(const std::string& link, int dirfd = AT_FDCWD);
 std::string readfile(const std::string& file, size_t max_size,
                      bool trim_newline = true);
 
+// Read the whole content of the specified file into 'buffer', reusing its
+// capacity across calls.
+// If the file name is relative, then it is interpreted relative to the
+// directory referred to by the file descriptor dirfd.
+void readfile(const std::string& file, std::string& buffer,
+              int dirfd = AT_FDCWD);
+
 // Return a string containing the first line of the specified file.
 // The returned string doesn't contain the line terminator.
 std::string readline(const std::string& file);
@@ -155,6 +245,21 @@ void trim(std::string& str);
 // Ensure directory path is terminated using a directory separator '/'
 void ensure_dir_terminator(std::string& dir_path);
 
+// Call 'func' for every index in [0, count), using up to 'workers' threads.
+// When 'workers' is zero, a thread is used per hardware thread.
+// If any of the calls throws, the first exception is rethrown after all the
+// threads are done.
+void parallel_for(size_t count, size_t workers,
+                  const std::function<void(size_t)>& func);
+
+// Scramble the bits of a value, so that close values hash far apart.
+// Useful for hash tables of power-of-2 sizes, which only use the low bits.
+uint64_t mix_hash(uint64_t value);
+
+// Hash an address and a port into a seed (e.g. the hash of another address),
+// using mix_hash. Chaining two calls hashes a connection.
+uint64_t hash_address(uint64_t seed, const ip& addr, uint16_t port);
+
 // Parse IPv4 address in the hex form (e.g. 0x7f000001) and return it as a ip struct
 ip parse_ipv4_address(const std::string& ip_address_hex);
 
@@ -164,6 +269,11 @@ ip parse_ipv6_address(const std::string& ip_address_hex);
 // Figure out ip version (IPv4/IPv6), parse it and return it as a ip struct
 std::pair<ip, uint16_t> parse_address(const std::string& address_str);
 
+// Same as above, but parses the address at the beginning of [begin, end)
+// without allocating. Returns a pointer past the port.
+const char* parse_address(const char* begin, const char* end, ip& addr,
+                          uint16_t& port);
+
 } // namespace utils
 } // namespace impl
 } // namespace pfs
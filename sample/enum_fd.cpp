@@ -59,22 +59,19 @@ void enum_task_fds(const pfs::task& task)
 
         auto sockets = enum_sockets(task.get_net());
 
-        for (auto& iter : task.get_fds())
+        auto table = task.get_fd_table();
+        for (const auto& entry : table.entries)
         {
-            auto num = iter.first;
-            auto& fd = iter.second;
-
             std::ostringstream out;
-            out << "target[" << fd.get_target() << "] ";
+            out << "target[" << table.target(entry) << "] ";
 
-            auto inode = fd.get_target_stat().st_ino;
-            auto socket = sockets.find(inode);
-            if (socket != sockets.end())
+            auto socket = sockets.find(entry.inode);
+            if (entry.kind == pfs::fd_kind::socket && socket != sockets.end())
             {
                 out << socket->second;
             }
 
-            LOG(num << ": " << out.str());
+            LOG(entry.num << ": " << out.str());
         }
 
         LOG("");
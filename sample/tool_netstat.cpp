@@ -14,7 +14,10 @@
  *  limitations under the License.
  */
 
+#include <map>
 #include <regex>
+#include <set>
+#include <unordered_map>
 
 #include "format.hpp"
 #include "log.hpp"
@@ -23,30 +26,12 @@
 static const std::string TCP("tcp");
 static const std::string UDP("udp");
 
-void task_netstat(const pfs::task& task, const std::string& type)
+void task_netstat(int pid, const std::vector<pfs::net_socket>& sockets)
 {
     LOG("=========================================================");
-    LOG("Netstat for task ID[" << task.id() << "]");
+    LOG("Netstat for task ID[" << pid << "]");
     LOG("=========================================================");
 
-    auto inodes = task.get_fds_inodes();
-    pfs::net::net_socket_filter filter = [&inodes](const pfs::net_socket& sock){
-        return inodes.find(sock.inode) != inodes.end()
-            ? pfs::filter::action::keep
-            : pfs::filter::action::drop;
-    };
-
-    auto net = task.get_net();
-    std::vector<pfs::net_socket> sockets;
-    if (type == TCP)
-    {
-        sockets = net.get_tcp(filter);
-    }
-    else if (type == UDP)
-    {
-        sockets = net.get_udp(filter);
-    }
-
     print(sockets);
 }
 
@@ -65,24 +50,87 @@ int tool_netstat(std::vector<std::string>&& args)
 
     try
     {
+        std::set<int> pids;
+        for (unsigned arg = 1; arg < args.size(); ++arg)
+        {
+            pids.insert(std::stoi(args[arg]));
+        }
+
         pfs::procfs pfs;
 
-        if (args.size() > 1)
+        auto read_sockets = [&type](const pfs::net& net) {
+            return (type == TCP) ? net.get_tcp() : net.get_udp();
+        };
+
+        // The sockets tables are read once per network namespace, instead
+        // of once for every process that is a member of it.
+        std::vector<std::vector<pfs::net_socket>> tables;
+        std::unordered_multimap<ino_t, pfs::socket_owner> owners;
+
+        // Every task is printed, even if it has no sockets
+        std::map<int, std::vector<pfs::net_socket>> sockets;
+
+        if (pids.empty())
         {
-            for (unsigned arg = 1; arg < args.size(); ++arg)
+            // Index the owners of all the sockets in a single pass
+            owners = pfs.get_socket_owners();
+
+            for (auto& ns : pfs.collect_net_namespaces(read_sockets))
             {
-                auto id = std::stoi(args[arg]);
-                auto task = pfs.get_task(id);
-                task_netstat(task, type);
+                for (int pid : ns.first.pids)
+                {
+                    sockets[pid];
+                }
+                tables.push_back(std::move(ns.second));
             }
         }
         else
         {
-            for (auto& task : pfs.get_processes())
+            // Only the fds and the namespaces of the requested tasks
+            std::set<ino_t> namespaces;
+            for (int pid : pids)
             {
-                task_netstat(task, type);
+                auto task = pfs.get_task(pid);
+                for (const auto& fd : task.get_fd_table().entries)
+                {
+                    if (fd.kind == pfs::fd_kind::socket)
+                    {
+                        pfs::socket_owner owner;
+                        owner.pid = pid;
+                        owner.fd  = fd.num;
+                        owners.emplace(fd.inode, owner);
+                    }
+                }
+
+                if (namespaces.insert(task.get_ns("net")).second)
+                {
+                    tables.push_back(read_sockets(task.get_net()));
+                }
+                sockets[pid];
             }
         }
+
+        for (const auto& table : tables)
+        {
+            for (const auto& socket : table)
+            {
+                std::set<int> socket_pids; // Report shared sockets once per task
+                auto range = owners.equal_range(socket.inode);
+                for (auto iter = range.first; iter != range.second; ++iter)
+                {
+                    int pid = iter->second.pid;
+                    if (socket_pids.insert(pid).second)
+                    {
+                        sockets[pid].push_back(socket);
+                    }
+                }
+            }
+        }
+
+        for (const auto& task : sockets)
+        {
+            task_netstat(task.first, task.second);
+        }
     }
     catch (const std::runtime_error& ex)
     {
@@ -0,0 +1,239 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "pfs/cpu_usage.hpp"
+
+namespace pfs {
+
+namespace {
+
+// Some kernels let a single counter (mostly iowait) go slightly backwards,
+// which shouldn't reset the whole CPU.
+unsigned long long delta(unsigned long long current, unsigned long long last)
+{
+    return current > last ? current - last : 0;
+}
+
+// Guest time is already part of user and nice time
+unsigned long long total_time(const proc_stat::cpu& cpu)
+{
+    return cpu.user + cpu.nice + cpu.system + cpu.idle + cpu.iowait +
+           cpu.irq + cpu.softirq + cpu.steal;
+}
+
+} // anonymous namespace
+
+cpu_usage_tracker::cpu_usage_tracker(size_t history)
+    : _history(std::max<size_t>(history, 1)), _total_history(_history),
+      _scratch(_history)
+{}
+
+void cpu_usage_tracker::update(const proc_stat& stat)
+{
+    update(stat.cpus);
+}
+
+void cpu_usage_tracker::update(const proc_stat::sequence<proc_stat::cpu>& cpus)
+{
+    update_state(_total, cpus.total, _total_history.data());
+
+    // CPUs without an id are identified by their position
+    size_t required = _cpus.size();
+    for (size_t i = 0; i < cpus.per_item.size(); ++i)
+    {
+        int id   = cpus.per_item[i].id;
+        required = std::max(required,
+                            (id < 0 ? i : static_cast<size_t>(id)) + 1);
+    }
+
+    if (required > _cpus.size())
+    {
+        _cpus.resize(required);
+        _cpus_history.resize(required * _history);
+    }
+
+    for (auto& state : _cpus)
+    {
+        state.online = false;
+    }
+
+    for (size_t i = 0; i < cpus.per_item.size(); ++i)
+    {
+        const auto& cpu = cpus.per_item[i];
+        size_t id       = cpu.id < 0 ? i : static_cast<size_t>(cpu.id);
+
+        auto& state  = _cpus[id];
+        state.online = true;
+        update_state(state, cpu, &_cpus_history[id * _history]);
+    }
+
+    // Offline CPUs start over with a baseline once they are back
+    for (auto& state : _cpus)
+    {
+        if (!state.online)
+        {
+            state.has_last = false;
+            state.current  = cpu_utilization();
+        }
+    }
+}
+
+void cpu_usage_tracker::update_state(cpu_state& state,
+                                     const proc_stat::cpu& cpu,
+                                     cpu_utilization* history)
+{
+    proc_stat::cpu last = state.last;
+    bool has_last       = state.has_last;
+
+    state.last     = cpu;
+    state.has_last = true;
+
+    if (!has_last || total_time(cpu) < total_time(last))
+    {
+        // A baseline, or the counters were reset
+        state.current = cpu_utilization();
+        return;
+    }
+
+    auto user    = delta(cpu.user, last.user);
+    auto nice    = delta(cpu.nice, last.nice);
+    auto system  = delta(cpu.system, last.system);
+    auto idle    = delta(cpu.idle, last.idle);
+    auto iowait  = delta(cpu.iowait, last.iowait);
+    auto irq     = delta(cpu.irq, last.irq);
+    auto softirq = delta(cpu.softirq, last.softirq);
+    auto steal   = delta(cpu.steal, last.steal);
+
+    auto total = user + nice + system + idle + iowait + irq + softirq + steal;
+    if (total == 0)
+    {
+        // Sampled faster than the clock tick, so there's nothing new
+        return;
+    }
+
+    double scale = 100.0 / static_cast<double>(total);
+
+    cpu_utilization& current = state.current;
+    current.user       = static_cast<double>(user) * scale;
+    current.nice       = static_cast<double>(nice) * scale;
+    current.system     = static_cast<double>(system) * scale;
+    current.idle       = static_cast<double>(idle) * scale;
+    current.iowait     = static_cast<double>(iowait) * scale;
+    current.irq        = static_cast<double>(irq) * scale;
+    current.softirq    = static_cast<double>(softirq) * scale;
+    current.steal      = static_cast<double>(steal) * scale;
+    current.guest      = static_cast<double>(
+                        std::min(delta(cpu.guest, last.guest), user)) * scale;
+    current.guest_nice = static_cast<double>(std::min(
+                             delta(cpu.guest_nice, last.guest_nice), nice)) *
+                         scale;
+    current.busy = static_cast<double>(total - idle - iowait) * scale;
+
+    history[state.head] = current;
+    state.head          = (state.head + 1) % _history;
+    state.count         = std::min(state.count + 1, _history);
+}
+
+const cpu_utilization& cpu_usage_tracker::total() const
+{
+    return _total.current;
+}
+
+const cpu_utilization& cpu_usage_tracker::get_cpu(int id) const
+{
+    return get_state(id).current;
+}
+
+size_t cpu_usage_tracker::cpus() const
+{
+    return _cpus.size();
+}
+
+bool cpu_usage_tracker::is_online(int id) const
+{
+    return id >= 0 && static_cast<size_t>(id) < _cpus.size() &&
+           _cpus[id].online;
+}
+
+size_t cpu_usage_tracker::history() const
+{
+    return _history;
+}
+
+cpu_usage_window cpu_usage_tracker::get_total_window(
+    double cpu_utilization::*field, size_t samples) const
+{
+    return compute_window(_total, _total_history.data(), field, samples);
+}
+
+cpu_usage_window cpu_usage_tracker::get_cpu_window(
+    int id, double cpu_utilization::*field, size_t samples) const
+{
+    const auto& state = get_state(id);
+    return compute_window(state, &_cpus_history[id * _history], field,
+                          samples);
+}
+
+const cpu_usage_tracker::cpu_state& cpu_usage_tracker::get_state(int id) const
+{
+    if (id < 0 || static_cast<size_t>(id) >= _cpus.size())
+    {
+        throw std::out_of_range("Unknown CPU");
+    }
+    return _cpus[id];
+}
+
+cpu_usage_window cpu_usage_tracker::compute_window(
+    const cpu_state& state, const cpu_utilization* history,
+    double cpu_utilization::*field, size_t samples) const
+{
+    cpu_usage_window window;
+    window.samples = (samples == 0) ? state.count
+                                    : std::min(samples, state.count);
+    if (window.samples == 0)
+    {
+        return window;
+    }
+
+    // From the newest to the oldest
+    double sum = 0;
+    for (size_t i = 0; i < window.samples; ++i)
+    {
+        size_t slot  = (state.head + _history - 1 - i) % _history;
+        _scratch[i]  = history[slot].*field;
+        sum         += _scratch[i];
+    }
+
+    auto begin = _scratch.begin();
+    auto end   = begin + window.samples;
+
+    window.min  = *std::min_element(begin, end);
+    window.max  = *std::max_element(begin, end);
+    window.mean = sum / static_cast<double>(window.samples);
+
+    // Nearest rank
+    size_t rank = (window.samples * 95 + 99) / 100;
+    std::nth_element(begin, begin + (rank - 1), end);
+    window.p95 = *(begin + (rank - 1));
+
+    return window;
+}
+
+} // namespace pfs
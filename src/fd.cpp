@@ -20,19 +20,28 @@
 #include <system_error>
 
 #include "pfs/fd.hpp"
+#include "pfs/parsers/fdinfo.hpp"
 #include "pfs/utils.hpp"
 
 namespace pfs {
 
 using namespace impl;
 
-fd::fd(const std::string& fds_root, int num)
-    : _num(num), _link(build_link_path(fds_root, num))
+fd::fd(const std::string& task_root, int num)
+    : _num(num), _link(build_link_path(task_root, num)),
+      _info(build_info_path(task_root, num))
 {}
 
-std::string fd::build_link_path(const std::string& fds_root, int num)
+std::string fd::build_link_path(const std::string& task_root, int num)
 {
-    return fds_root + std::to_string(num);
+    static const std::string FDS_DIR("fd/");
+    return task_root + FDS_DIR + std::to_string(num);
+}
+
+std::string fd::build_info_path(const std::string& task_root, int num)
+{
+    static const std::string FDINFO_DIR("fdinfo/");
+    return task_root + FDINFO_DIR + std::to_string(num);
 }
 
 bool fd::operator<(const fd& rhs) const
@@ -79,4 +88,9 @@ struct stat fd::get_target_stat() const
     return st;
 }
 
+fd_info fd::get_info() const
+{
+    return parsers::fdinfo_parser().parse(_info);
+}
+
 } // namespace pfs
@@ -0,0 +1,147 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <system_error>
+#include <utility>
+
+#include "pfs/kpage_table.hpp"
+
+namespace pfs {
+
+namespace {
+
+static const size_t VALUE_SIZE = sizeof(uint64_t);
+
+// Upper bound of values fetched using a single read (64KB)
+static const size_t RUN_MAX = 8192;
+
+void pread_values(int fd, uint64_t pfn, size_t count, uint64_t* out)
+{
+    char* buffer = reinterpret_cast<char*>(out);
+    size_t total = count * VALUE_SIZE;
+    off_t offset = static_cast<off_t>(pfn * VALUE_SIZE);
+
+    size_t done = 0;
+    while (done < total)
+    {
+        ssize_t bytes = pread(fd, buffer + done, total - done, offset + done);
+        if (bytes == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            throw std::system_error(errno, std::system_category(),
+                                    "Couldn't read page table");
+        }
+
+        if (bytes == 0)
+        {
+            // PFN is beyond the end of physical memory
+            std::fill(out + done / VALUE_SIZE, out + count, 0);
+            break;
+        }
+
+        done += bytes;
+    }
+}
+
+} // anonymous namespace
+
+kpage_table::kpage_table(const std::string& path)
+    : _path(path), _fd(open(path.c_str(), O_RDONLY))
+{
+    if (_fd < 0)
+    {
+        throw std::system_error(errno, std::system_category(),
+                                "Couldn't open file");
+    }
+}
+
+kpage_table::kpage_table(kpage_table&& other)
+    : _path(other._path), _fd(other._fd)
+{
+    other._fd = -1;
+}
+
+kpage_table::~kpage_table()
+{
+    if (_fd >= 0)
+    {
+        close(_fd);
+    }
+}
+
+uint64_t kpage_table::read(uint64_t pfn)
+{
+    uint64_t value;
+    pread_values(_fd, pfn, 1, &value);
+    return value;
+}
+
+std::vector<uint64_t> kpage_table::read(const std::vector<pagemap_entry>& pages)
+{
+    std::vector<uint64_t> values(pages.size(), 0);
+
+    // Sort (pfn, index) pairs so that physically adjacent pages,
+    // regardless of their virtual order, are fetched together.
+    std::vector<std::pair<uint64_t, size_t>> pfns;
+    pfns.reserve(pages.size());
+    for (size_t i = 0; i < pages.size(); ++i)
+    {
+        uint64_t pfn = pages[i].pfn();
+        if (pfn != 0)
+        {
+            pfns.emplace_back(pfn, i);
+        }
+    }
+    std::sort(pfns.begin(), pfns.end());
+
+    std::vector<uint64_t> run;
+    size_t begin = 0;
+    while (begin < pfns.size())
+    {
+        uint64_t base = pfns[begin].first;
+
+        size_t end = begin + 1;
+        while (end < pfns.size() && pfns[end].first - base < RUN_MAX &&
+               pfns[end].first - pfns[end - 1].first <= 1)
+        {
+            ++end;
+        }
+
+        size_t span = pfns[end - 1].first - base + 1;
+        run.resize(span);
+        pread_values(_fd, base, span, run.data());
+
+        for (size_t i = begin; i < end; ++i)
+        {
+            values[pfns[i].second] = run[pfns[i].first - base];
+        }
+
+        begin = end;
+    }
+
+    return values;
+}
+
+} // namespace pfs
@@ -45,6 +45,20 @@ std::vector<uint8_t> mem::read(const mem_region& region)
                 region.end_address - region.start_address);
 }
 
+std::vector<std::vector<uint8_t>>
+mem::read(const std::vector<mem_region>& regions)
+{
+    std::vector<std::vector<uint8_t>> buffers;
+    buffers.reserve(regions.size());
+
+    for (const auto& region : regions)
+    {
+        buffers.emplace_back(read(region));
+    }
+
+    return buffers;
+}
+
 std::vector<uint8_t> mem::read(loff_t offset, size_t bytes)
 {
     std::vector<uint8_t> buffer(bytes);
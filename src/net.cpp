@@ -14,23 +14,234 @@
  *  limitations under the License.
  */
 
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_map>
+
 #include "pfs/net.hpp"
 #include "pfs/parsers/net_route.hpp"
+#include "pfs/parsers/conntrack.hpp"
 #include "pfs/parsers/net_arp.hpp"
+#include "pfs/parsers/net_counters.hpp"
 #include "pfs/parsers/net_device.hpp"
 #include "pfs/parsers/net_socket.hpp"
+#include "pfs/parsers/net_softnet_stat.hpp"
 #include "pfs/parsers/unix_socket.hpp"
 #include "pfs/parsers/netlink_socket.hpp"
 #include "pfs/parsers/lines.hpp"
+#include "pfs/sock_diag.hpp"
+#include "pfs/utils.hpp"
 
 namespace pfs {
 
 using namespace impl;
 
+namespace {
+
+struct tcp_health_key
+{
+    ip subnet;
+    uint16_t local_port;
+    int pid;
+
+    bool operator==(const tcp_health_key& rhs) const
+    {
+        return (subnet == rhs.subnet) && (local_port == rhs.local_port) &&
+               (pid == rhs.pid);
+    }
+};
+
+struct tcp_health_key_hash
+{
+    size_t operator()(const tcp_health_key& key) const
+    {
+        size_t hash = std::hash<int>()(key.subnet.domain);
+        auto combine = [&hash](size_t value) {
+            hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        };
+
+        for (auto word : key.subnet.storage)
+        {
+            combine(std::hash<uint32_t>()(word));
+        }
+        combine(std::hash<uint16_t>()(key.local_port));
+        combine(std::hash<int>()(key.pid));
+        return hash;
+    }
+};
+
+ip to_subnet(const ip& addr, uint8_t prefix_len)
+{
+    static const int WORD_BITS = 32;
+
+    ipv6 storage = {{}};
+    size_t words = addr.is_v4() ? 1 : storage.size();
+    for (size_t i = 0; i < words; ++i)
+    {
+        int bits = prefix_len - static_cast<int>(i) * WORD_BITS;
+        bits     = std::min(std::max(bits, 0), WORD_BITS);
+        uint32_t mask = bits ? htonl(~0U << (WORD_BITS - bits)) : 0;
+        storage[i]    = addr.storage[i] & mask;
+    }
+
+    return addr.is_v4() ? ip(static_cast<ipv4>(storage[0])) : ip(storage);
+}
+
+ip to_subnet(const inet_diag_msg& msg, uint8_t prefix_len)
+{
+    ipv6 storage;
+    std::copy(std::begin(msg.id.idiag_dst), std::end(msg.id.idiag_dst),
+              storage.begin());
+
+    ip addr = (msg.idiag_family == AF_INET) ? ip(static_cast<ipv4>(storage[0]))
+                                            : ip(storage);
+    return to_subnet(addr, prefix_len);
+}
+
+// When a socket is shared by several processes, it is attributed to the one
+// with the lowest pid, to keep the grouping stable.
+int find_owner(const std::unordered_multimap<ino_t, socket_owner>& owners,
+               ino_t inode)
+{
+    int pid    = 0;
+    auto range = owners.equal_range(inode);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (pid == 0 || it->second.pid < pid)
+        {
+            pid = it->second.pid;
+        }
+    }
+    return pid;
+}
+
+tcp_health_key make_tcp_health_key(const tcp_health_options& options,
+                                   const inet_diag_msg& msg)
+{
+    tcp_health_key key = {ip(), 0, 0};
+
+    switch (options.group_by)
+    {
+    case tcp_health::grouping::remote_subnet:
+        key.subnet = to_subnet(msg, (msg.idiag_family == AF_INET)
+                                        ? options.ipv4_prefix_len
+                                        : options.ipv6_prefix_len);
+        break;
+
+    case tcp_health::grouping::local_port:
+        key.local_port = ntohs(msg.id.idiag_sport);
+        break;
+
+    case tcp_health::grouping::owner:
+        key.pid = find_owner(*options.owners, msg.idiag_inode);
+        break;
+    }
+
+    return key;
+}
+
+struct conntrack_key
+{
+    conntrack_entry::state state;
+    uint8_t protocol;
+    uint16_t port;
+    ip subnet;
+
+    bool operator==(const conntrack_key& rhs) const
+    {
+        return (state == rhs.state) && (protocol == rhs.protocol) &&
+               (port == rhs.port) && (subnet == rhs.subnet);
+    }
+};
+
+struct conntrack_key_hash
+{
+    size_t operator()(const conntrack_key& key) const
+    {
+        size_t hash = std::hash<int>()(key.subnet.domain);
+        auto combine = [&hash](size_t value) {
+            hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        };
+
+        for (auto word : key.subnet.storage)
+        {
+            combine(std::hash<uint32_t>()(word));
+        }
+        combine(std::hash<int>()(static_cast<int>(key.state)));
+        combine(std::hash<int>()((key.protocol << 16) | key.port));
+        return hash;
+    }
+};
+
+conntrack_key make_conntrack_key(const conntrack_summary_options& options,
+                                 const conntrack_entry& entry)
+{
+    conntrack_key key = {conntrack_entry::state::none, 0, 0, ip()};
+
+    switch (options.group_by)
+    {
+    case conntrack_summary::grouping::state:
+        key.state    = entry.conn_state;
+        key.protocol = entry.protocol;
+        break;
+
+    case conntrack_summary::grouping::destination_port:
+        key.protocol = entry.protocol;
+        key.port     = entry.original.dst_port;
+        break;
+
+    case conntrack_summary::grouping::source_subnet:
+        key.subnet = to_subnet(entry.original.src,
+                               (entry.family == AF_INET)
+                                   ? options.ipv4_prefix_len
+                                   : options.ipv6_prefix_len);
+        break;
+    }
+
+    return key;
+}
+
+void add_tcp_info(tcp_health& health, const tcp_info& info, size_t length)
+{
+    static const size_t DELIVERY_RATE_END =
+        offsetof(tcp_info, tcpi_delivery_rate) +
+        sizeof(info.tcpi_delivery_rate);
+
+    ++health.sockets;
+    health.rtt.add(info.tcpi_rtt);
+    health.rttvar.add(info.tcpi_rttvar);
+    health.snd_cwnd.add(info.tcpi_snd_cwnd);
+    health.total_retrans.add(info.tcpi_total_retrans);
+    health.unacked.add(info.tcpi_unacked);
+
+    if (length >= DELIVERY_RATE_END)
+    {
+        health.delivery_rate.add(info.tcpi_delivery_rate);
+    }
+}
+
+} // anonymous namespace
+
 net::net(const std::string& parent_root)
-    : _parent_root(parent_root), _net_root(build_net_root(parent_root))
+    : _parent_root(parent_root), _net_root(build_net_root(parent_root)),
+      _backend(backend::automatic)
 {}
 
+void net::set_backend(backend b)
+{
+    _backend = b;
+}
+
 std::string net::build_net_root(const std::string& parent_root)
 {
     static const std::string NET_DIR("net/");
@@ -51,6 +262,14 @@ std::vector<net_device> net::get_dev(net_device_filter filter) const
     return output;
 }
 
+net_dev_sampler net::get_dev_sampler() const
+{
+    static const std::string DEV_FILE("dev");
+    auto path = _net_root + DEV_FILE;
+
+    return net_dev_sampler(path);
+}
+
 std::vector<net_socket> net::get_icmp(net_socket_filter filter) const
 {
     static const std::string ICMP_FILE("icmp");
@@ -76,27 +295,79 @@ std::vector<net_socket> net::get_raw6(net_socket_filter filter) const
 }
 
 std::vector<net_socket> net::get_tcp(net_socket_filter filter) const
+{
+    return get_tcp(net_socket_query(), filter);
+}
+
+std::vector<net_socket> net::get_tcp(const net_socket_query& query,
+                                     net_socket_filter filter) const
 {
     static const std::string TCP_FILE("tcp");
-    return get_net_sockets(TCP_FILE, filter);
+    return get_inet_sockets(TCP_FILE, AF_INET, IPPROTO_TCP, query, filter);
 }
 
 std::vector<net_socket> net::get_tcp6(net_socket_filter filter) const
+{
+    return get_tcp6(net_socket_query(), filter);
+}
+
+std::vector<net_socket> net::get_tcp6(const net_socket_query& query,
+                                     net_socket_filter filter) const
 {
     static const std::string TCP6_FILE("tcp6");
-    return get_net_sockets(TCP6_FILE, filter);
+    return get_inet_sockets(TCP6_FILE, AF_INET6, IPPROTO_TCP, query, filter);
 }
 
 std::vector<net_socket> net::get_udp(net_socket_filter filter) const
+{
+    return get_udp(net_socket_query(), filter);
+}
+
+std::vector<net_socket> net::get_udp(const net_socket_query& query,
+                                     net_socket_filter filter) const
 {
     static const std::string UDP_FILE("udp");
-    return get_net_sockets(UDP_FILE, filter);
+    return get_inet_sockets(UDP_FILE, AF_INET, IPPROTO_UDP, query, filter);
 }
 
 std::vector<net_socket> net::get_udp6(net_socket_filter filter) const
+{
+    return get_udp6(net_socket_query(), filter);
+}
+
+std::vector<net_socket> net::get_udp6(const net_socket_query& query,
+                                     net_socket_filter filter) const
+{
+    static const std::string UDP6_FILE("udp6");
+    return get_inet_sockets(UDP6_FILE, AF_INET6, IPPROTO_UDP, query, filter);
+}
+
+void net::collect_tcp(net_socket_table& table,
+                      const net_socket_query& query) const
+{
+    static const std::string TCP_FILE("tcp");
+    collect_inet_sockets(TCP_FILE, AF_INET, IPPROTO_TCP, query, table);
+}
+
+void net::collect_tcp6(net_socket_table& table,
+                       const net_socket_query& query) const
+{
+    static const std::string TCP6_FILE("tcp6");
+    collect_inet_sockets(TCP6_FILE, AF_INET6, IPPROTO_TCP, query, table);
+}
+
+void net::collect_udp(net_socket_table& table,
+                      const net_socket_query& query) const
+{
+    static const std::string UDP_FILE("udp");
+    collect_inet_sockets(UDP_FILE, AF_INET, IPPROTO_UDP, query, table);
+}
+
+void net::collect_udp6(net_socket_table& table,
+                       const net_socket_query& query) const
 {
     static const std::string UDP6_FILE("udp6");
-    return get_net_sockets(UDP6_FILE, filter);
+    collect_inet_sockets(UDP6_FILE, AF_INET6, IPPROTO_UDP, query, table);
 }
 
 std::vector<net_socket> net::get_udplite(net_socket_filter filter) const
@@ -126,16 +397,129 @@ std::vector<netlink_socket> net::get_netlink(netlink_socket_filter filter) const
 }
 
 std::vector<unix_socket> net::get_unix(unix_socket_filter filter) const
+{
+    return get_unix(unix_socket_query(), filter);
+}
+
+std::vector<unix_socket> net::get_unix(const unix_socket_query& query,
+                                       unix_socket_filter filter) const
 {
     static const std::string UNIX_FILE("unix");
     auto path = _net_root + UNIX_FILE;
 
     static const size_t HEADER_LINES = 1;
 
+    auto keep = [&](const unix_socket& socket) {
+        return !filter || filter(socket) == filter::action::keep;
+    };
+
+    if (use_sock_diag())
+    {
+        try
+        {
+            std::vector<unix_socket> output;
+            sock_diag::dump_unix(
+                query, [&](const unix_diag_msg& msg, const nlmsghdr& header) {
+                    auto socket = sock_diag::to_unix_socket(msg, header);
+                    if (keep(socket))
+                    {
+                        output.push_back(std::move(socket));
+                    }
+                });
+            return output;
+        }
+        catch (const std::system_error&)
+        {
+            // E.g. The unix_diag module isn't available
+            if (_backend == backend::sock_diag)
+            {
+                throw;
+            }
+        }
+    }
+
     std::vector<unix_socket> output;
-    parsers::parse_file_lines(path, std::back_inserter(output),
-                              parsers::parse_unix_socket_line,
-                              filter, HEADER_LINES);
+    parsers::parse_file_lines(
+        path, std::back_inserter(output), parsers::parse_unix_socket_line,
+        [&](const unix_socket& socket) {
+            return (query.matches(socket) && keep(socket))
+                       ? filter::action::keep
+                       : filter::action::drop;
+        },
+        HEADER_LINES);
+    return output;
+}
+
+std::vector<tcp_health>
+net::get_tcp_health(const tcp_health_options& options) const
+{
+    static const uint8_t INFO_EXTENSION = (1 << (INET_DIAG_INFO - 1));
+
+    if (!use_sock_diag())
+    {
+        throw std::runtime_error(
+            "TCP health is only available using sock_diag");
+    }
+
+    if (options.group_by == tcp_health::grouping::owner && !options.owners)
+    {
+        throw std::invalid_argument("Grouping by owner requires socket owners");
+    }
+
+    // Listening sockets have no peer, and their tcp_info is meaningless
+    auto query = options.query;
+    if (query.states.empty())
+    {
+        for (int state = static_cast<int>(net_socket::net_state::established);
+             state <= static_cast<int>(net_socket::net_state::closing); ++state)
+        {
+            query.states.insert(static_cast<net_socket::net_state>(state));
+        }
+    }
+    query.states.erase(net_socket::net_state::listen);
+    if (query.states.empty())
+    {
+        return {};
+    }
+
+    std::vector<tcp_health> output;
+    std::unordered_map<tcp_health_key, size_t, tcp_health_key_hash> groups;
+
+    tcp_info info;
+    auto handler = [&](const inet_diag_msg& msg, const nlmsghdr& header) {
+        // Time-wait and request sockets don't report tcp_info
+        size_t length = sock_diag::read_tcp_info(header, info);
+        if (length == 0)
+        {
+            return;
+        }
+
+        auto key      = make_tcp_health_key(options, msg);
+        auto inserted = groups.emplace(key, output.size());
+        if (inserted.second)
+        {
+            output.emplace_back();
+            output.back().remote_subnet = key.subnet;
+            output.back().local_port    = key.local_port;
+            output.back().pid           = key.pid;
+            if (options.group_by == tcp_health::grouping::remote_subnet)
+            {
+                output.back().prefix_len = (msg.idiag_family == AF_INET)
+                                               ? options.ipv4_prefix_len
+                                               : options.ipv6_prefix_len;
+            }
+        }
+
+        add_tcp_info(output[inserted.first->second], info, length);
+    };
+
+    sock_diag::dump_inet(AF_INET, IPPROTO_TCP, query, INFO_EXTENSION, handler);
+    sock_diag::dump_inet(AF_INET6, IPPROTO_TCP, query, INFO_EXTENSION, handler);
+
+    std::stable_sort(output.begin(), output.end(),
+                     [](const tcp_health& lhs, const tcp_health& rhs) {
+                         return lhs.sockets > rhs.sockets;
+                     });
     return output;
 }
 
@@ -153,6 +537,148 @@ std::vector<net_socket> net::get_net_sockets(const std::string& file,
     return output;
 }
 
+std::vector<net_socket> net::get_inet_sockets(const std::string& file,
+        int family, int protocol, const net_socket_query& query,
+        net_socket_filter filter) const
+{
+    if (use_sock_diag())
+    {
+        try
+        {
+            std::vector<net_socket> output;
+            sock_diag::dump_inet(
+                family, protocol, query, 0,
+                [&](const inet_diag_msg& msg, const nlmsghdr&) {
+                    auto socket = sock_diag::to_net_socket(msg);
+                    if (!filter || filter(socket) == filter::action::keep)
+                    {
+                        output.push_back(std::move(socket));
+                    }
+                });
+            return output;
+        }
+        catch (const std::system_error&)
+        {
+            // E.g. The protocol's diag module isn't available
+            if (_backend == backend::sock_diag)
+            {
+                throw;
+            }
+        }
+    }
+
+    if (query.empty())
+    {
+        return get_net_sockets(file, filter);
+    }
+
+    std::vector<net_socket> output;
+    parse_inet_sockets(file, query, [&](const net_socket& socket) {
+        if (!filter || filter(socket) == filter::action::keep)
+        {
+            output.push_back(socket);
+        }
+    });
+    return output;
+}
+
+void net::parse_inet_sockets(const std::string& file,
+        const net_socket_query& query,
+        const std::function<void(const net_socket&)>& handler) const
+{
+    auto path = _net_root + file;
+
+    static const size_t HEADER_LINES = 1;
+
+    std::ifstream in(path);
+    if (!in)
+    {
+        throw std::system_error(errno, std::system_category(),
+                                "Couldn't open file");
+    }
+
+    parsers::net_socket_prefilter prefilter(query);
+
+    // The line buffer only grows, so there are no allocations per line
+    std::string line;
+    net_socket socket;
+    for (size_t i = 0; std::getline(in, line); ++i)
+    {
+        if (i < HEADER_LINES || line.empty())
+        {
+            continue;
+        }
+
+        const char* begin = line.data();
+        const char* end   = begin + line.size();
+        if (!prefilter.matches(begin, end))
+        {
+            continue;
+        }
+
+        parsers::parse_net_socket(begin, end, socket);
+        if (query.matches(socket))
+        {
+            handler(socket);
+        }
+    }
+}
+
+void net::collect_inet_sockets(const std::string& file, int family,
+        int protocol, const net_socket_query& query,
+        net_socket_table& table) const
+{
+    table.clear();
+
+    if (use_sock_diag())
+    {
+        try
+        {
+            sock_diag::dump_inet(
+                family, protocol, query, 0,
+                [&table](const inet_diag_msg& msg, const nlmsghdr&) {
+                    table.push_back(sock_diag::to_net_socket(msg));
+                });
+            return;
+        }
+        catch (const std::system_error&)
+        {
+            // E.g. The protocol's diag module isn't available
+            if (_backend == backend::sock_diag)
+            {
+                throw;
+            }
+            table.clear();
+        }
+    }
+
+    parse_inet_sockets(file, query, [&table](const net_socket& socket) {
+        table.push_back(socket);
+    });
+}
+
+bool net::use_sock_diag() const
+{
+    return (_backend == backend::sock_diag) ||
+           (_backend == backend::automatic && is_caller_netns());
+}
+
+bool net::is_caller_netns() const
+{
+    static const std::string NET_NS("ns/net");
+    static const std::string CALLER_NET_NS("/proc/thread-self/ns/net");
+
+    try
+    {
+        return utils::get_inode(_parent_root + NET_NS) ==
+               utils::get_inode(CALLER_NET_NS);
+    }
+    catch (const std::system_error&)
+    {
+        return false;
+    }
+}
+
 std::vector<net_route> net::get_route(net_route_filter filter) const
 {
     static const std::string ROUTES_FILE("route");
@@ -167,6 +693,33 @@ std::vector<net_route> net::get_route(net_route_filter filter) const
     return output;
 }
 
+std::vector<net_ipv6_route>
+net::get_ipv6_route(net_ipv6_route_filter filter) const
+{
+    static const std::string IPV6_ROUTES_FILE("ipv6_route");
+    auto path = _net_root + IPV6_ROUTES_FILE;
+
+    std::vector<net_ipv6_route> output;
+    parsers::parse_file_lines(path, std::back_inserter(output),
+                              parsers::parse_net_ipv6_route_line, filter);
+    return output;
+}
+
+route_table net::get_route_table() const
+{
+    static const std::string IPV6_ROUTES_FILE("ipv6_route");
+    auto path = _net_root + IPV6_ROUTES_FILE;
+
+    // The file doesn't exist when IPv6 is disabled
+    std::vector<net_ipv6_route> ipv6_routes;
+    if (access(path.c_str(), F_OK) == 0)
+    {
+        ipv6_routes = get_ipv6_route();
+    }
+
+    return route_table(get_route(), ipv6_routes);
+}
+
 std::vector<net_arp> net::get_arp(net_arp_filter filter) const
 {
     static const std::string ARP_FILE("arp");
@@ -181,5 +734,149 @@ std::vector<net_arp> net::get_arp(net_arp_filter filter) const
     return output;
 }
 
+template <typename T>
+T net::parse_counters_file(const std::string& file,
+                           void (*parser)(std::istream&, T&)) const
+{
+    auto path = _net_root + file;
+
+    std::ifstream in(path);
+    if (!in)
+    {
+        throw std::system_error(errno, std::system_category(),
+                                "Couldn't open file");
+    }
+
+    T output;
+    parser(in, output);
+    return output;
+}
+
+net_snmp net::get_snmp() const
+{
+    static const std::string SNMP_FILE("snmp");
+    return parse_counters_file(SNMP_FILE, parsers::parse_snmp);
+}
+
+net_netstat net::get_netstat() const
+{
+    static const std::string NETSTAT_FILE("netstat");
+    return parse_counters_file(NETSTAT_FILE, parsers::parse_netstat);
+}
+
+net_sockstat net::get_sockstat() const
+{
+    static const std::string SOCKSTAT_FILE("sockstat");
+    return parse_counters_file(SOCKSTAT_FILE, parsers::parse_sockstat);
+}
+
+net_sockstat net::get_sockstat6() const
+{
+    static const std::string SOCKSTAT6_FILE("sockstat6");
+    return parse_counters_file(SOCKSTAT6_FILE, parsers::parse_sockstat);
+}
+
+net_stats_sample net::get_stats_sample() const
+{
+    net_stats_sample sample;
+    sample.snmp    = get_snmp();
+    sample.netstat = get_netstat();
+    sample.time    = std::chrono::steady_clock::now();
+    return sample;
+}
+
+std::vector<net_softnet_stat> net::get_softnet_stat() const
+{
+    static const std::string SOFTNET_STAT_FILE("softnet_stat");
+    auto path = _net_root + SOFTNET_STAT_FILE;
+
+    unsigned index = 0;
+    auto parser = [&index](const std::string& line) {
+        return parsers::parse_net_softnet_stat_line(line, index++);
+    };
+
+    std::vector<net_softnet_stat> output;
+    parsers::parse_file_lines(path, std::back_inserter(output), parser);
+    return output;
+}
+
+net_softnet_sample net::get_softnet_sample() const
+{
+    net_softnet_sample sample;
+    sample.cpus = get_softnet_stat();
+    sample.time = std::chrono::steady_clock::now();
+    return sample;
+}
+
+void net::for_each_conntrack(const conntrack_handler& handler) const
+{
+    static const std::string CONNTRACK_FILE("nf_conntrack");
+    auto path = _net_root + CONNTRACK_FILE;
+
+    std::ifstream in(path);
+    if (!in)
+    {
+        throw std::system_error(errno, std::system_category(),
+                                "Couldn't open file");
+    }
+
+    // Both the line and the entry are reused, so there are no allocations
+    // per entry
+    std::string line;
+    conntrack_entry entry;
+    while (std::getline(in, line))
+    {
+        if (line.empty())
+        {
+            continue;
+        }
+
+        parsers::parse_conntrack_line(line.data(), line.data() + line.size(),
+                                      entry);
+        handler(entry);
+    }
+}
+
+std::vector<conntrack_summary>
+net::get_conntrack_summary(const conntrack_summary_options& options) const
+{
+    std::vector<conntrack_summary> output;
+    std::unordered_map<conntrack_key, size_t, conntrack_key_hash> groups;
+
+    for_each_conntrack([&](const conntrack_entry& entry) {
+        auto key      = make_conntrack_key(options, entry);
+        auto inserted = groups.emplace(key, output.size());
+        if (inserted.second)
+        {
+            output.emplace_back();
+            auto& summary            = output.back();
+            summary.conn_state       = key.state;
+            summary.protocol         = key.protocol;
+            summary.destination_port = key.port;
+            summary.source_subnet    = key.subnet;
+            if (options.group_by == conntrack_summary::grouping::source_subnet)
+            {
+                summary.prefix_len = (entry.family == AF_INET)
+                                         ? options.ipv4_prefix_len
+                                         : options.ipv6_prefix_len;
+            }
+        }
+
+        auto& summary = output[inserted.first->second];
+        ++summary.entries;
+        summary.assured += entry.assured ? 1 : 0;
+        summary.unreplied += entry.unreplied ? 1 : 0;
+        summary.packets += entry.original_packets + entry.reply_packets;
+        summary.bytes += entry.original_bytes + entry.reply_bytes;
+    });
+
+    std::stable_sort(output.begin(), output.end(),
+                     [](const conntrack_summary& lhs,
+                        const conntrack_summary& rhs) {
+                         return lhs.entries > rhs.entries;
+                     });
+    return output;
+}
+
 
 } // namespace pfs
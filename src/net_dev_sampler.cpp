@@ -0,0 +1,318 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <system_error>
+
+#include "pfs/net_dev_sampler.hpp"
+#include "pfs/parser_error.hpp"
+#include "pfs/utils.hpp"
+
+namespace pfs {
+
+using namespace impl;
+
+namespace {
+
+// Enough for a few dozen interfaces, grown on demand
+static const size_t INITIAL_BUFFER_SIZE = 8192;
+
+static const size_t HEADER_LINES = 2;
+
+enum counter
+{
+    RX_BYTES = 0,
+    RX_PACKETS,
+    RX_ERRS,
+    RX_DROP,
+    RX_FIFO,
+    RX_FRAME,
+    RX_COMPRESSED,
+    RX_MULTICAST,
+    TX_BYTES,
+    TX_PACKETS,
+    TX_ERRS,
+    TX_DROP,
+    TX_FIFO,
+    TX_COLLS,
+    TX_CARRIER,
+    TX_COMPRESSED,
+    COUNTERS
+};
+
+// Parse a line into its interface name and counters, without allocating.
+// Example:
+// clang-format off
+//   eth0: 2893258    9219    0    0    0     0          0       556  1029533    7276    0    0    0     0       0          0
+// clang-format on
+void parse_line(const char* begin, const char* end, const char*& name_begin,
+                const char*& name_end, uint64_t (&values)[COUNTERS])
+{
+    static const char DELIM = ':';
+
+    name_begin = utils::skip_spaces(begin, end);
+    name_end   = std::find(name_begin, end, DELIM);
+    if (name_end == end || name_end == name_begin)
+    {
+        throw parser_error("Corrupted net device line - Missing interface",
+                           std::string(begin, end));
+    }
+
+    try
+    {
+        const char* curr = name_end + 1;
+        for (size_t i = 0; i < COUNTERS; ++i)
+        {
+            curr = utils::skip_spaces(curr, end);
+            curr = utils::parse_number(curr, end, values[i]);
+            if (curr != end && !isspace(*curr))
+            {
+                throw std::invalid_argument("Invalid counter");
+            }
+        }
+
+        if (utils::skip_spaces(curr, end) != end)
+        {
+            throw parser_error(
+                "Corrupted net device line - Wrong number of tokens",
+                std::string(begin, end));
+        }
+    }
+    catch (const std::invalid_argument&)
+    {
+        throw parser_error("Corrupted net device - Invalid argument",
+                           std::string(begin, end));
+    }
+    catch (const std::out_of_range&)
+    {
+        throw parser_error("Corrupted net device - Out of range",
+                           std::string(begin, end));
+    }
+}
+
+// The counters are 64-bit, so they never wrap in practice. Counters that
+// went backwards belong to an interface that was re-created under the same
+// name (e.g. veth and tun churn), and start over.
+bool is_reset(const net_device& before, const uint64_t (&after)[COUNTERS])
+{
+    return after[RX_BYTES] < before.rx_bytes ||
+           after[RX_PACKETS] < before.rx_packets ||
+           after[RX_ERRS] < before.rx_errs ||
+           after[RX_DROP] < before.rx_drop ||
+           after[TX_BYTES] < before.tx_bytes ||
+           after[TX_PACKETS] < before.tx_packets ||
+           after[TX_ERRS] < before.tx_errs ||
+           after[TX_DROP] < before.tx_drop;
+}
+
+double rate(uint64_t before, uint64_t after, double seconds)
+{
+    return static_cast<double>(after - before) / seconds;
+}
+
+} // anonymous namespace
+
+const size_t net_dev_sampler::npos = static_cast<size_t>(-1);
+
+net_dev_sampler::net_dev_sampler(const std::string& path)
+    : _path(path), _fd(open(path.c_str(), O_RDONLY)),
+      _buffer(INITIAL_BUFFER_SIZE), _sampled(false)
+{
+    if (_fd < 0)
+    {
+        throw std::system_error(errno, std::system_category(),
+                                "Couldn't open file");
+    }
+}
+
+net_dev_sampler::net_dev_sampler(net_dev_sampler&& other)
+    : _path(other._path), _fd(other._fd), _buffer(std::move(other._buffer)),
+      _interfaces(std::move(other._interfaces)),
+      _was_present(std::move(other._was_present)), _time(other._time),
+      _sampled(other._sampled)
+{
+    other._fd = -1;
+}
+
+net_dev_sampler::~net_dev_sampler()
+{
+    if (_fd >= 0)
+    {
+        close(_fd);
+    }
+}
+
+const std::vector<net_device_sample>& net_dev_sampler::interfaces() const
+{
+    return _interfaces;
+}
+
+std::chrono::steady_clock::time_point net_dev_sampler::time() const
+{
+    return _time;
+}
+
+size_t net_dev_sampler::find(const std::string& interface) const
+{
+    return find(interface.data(), interface.data() + interface.size(), 0);
+}
+
+size_t net_dev_sampler::find(const char* begin, const char* end,
+                             size_t hint) const
+{
+    size_t len   = static_cast<size_t>(end - begin);
+    size_t count = _interfaces.size();
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t index     = (hint + i) % count;
+        const auto& name = _interfaces[index].counters.interface;
+        if (name.size() == len && memcmp(name.data(), begin, len) == 0)
+        {
+            return index;
+        }
+    }
+    return npos;
+}
+
+size_t net_dev_sampler::read_file()
+{
+    while (true)
+    {
+        size_t done = 0;
+        while (done < _buffer.size())
+        {
+            ssize_t bytes = pread(_fd, _buffer.data() + done,
+                                  _buffer.size() - done, done);
+            if (bytes == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+
+                throw std::system_error(errno, std::system_category(),
+                                        "Couldn't read file");
+            }
+
+            if (bytes == 0)
+            {
+                return done;
+            }
+
+            done += bytes;
+        }
+
+        // The file might be larger than the buffer, read it again
+        _buffer.resize(_buffer.size() * 2);
+    }
+}
+
+void net_dev_sampler::sample()
+{
+    static const char NEWLINE = '\n';
+
+    size_t size = read_file();
+    auto now    = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(now - _time).count();
+    bool has_rates = _sampled && seconds > 0;
+
+    // Interfaces that aren't part of this sample stay missing
+    _was_present.resize(_interfaces.size());
+    for (size_t i = 0; i < _interfaces.size(); ++i)
+    {
+        _was_present[i]         = _interfaces[i].present;
+        _interfaces[i].present = false;
+        _interfaces[i].rates   = net_device_rates();
+    }
+
+    const char* curr = _buffer.data();
+    const char* end  = curr + size;
+    for (size_t line = 0; curr != end; ++line)
+    {
+        const char* line_begin = curr;
+        const char* line_end   = std::find(curr, end, NEWLINE);
+        curr = (line_end == end) ? end : line_end + 1;
+
+        if (line < HEADER_LINES || line_begin == line_end)
+        {
+            continue;
+        }
+
+        const char* name_begin;
+        const char* name_end;
+        uint64_t values[COUNTERS];
+        parse_line(line_begin, line_end, name_begin, name_end, values);
+
+        // Interfaces tend to keep their order between samples
+        size_t index = find(name_begin, name_end, line - HEADER_LINES);
+        if (index == npos)
+        {
+            index = _interfaces.size();
+            _interfaces.push_back(net_device_sample());
+            _interfaces.back().counters.interface.assign(name_begin, name_end);
+            _was_present.push_back(false);
+        }
+
+        auto& interface = _interfaces[index];
+        auto& counters  = interface.counters;
+
+        // A reset sets a new baseline, and reports no rates until the next
+        // sample
+        if (has_rates && _was_present[index] && !is_reset(counters, values))
+        {
+            auto& rates      = interface.rates;
+            rates.rx_bytes   = rate(counters.rx_bytes, values[RX_BYTES], seconds);
+            rates.rx_packets = rate(counters.rx_packets, values[RX_PACKETS], seconds);
+            rates.rx_errs    = rate(counters.rx_errs, values[RX_ERRS], seconds);
+            rates.rx_drop    = rate(counters.rx_drop, values[RX_DROP], seconds);
+            rates.tx_bytes   = rate(counters.tx_bytes, values[TX_BYTES], seconds);
+            rates.tx_packets = rate(counters.tx_packets, values[TX_PACKETS], seconds);
+            rates.tx_errs    = rate(counters.tx_errs, values[TX_ERRS], seconds);
+            rates.tx_drop    = rate(counters.tx_drop, values[TX_DROP], seconds);
+        }
+
+        counters.rx_bytes      = values[RX_BYTES];
+        counters.rx_packets    = values[RX_PACKETS];
+        counters.rx_errs       = values[RX_ERRS];
+        counters.rx_drop       = values[RX_DROP];
+        counters.rx_fifo       = values[RX_FIFO];
+        counters.rx_frame      = values[RX_FRAME];
+        counters.rx_compressed = values[RX_COMPRESSED];
+        counters.rx_multicast  = values[RX_MULTICAST];
+        counters.tx_bytes      = values[TX_BYTES];
+        counters.tx_packets    = values[TX_PACKETS];
+        counters.tx_errs       = values[TX_ERRS];
+        counters.tx_drop       = values[TX_DROP];
+        counters.tx_fifo       = values[TX_FIFO];
+        counters.tx_colls      = values[TX_COLLS];
+        counters.tx_carrier    = values[TX_CARRIER];
+        counters.tx_compressed = values[TX_COMPRESSED];
+
+        interface.present = true;
+    }
+
+    _time    = now;
+    _sampled = true;
+}
+
+} // namespace pfs
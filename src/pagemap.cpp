@@ -0,0 +1,246 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <system_error>
+
+#include "pfs/pagemap.hpp"
+
+namespace pfs {
+
+namespace {
+
+// Entries read per system call by the streaming APIs (32KB)
+static const size_t SCRATCH_ENTRIES = 4096;
+
+} // anonymous namespace
+
+pagemap::pagemap(const std::string& path)
+    : _path(path), _fd(open(path.c_str(), O_RDONLY))
+{
+    if (_fd < 0)
+    {
+        throw std::system_error(errno, std::system_category(),
+                                "Couldn't open file");
+    }
+}
+
+pagemap::pagemap(pagemap&& other) : _path(other._path), _fd(other._fd)
+{
+    other._fd = -1;
+}
+
+pagemap::~pagemap()
+{
+    if (_fd >= 0)
+    {
+        close(_fd);
+    }
+}
+
+size_t pagemap::page_size()
+{
+    static const size_t PAGE_SIZE = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return PAGE_SIZE;
+}
+
+size_t pagemap::read_entries(size_t first, size_t count, pagemap_entry* out)
+{
+    static const size_t ENTRY_SIZE = sizeof(pagemap_entry::raw_type);
+
+    char* buffer = reinterpret_cast<char*>(out);
+    size_t total = count * ENTRY_SIZE;
+    off_t offset = static_cast<off_t>(first * ENTRY_SIZE);
+
+    size_t done = 0;
+    while (done < total)
+    {
+        ssize_t bytes = pread(_fd, buffer + done, total - done, offset + done);
+        if (bytes == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            throw std::system_error(errno, std::system_category(),
+                                    "Couldn't read pagemap");
+        }
+
+        if (bytes == 0)
+        {
+            break; // Reached the end of the address space
+        }
+
+        done += bytes;
+    }
+
+    return done / ENTRY_SIZE;
+}
+
+std::vector<pagemap_entry> pagemap::read(const mem_region& region)
+{
+    return read(region.start_address, region.end_address);
+}
+
+std::vector<pagemap_entry> pagemap::read(size_t start_address,
+                                         size_t end_address)
+{
+    static_assert(sizeof(pagemap_entry) == sizeof(pagemap_entry::raw_type),
+                  "pagemap entries are read directly into the output");
+
+    if (end_address <= start_address)
+    {
+        return {};
+    }
+
+    size_t first = start_address / page_size();
+    size_t last  = (end_address - 1) / page_size();
+
+    std::vector<pagemap_entry> entries(last - first + 1);
+    entries.resize(read_entries(first, entries.size(), entries.data()));
+    return entries;
+}
+
+page_residency pagemap::read_residency(const mem_region& region)
+{
+    return read_residency(region.start_address, region.end_address);
+}
+
+page_residency pagemap::read_residency(size_t start_address,
+                                       size_t end_address)
+{
+    page_residency residency;
+    residency.page_size     = page_size();
+    residency.start_address = start_address - (start_address % page_size());
+
+    if (end_address <= start_address)
+    {
+        return residency;
+    }
+
+    size_t first = start_address / page_size();
+    size_t count = (end_address - 1) / page_size() - first + 1;
+
+    residency.present.resize(count);
+    residency.swapped.resize(count);
+
+    std::vector<pagemap_entry> scratch(std::min(count, SCRATCH_ENTRIES));
+
+    size_t index = 0;
+    while (index < count)
+    {
+        size_t chunk = std::min(count - index, scratch.size());
+        size_t read  = read_entries(first + index, chunk, scratch.data());
+
+        for (size_t i = 0; i < read; ++i)
+        {
+            residency.present[index + i] = scratch[i].is_present();
+            residency.swapped[index + i] = scratch[i].is_swapped();
+        }
+
+        index += read;
+        if (read < chunk)
+        {
+            break;
+        }
+    }
+
+    residency.present.resize(index);
+    residency.swapped.resize(index);
+    return residency;
+}
+
+std::vector<mem_region> pagemap::read_soft_dirty(const mem_region& region,
+                                                 size_t max_gap_pages)
+{
+    std::vector<mem_region> dirty;
+
+    if (region.end_address <= region.start_address)
+    {
+        return dirty;
+    }
+
+    size_t first = region.start_address / page_size();
+    size_t count = (region.end_address - 1) / page_size() - first + 1;
+
+    std::vector<pagemap_entry> scratch(std::min(count, SCRATCH_ENTRIES));
+
+    // Runs are clamped, as the first and last pages might be only partially
+    // covered by the region.
+    auto add_run = [&](size_t begin, size_t end) {
+        size_t start_address =
+            std::max((first + begin) * page_size(), region.start_address);
+        size_t end_address =
+            std::min((first + end) * page_size(), region.end_address);
+
+        if (!dirty.empty() && start_address - dirty.back().end_address <=
+                                  max_gap_pages * page_size())
+        {
+            dirty.back().end_address = end_address;
+            return;
+        }
+
+        mem_region run    = region;
+        run.start_address = start_address;
+        run.end_address   = end_address;
+        run.offset        = region.offset + (start_address - region.start_address);
+        dirty.push_back(std::move(run));
+    };
+
+    static const size_t NO_RUN = static_cast<size_t>(-1);
+    size_t run_begin = NO_RUN;
+
+    size_t index = 0;
+    while (index < count)
+    {
+        size_t chunk = std::min(count - index, scratch.size());
+        size_t read  = read_entries(first + index, chunk, scratch.data());
+
+        for (size_t i = 0; i < read; ++i)
+        {
+            bool is_dirty = scratch[i].is_soft_dirty();
+            if (is_dirty && run_begin == NO_RUN)
+            {
+                run_begin = index + i;
+            }
+            else if (!is_dirty && run_begin != NO_RUN)
+            {
+                add_run(run_begin, index + i);
+                run_begin = NO_RUN;
+            }
+        }
+
+        index += read;
+        if (read < chunk)
+        {
+            break;
+        }
+    }
+
+    if (run_begin != NO_RUN)
+    {
+        add_run(run_begin, index);
+    }
+
+    return dirty;
+}
+
+} // namespace pfs
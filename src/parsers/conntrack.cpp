@@ -0,0 +1,261 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "pfs/parsers/conntrack.hpp"
+#include "pfs/parser_error.hpp"
+#include "pfs/utils.hpp"
+
+namespace pfs {
+namespace impl {
+namespace parsers {
+
+namespace {
+
+// clang-format off
+static const struct
+{
+    const char* name;
+    conntrack_entry::state value;
+} STATES[] = {
+    { "NONE",        conntrack_entry::state::none },
+    { "SYN_SENT",    conntrack_entry::state::syn_sent },
+    { "SYN_RECV",    conntrack_entry::state::syn_recv },
+    { "ESTABLISHED", conntrack_entry::state::established },
+    { "FIN_WAIT",    conntrack_entry::state::fin_wait },
+    { "CLOSE_WAIT",  conntrack_entry::state::close_wait },
+    { "LAST_ACK",    conntrack_entry::state::last_ack },
+    { "TIME_WAIT",   conntrack_entry::state::time_wait },
+    { "CLOSE",       conntrack_entry::state::close },
+    { "SYN_SENT2",   conntrack_entry::state::syn_sent2 },
+};
+// clang-format on
+
+// As printed by the kernel, which are the values of AF_INET and AF_INET6
+static const int IPV4_FAMILY = 2;
+static const int IPV6_FAMILY = 10;
+
+conntrack_entry::state parse_state(const char* begin, const char* end)
+{
+    for (const auto& state : STATES)
+    {
+        if (utils::equals(begin, end, state.name))
+        {
+            return state.value;
+        }
+    }
+    return conntrack_entry::state::other;
+}
+
+ip parse_ip(const char* begin, const char* end, int family)
+{
+    char buffer[INET6_ADDRSTRLEN];
+
+    size_t len = static_cast<size_t>(end - begin);
+    if (len >= sizeof(buffer))
+    {
+        throw std::invalid_argument("Address is too long");
+    }
+    memcpy(buffer, begin, len);
+    buffer[len] = '\0';
+
+    ipv6 storage = {{}};
+    if (inet_pton(family, buffer, storage.data()) != 1)
+    {
+        throw std::invalid_argument("Invalid address");
+    }
+
+    return (family == AF_INET) ? ip(static_cast<ipv4>(storage[0]))
+                               : ip(storage);
+}
+
+} // anonymous namespace
+
+void parse_conntrack_line(const char* begin, const char* end,
+                          conntrack_entry& out)
+{
+    // Some examples:
+    // clang-format off
+    // ipv4     2 tcp      6 431999 ESTABLISHED src=10.0.0.2 dst=10.0.0.1 sport=40000 dport=80 packets=3 bytes=180 src=10.0.0.1 dst=10.0.0.2 sport=80 dport=40000 packets=2 bytes=112 [ASSURED] mark=0 zone=0 use=2
+    // ipv4     2 udp      17 28 src=10.0.0.2 dst=8.8.8.8 sport=53000 dport=53 [UNREPLIED] src=8.8.8.8 dst=10.0.0.2 sport=53 dport=53000 mark=0 use=2
+    // ipv6     10 icmpv6   58 29 src=fd00::2 dst=fd00::1 type=128 code=0 id=7 src=fd00::1 dst=fd00::2 type=129 code=0 id=7 mark=0 use=2
+    // clang-format on
+
+    enum token
+    {
+        FAMILY_NAME   = 0,
+        FAMILY        = 1,
+        PROTOCOL_NAME = 2,
+        PROTOCOL      = 3,
+        TIMEOUT       = 4,
+        HEADER_COUNT
+    };
+
+    static const char ASSIGN = '=';
+    static const char FLAG   = '[';
+
+    out = conntrack_entry();
+
+    try
+    {
+        const char* curr = utils::skip_spaces(begin, end);
+        for (size_t i = 0; i < HEADER_COUNT; ++i)
+        {
+            if (curr == end)
+            {
+                throw parser_error("Corrupted conntrack line - Missing tokens",
+                                   std::string(begin, end));
+            }
+
+            const char* token_end = utils::find_space(curr, end);
+
+            int family;
+            switch (i)
+            {
+            case FAMILY:
+                utils::parse_whole_number(curr, token_end, family);
+                if (family == IPV4_FAMILY)
+                {
+                    out.family = AF_INET;
+                }
+                else if (family == IPV6_FAMILY)
+                {
+                    out.family = AF_INET6;
+                }
+                else
+                {
+                    throw std::invalid_argument("Unknown family");
+                }
+                break;
+
+            case PROTOCOL:
+                utils::parse_whole_number(curr, token_end, out.protocol);
+                break;
+
+            case TIMEOUT:
+                utils::parse_whole_number(curr, token_end, out.timeout);
+                break;
+            }
+
+            curr = utils::skip_spaces(token_end, end);
+        }
+
+        // The first 'src' starts the original tuple, the second the reply
+        conntrack_entry::tuple* tuple = nullptr;
+        for (; curr != end; curr = utils::skip_spaces(curr, end))
+        {
+            const char* token_end = utils::find_space(curr, end);
+            const char* assign    = std::find(curr, token_end, ASSIGN);
+            const char* value     = assign + 1;
+
+            if (*curr == FLAG)
+            {
+                if (utils::equals(curr, token_end, "[ASSURED]"))
+                {
+                    out.assured = true;
+                }
+                else if (utils::equals(curr, token_end, "[UNREPLIED]"))
+                {
+                    out.unreplied = true;
+                }
+            }
+            else if (assign == token_end)
+            {
+                if (tuple)
+                {
+                    throw std::invalid_argument("Unexpected state");
+                }
+                out.conn_state = parse_state(curr, token_end);
+            }
+            else if (utils::equals(curr, assign, "src"))
+            {
+                if (tuple == &out.reply)
+                {
+                    throw std::invalid_argument("Too many tuples");
+                }
+                tuple = tuple ? &out.reply : &out.original;
+                tuple->src = parse_ip(value, token_end, out.family);
+            }
+            else if (!tuple)
+            {
+                // Protocol specific values may precede the first tuple, e.g.
+                // "timeout=180, stream_timeout=18000" of GRE, so skip them
+            }
+            else if (utils::equals(curr, assign, "dst"))
+            {
+                tuple->dst = parse_ip(value, token_end, out.family);
+            }
+            else if (utils::equals(curr, assign, "sport"))
+            {
+                utils::parse_whole_number(value, token_end, tuple->src_port);
+            }
+            else if (utils::equals(curr, assign, "dport"))
+            {
+                utils::parse_whole_number(value, token_end, tuple->dst_port);
+            }
+            else if (utils::equals(curr, assign, "packets"))
+            {
+                out.has_counters = true;
+                utils::parse_whole_number(value, token_end, (tuple == &out.original)
+                                                  ? out.original_packets
+                                                  : out.reply_packets);
+            }
+            else if (utils::equals(curr, assign, "bytes"))
+            {
+                out.has_counters = true;
+                utils::parse_whole_number(value, token_end, (tuple == &out.original)
+                                                  ? out.original_bytes
+                                                  : out.reply_bytes);
+            }
+            else if (utils::equals(curr, assign, "mark"))
+            {
+                utils::parse_whole_number(value, token_end, out.mark);
+            }
+            else if (utils::equals(curr, assign, "zone"))
+            {
+                utils::parse_whole_number(value, token_end, out.zone);
+            }
+
+            curr = token_end;
+        }
+
+        if (tuple != &out.reply)
+        {
+            throw std::invalid_argument("Missing tuple");
+        }
+    }
+    catch (const std::invalid_argument&)
+    {
+        throw parser_error("Corrupted conntrack line - Invalid argument",
+                           std::string(begin, end));
+    }
+    catch (const std::out_of_range&)
+    {
+        throw parser_error("Corrupted conntrack line - Out of range",
+                           std::string(begin, end));
+    }
+}
+
+} // namespace parsers
+} // namespace impl
+} // namespace pfs
@@ -0,0 +1,162 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cstring>
+#include <stdexcept>
+
+#include "pfs/parsers/fd_link.hpp"
+#include "pfs/utils.hpp"
+
+namespace pfs {
+namespace impl {
+namespace parsers {
+
+namespace {
+
+struct anon_inode_kind
+{
+    const char* name;
+    fd_kind kind;
+};
+
+// clang-format off
+static const anon_inode_kind ANON_INODE_KINDS[] = {
+    { "[eventpoll]", fd_kind::eventpoll },
+    { "[eventfd]",   fd_kind::eventfd },
+    { "[timerfd]",   fd_kind::timerfd },
+    { "[signalfd]",  fd_kind::signalfd },
+    { "inotify",     fd_kind::inotify },
+    { "[fanotify]",  fd_kind::fanotify },
+    { "[pidfd]",     fd_kind::pidfd },
+};
+// clang-format on
+
+bool starts_with(const char* link, size_t size, const char* prefix,
+                 size_t prefix_len)
+{
+    return size >= prefix_len && memcmp(link, prefix, prefix_len) == 0;
+}
+
+// Parse a "<type>:[<inode>]" link, where 'colon' points to the delimiter
+bool parse_inode_link(const char* colon, const char* end, ino_t& inode)
+{
+    static const char OPEN  = '[';
+    static const char CLOSE = ']';
+
+    if (end - colon < 4 || colon[1] != OPEN || end[-1] != CLOSE)
+    {
+        return false;
+    }
+
+    try
+    {
+        return utils::parse_number(colon + 2, end - 1, inode) == end - 1;
+    }
+    catch (const std::logic_error&)
+    {
+        return false;
+    }
+}
+
+} // anonymous namespace
+
+fd_kind parse_fd_link(const char* link, size_t size, ino_t& inode)
+{
+    // Some examples:
+    // clang-format off
+    // /dev/null
+    // /tmp/file.txt (deleted)
+    // /memfd:shm (deleted)
+    // socket:[12345]
+    // pipe:[12345]
+    // net:[4026531840]
+    // anon_inode:[eventpoll]
+    // anon_inode:inotify
+    // anon_inode:bpf-map
+    // clang-format on
+
+    static const char PATH_PREFIX         = '/';
+    static const char MEMFD_PREFIX[]      = "/memfd:";
+    static const char SOCKET_TYPE[]       = "socket";
+    static const char PIPE_TYPE[]         = "pipe";
+    static const char ANON_INODE_PREFIX[] = "anon_inode:";
+    static const char TYPE_DELIM          = ':';
+
+    inode = INVALID_INODE;
+
+    if (size == 0)
+    {
+        return fd_kind::unknown;
+    }
+
+    if (link[0] == PATH_PREFIX)
+    {
+        return starts_with(link, size, MEMFD_PREFIX, sizeof(MEMFD_PREFIX) - 1)
+                   ? fd_kind::memfd
+                   : fd_kind::file;
+    }
+
+    const char* end = link + size;
+
+    if (starts_with(link, size, ANON_INODE_PREFIX,
+                    sizeof(ANON_INODE_PREFIX) - 1))
+    {
+        const char* name = link + sizeof(ANON_INODE_PREFIX) - 1;
+        size_t name_len  = static_cast<size_t>(end - name);
+
+        for (const auto& anon : ANON_INODE_KINDS)
+        {
+            if (strlen(anon.name) == name_len &&
+                memcmp(name, anon.name, name_len) == 0)
+            {
+                return anon.kind;
+            }
+        }
+        return fd_kind::anon_inode;
+    }
+
+    auto colon = static_cast<const char*>(memchr(link, TYPE_DELIM, size));
+    if (!colon || !parse_inode_link(colon, end, inode))
+    {
+        inode = INVALID_INODE;
+        return fd_kind::unknown;
+    }
+
+    size_t type_len = static_cast<size_t>(colon - link);
+    if (type_len == sizeof(SOCKET_TYPE) - 1 &&
+        memcmp(link, SOCKET_TYPE, type_len) == 0)
+    {
+        return fd_kind::socket;
+    }
+
+    if (type_len == sizeof(PIPE_TYPE) - 1 &&
+        memcmp(link, PIPE_TYPE, type_len) == 0)
+    {
+        return fd_kind::pipe;
+    }
+
+    return fd_kind::ns;
+}
+
+bool parse_socket_link(const char* link, size_t size, ino_t& inode)
+{
+    return parse_fd_link(link, size, inode) == fd_kind::socket;
+}
+
+} // namespace parsers
+} // namespace impl
+} // namespace pfs
@@ -0,0 +1,260 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <linux/kdev_t.h>
+
+#include "pfs/parsers/fdinfo.hpp"
+#include "pfs/parsers/number.hpp"
+#include "pfs/parser_error.hpp"
+#include "pfs/utils.hpp"
+
+namespace pfs {
+namespace impl {
+namespace parsers {
+
+namespace {
+
+using field  = std::pair<std::string, std::string>;
+using fields = std::vector<field>;
+
+// Split "<first> <key>:<value> <key>: <value> ..." into its fields.
+// The first value doesn't have a key, so it is stored with an empty one.
+fields split_fields(const std::string& value)
+{
+    static const char KEY_DELIM = ':';
+
+    fields output;
+
+    auto tokens = utils::split(value);
+    for (size_t i = 0; i < tokens.size(); ++i)
+    {
+        auto& token = tokens[i];
+
+        size_t delim = token.find(KEY_DELIM);
+        if (delim == std::string::npos)
+        {
+            if (!output.empty())
+            {
+                throw parser_error("Corrupted fdinfo - Missing key", value);
+            }
+            output.emplace_back(std::string(), std::move(token));
+        }
+        else if (delim + 1 == token.size())
+        {
+            if (i + 1 == tokens.size())
+            {
+                throw parser_error("Corrupted fdinfo - Missing value", value);
+            }
+            token.pop_back();
+            output.emplace_back(std::move(token), std::move(tokens[++i]));
+        }
+        else
+        {
+            output.emplace_back(token.substr(0, delim),
+                                token.substr(delim + 1));
+        }
+    }
+
+    return output;
+}
+
+// The kernel's internal device encoding, used by fdinfo
+dev_t to_device(const std::string& value)
+{
+    static const unsigned MINOR_BITS = 20;
+    static const unsigned MINOR_MASK = (1U << MINOR_BITS) - 1;
+
+    unsigned sdev;
+    to_number(value, sdev, utils::base::hex);
+    return MKDEV(sdev >> MINOR_BITS, sdev & MINOR_MASK);
+}
+
+std::chrono::nanoseconds to_timespec(const std::string& value)
+{
+    // Format: (<seconds>, <nanoseconds>)
+
+    static const char OPEN  = '(';
+    static const char CLOSE = ')';
+
+    if (value.size() < 2 || value.front() != OPEN || value.back() != CLOSE)
+    {
+        throw parser_error("Corrupted fdinfo - Invalid timespec", value);
+    }
+
+    auto parts = utils::split(value.substr(1, value.size() - 2), ',');
+    if (parts.size() != 2)
+    {
+        throw parser_error("Corrupted fdinfo - Invalid timespec", value);
+    }
+
+    long long sec;
+    long long nsec;
+    to_number(parts[0], sec);
+    to_number(parts[1], nsec);
+    return std::chrono::seconds(sec) + std::chrono::nanoseconds(nsec);
+}
+
+void parse_pos(const std::string& value, fd_info& out)
+{
+    to_number(value, out.pos);
+}
+
+void parse_flags(const std::string& value, fd_info& out)
+{
+    to_number(value, out.flags, utils::base::octal);
+}
+
+void parse_mnt_id(const std::string& value, fd_info& out)
+{
+    to_number(value, out.mnt_id);
+}
+
+void parse_ino(const std::string& value, fd_info& out)
+{
+    to_number(value, out.inode);
+}
+
+void parse_eventfd_count(const std::string& value, fd_info& out)
+{
+    to_number(value, out.eventfd_count, utils::base::hex);
+}
+
+void parse_tfd(const std::string& value, fd_info& out)
+{
+    // Format:
+    // tfd:        5 events:       19 data:                5  pos:0 ino:61af sdev:7
+
+    fd_info::epoll_target target;
+
+    for (const auto& field : split_fields(value))
+    {
+        if (field.first.empty())
+        {
+            to_number(field.second, target.fd);
+        }
+        else if (field.first == "events")
+        {
+            to_number(field.second, target.events, utils::base::hex);
+        }
+        else if (field.first == "data")
+        {
+            to_number(field.second, target.data, utils::base::hex);
+        }
+        else if (field.first == "ino")
+        {
+            to_number(field.second, target.inode, utils::base::hex);
+        }
+        else if (field.first == "sdev")
+        {
+            target.device = to_device(field.second);
+        }
+    }
+
+    out.epoll_targets.push_back(target);
+}
+
+void parse_inotify(const std::string& value, fd_info& out)
+{
+    // Format:
+    // inotify wd:3 ino:9e7e sdev:800013 mask:800afce ignored_mask:0 fhandle-bytes:8 fhandle-type:1 f_handle:7e9e0000640d1b6d
+
+    fd_info::inotify_watch watch;
+
+    for (const auto& field : split_fields(value))
+    {
+        if (field.first.empty())
+        {
+            to_number(field.second, watch.wd);
+        }
+        else if (field.first == "ino")
+        {
+            to_number(field.second, watch.inode, utils::base::hex);
+        }
+        else if (field.first == "sdev")
+        {
+            watch.device = to_device(field.second);
+        }
+        else if (field.first == "mask")
+        {
+            to_number(field.second, watch.mask, utils::base::hex);
+        }
+    }
+
+    out.inotify_watches.push_back(watch);
+}
+
+void parse_clockid(const std::string& value, fd_info& out)
+{
+    to_number(value, out.timerfd.clock_id);
+}
+
+void parse_ticks(const std::string& value, fd_info& out)
+{
+    to_number(value, out.timerfd.ticks);
+}
+
+void parse_settime_flags(const std::string& value, fd_info& out)
+{
+    to_number(value, out.timerfd.settime_flags, utils::base::octal);
+}
+
+void parse_it_value(const std::string& value, fd_info& out)
+{
+    out.timerfd.value = to_timespec(value);
+}
+
+void parse_it_interval(const std::string& value, fd_info& out)
+{
+    out.timerfd.interval = to_timespec(value);
+}
+
+void parse_sigmask(const std::string& value, fd_info& out)
+{
+    to_number(value, out.signalfd_mask.raw, utils::base::hex);
+}
+
+void parse_pid(const std::string& value, fd_info& out)
+{
+    to_number(value, out.pidfd_pid);
+}
+
+} // anonymous namespace
+
+const char fdinfo_parser::DELIM = ':';
+
+// clang-format off
+const fdinfo_parser::value_parsers fdinfo_parser::PARSERS = {
+    { "pos",           parse_pos },
+    { "flags",         parse_flags },
+    { "mnt_id",        parse_mnt_id },
+    { "ino",           parse_ino },
+    { "eventfd-count", parse_eventfd_count },
+    { "tfd",           parse_tfd },
+    { "inotify wd",    parse_inotify },
+    { "clockid",       parse_clockid },
+    { "ticks",         parse_ticks },
+    { "settime flags", parse_settime_flags },
+    { "it_value",      parse_it_value },
+    { "it_interval",   parse_it_interval },
+    { "sigmask",       parse_sigmask },
+    { "Pid",           parse_pid },
+};
+// clang-format on
+
+} // namespace parsers
+} // namespace impl
+} // namespace pfs
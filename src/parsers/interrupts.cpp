@@ -0,0 +1,192 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "pfs/parser_error.hpp"
+#include "pfs/parsers/interrupts.hpp"
+#include "pfs/utils.hpp"
+
+namespace pfs {
+namespace impl {
+namespace parsers {
+
+namespace {
+
+// Overwrite a string, or add it if the vector is too short
+void set_string(std::vector<std::string>& items, size_t index,
+                const char* begin, const char* end)
+{
+    if (index < items.size())
+    {
+        items[index].assign(begin, end);
+    }
+    else
+    {
+        items.emplace_back(begin, end);
+    }
+}
+
+// Parse the 'CPU0 CPU1 ...' header into the ids of the columns
+void parse_header(const std::string& line, std::vector<int>& cpus)
+{
+    static const char CPU_PREFIX[]      = "CPU";
+    static const size_t CPU_PREFIX_LEN = sizeof(CPU_PREFIX) - 1;
+
+    const char* begin = line.data();
+    const char* end   = begin + line.size();
+
+    size_t columns = 0;
+    while ((begin = utils::skip_spaces(begin, end)) != end)
+    {
+        const char* token_end = utils::find_space(begin, end);
+        if (static_cast<size_t>(token_end - begin) <= CPU_PREFIX_LEN ||
+            memcmp(begin, CPU_PREFIX, CPU_PREFIX_LEN) != 0)
+        {
+            throw parser_error("Corrupted IRQ matrix - Invalid column", line);
+        }
+
+        int id;
+        try
+        {
+            utils::parse_whole_number(begin + CPU_PREFIX_LEN, token_end, id);
+        }
+        catch (const std::exception&)
+        {
+            throw parser_error("Corrupted IRQ matrix - Invalid column", line);
+        }
+
+        if (columns < cpus.size())
+        {
+            cpus[columns] = id;
+        }
+        else
+        {
+            cpus.push_back(id);
+        }
+        ++columns;
+
+        begin = token_end;
+    }
+
+    if (columns == 0)
+    {
+        throw parser_error("Corrupted IRQ matrix - Missing columns", line);
+    }
+    cpus.resize(columns);
+}
+
+} // anonymous namespace
+
+void parse_irq_matrix(const std::string& path, irq_matrix& out)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        throw parser_error("Couldn't open file", path);
+    }
+
+    std::string line;
+    if (!std::getline(in, line))
+    {
+        throw parser_error("Corrupted IRQ matrix - Missing header", path);
+    }
+    parse_header(line, out.cpus);
+
+    size_t columns = out.cpus.size();
+    size_t rows    = 0;
+
+    while (std::getline(in, line))
+    {
+        const char* begin = line.data();
+        const char* end   = begin + line.size();
+
+        begin = utils::skip_spaces(begin, end);
+        if (begin == end)
+        {
+            continue;
+        }
+
+        // The label, such as '24:' or 'NET_RX:'
+        const char* label_end = utils::find_space(begin, end);
+        if (label_end - begin < 2 || *(label_end - 1) != ':')
+        {
+            throw parser_error("Corrupted IRQ matrix - Invalid label", line);
+        }
+        set_string(out.names, rows, begin, label_end - 1);
+
+        out.counts.resize((rows + 1) * columns);
+        uint64_t* counts = &out.counts[rows * columns];
+
+        // Rows can have fewer counters than columns (e.g. 'ERR'), followed
+        // by a description that doesn't start with a digit
+        size_t column = 0;
+        begin         = label_end;
+        while (column < columns)
+        {
+            begin = utils::skip_spaces(begin, end);
+            if (begin == end || !isdigit(static_cast<unsigned char>(*begin)))
+            {
+                break;
+            }
+
+            const char* token_end = utils::find_space(begin, end);
+            try
+            {
+                utils::parse_whole_number(begin, token_end, counts[column]);
+            }
+            catch (const std::exception&)
+            {
+                throw parser_error("Corrupted IRQ matrix - Invalid count",
+                                   line);
+            }
+
+            ++column;
+            begin = token_end;
+        }
+
+        if (column == 0)
+        {
+            throw parser_error("Corrupted IRQ matrix - Missing counts", line);
+        }
+
+        for (; column < columns; ++column)
+        {
+            counts[column] = 0;
+        }
+
+        begin = utils::skip_spaces(begin, end);
+        while (end != begin && isspace(static_cast<unsigned char>(*(end - 1))))
+        {
+            --end;
+        }
+        set_string(out.descriptions, rows, begin, end);
+
+        ++rows;
+    }
+
+    out.names.resize(rows);
+    out.descriptions.resize(rows);
+    out.counts.resize(rows * columns);
+}
+
+} // namespace parsers
+} // namespace impl
+} // namespace pfs
@@ -14,8 +14,10 @@
  *  limitations under the License.
  */
 
+
+#include <linux/kdev_t.h>
+
 #include "pfs/parsers/maps.hpp"
-#include "pfs/parsers/common.hpp"
 #include "pfs/parser_error.hpp"
 #include "pfs/utils.hpp"
 
@@ -25,47 +27,16 @@ namespace parsers {
 
 namespace {
 
-std::pair<size_t, size_t>
-parse_mem_region_address(const std::string& address_str)
+const char* expect(const char* curr, const char* end, char c)
 {
-    // Address must be a range '<start>-<end>'
-    enum address_token
-    {
-        START = 0,
-        END   = 1,
-        COUNT
-    };
-
-    static const char DELIM = '-';
-
-    auto tokens = utils::split(address_str, DELIM);
-    if (tokens.size() != COUNT)
-    {
-        throw parser_error("Corrupted address - Unexpected tokens count",
-                           address_str);
-    }
-
-    try
-    {
-        size_t start;
-        utils::stot(tokens[START], start, utils::base::hex);
-
-        size_t end;
-        utils::stot(tokens[END], end, utils::base::hex);
-
-        return std::make_pair(start, end);
-    }
-    catch (const std::invalid_argument& ex)
+    if (curr == end || *curr != c)
     {
-        throw parser_error("Corrupted address - Invalid argument", address_str);
-    }
-    catch (const std::out_of_range& ex)
-    {
-        throw parser_error("Corrupted address - Out of range", address_str);
+        throw std::invalid_argument("Unexpected delimiter");
     }
+    return curr + 1;
 }
 
-mem_perm parse_mem_region_permissions(const std::string& perm_str)
+mem_perm parse_mem_region_permissions(const char* perm_str)
 {
     enum bit
     {
@@ -82,11 +53,6 @@ mem_perm parse_mem_region_permissions(const std::string& perm_str)
     static const char CHAR_PRIVATE = 'p';
     static const char CHAR_SHARED  = 's';
 
-    if (perm_str.size() != BIT_COUNT)
-    {
-        throw parser_error("Corrupted permissions", perm_str);
-    }
-
     mem_perm perm;
     perm.can_read    = (perm_str[BIT_READ] == CHAR_READ);
     perm.can_write   = (perm_str[BIT_WRITE] == CHAR_WRITE);
@@ -96,40 +62,76 @@ mem_perm parse_mem_region_permissions(const std::string& perm_str)
     return perm;
 }
 
-size_t parse_mem_region_offset(const std::string& offset_str)
+// Parse all the fixed fields into the region, and return the pathname.
+// Works in-place, so no allocations are made, and the pathname is
+// taken as-is, even if it contains whitespaces.
+template <typename Region>
+std::pair<const char*, size_t> parse_maps_fields(const std::string& line,
+                                                 Region& region)
 {
+    // Format:
+    // <start>-<end> <perms> <offset> <dev-major>:<dev-minor> <inode> [pathname]
+
+    static const size_t PERMISSIONS_LEN = 4;
+
+    const char* curr = line.data();
+    const char* end  = line.data() + line.size();
+
     try
     {
-        size_t offset;
-        utils::stot(offset_str, offset, utils::base::hex);
-        return offset;
+        curr = utils::parse_number(curr, end, region.start_address,
+                                   utils::base::hex);
+        curr = expect(curr, end, '-');
+        curr = utils::parse_number(curr, end, region.end_address,
+                                   utils::base::hex);
+        curr = expect(curr, end, ' ');
+
+        if (static_cast<size_t>(end - curr) <= PERMISSIONS_LEN ||
+            curr[PERMISSIONS_LEN] != ' ')
+        {
+            throw parser_error("Corrupted maps line - Bad permissions", line);
+        }
+        region.perm = parse_mem_region_permissions(curr);
+        curr += PERMISSIONS_LEN + 1;
+
+        curr = utils::parse_number(curr, end, region.offset, utils::base::hex);
+        curr = expect(curr, end, ' ');
+
+        unsigned major;
+        curr = utils::parse_number(curr, end, major, utils::base::hex);
+        curr = expect(curr, end, ':');
+
+        unsigned minor;
+        curr = utils::parse_number(curr, end, minor, utils::base::hex);
+        curr = expect(curr, end, ' ');
+
+        region.device = MKDEV(major, minor);
+
+        curr = utils::parse_number(curr, end, region.inode);
     }
     catch (const std::invalid_argument& ex)
     {
-        throw parser_error("Corrupted offset - Invalid argument", offset_str);
+        throw parser_error("Corrupted maps line - Invalid argument", line);
     }
     catch (const std::out_of_range& ex)
     {
-        throw parser_error("Corrupted offset - Out of range", offset_str);
+        throw parser_error("Corrupted maps line - Out of range", line);
     }
-}
 
-ino_t parse_mem_region_inode(const std::string& inode_str)
-{
-    try
-    {
-        ino_t inode;
-        utils::stot(inode_str, inode);
-        return inode;
-    }
-    catch (const std::invalid_argument& ex)
+    if (curr != end && *curr != ' ')
     {
-        throw parser_error("Corrupted inode - Invalid argument", inode_str);
+        throw parser_error("Corrupted maps line - Invalid inode", line);
     }
-    catch (const std::out_of_range& ex)
+
+    // The pathname is padded from the left, and is taken as-is from there,
+    // including any whitespaces it might contain.
+    const char* pathname = utils::skip_spaces(curr, end);
+    while (end != pathname && end[-1] == ' ')
     {
-        throw parser_error("Corrupted inode - Out of range", inode_str);
+        --end;
     }
+
+    return std::make_pair(pathname, static_cast<size_t>(end - pathname));
 }
 
 } // anonymous namespace
@@ -153,47 +155,21 @@ mem_region parse_maps_line(const std::string& line)
     // ffffffffff600000-ffffffffff601000 r-xp 00000000 00:00 0                  [vsyscall]
     // clang-format on
 
-    enum token
-    {
-        ADDRESS     = 0,
-        PERMISSIONS = 1,
-        OFFSET      = 2,
-        DEVICE      = 3,
-        INODE       = 4,
-        MIN_COUNT   = 5, // PATHNAME is not always present
-        PATHNAME    = 5,
-        COUNT
-    };
-
-    auto tokens = utils::split(line);
-    if (tokens.size() < MIN_COUNT)
-    {
-        throw parser_error("Corrupted maps line - Unexpected tokens count",
-                           line);
-    }
-
     mem_region region;
 
-    std::tie(region.start_address, region.end_address) =
-        parse_mem_region_address(tokens[ADDRESS]);
-
-    region.perm = parse_mem_region_permissions(tokens[PERMISSIONS]);
-
-    region.offset = parse_mem_region_offset(tokens[OFFSET]);
-
-    region.device = parse_device(tokens[DEVICE], utils::base::hex);
+    auto pathname = parse_maps_fields(line, region);
+    region.pathname.assign(pathname.first, pathname.second);
 
-    region.inode = parse_mem_region_inode(tokens[INODE]);
+    return region;
+}
 
-    for (size_t i = PATHNAME; i < tokens.size(); ++i)
-    {
-        if (!region.pathname.empty())
-        {
-            region.pathname += " ";
-        }
+compact_mem_region parse_compact_maps_line(const std::string& line,
+                                           string_pool& pool)
+{
+    compact_mem_region region;
 
-        region.pathname += tokens[i];
-    }
+    auto pathname      = parse_maps_fields(line, region);
+    region.pathname_id = pool.intern(pathname.first, pathname.second);
 
     return region;
 }
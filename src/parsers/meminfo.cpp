@@ -14,6 +14,15 @@
  *  limitations under the License.
  */
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#include "pfs/defer.hpp"
 #include "pfs/parsers/meminfo.hpp"
 #include "pfs/parser_error.hpp"
 #include "pfs/utils.hpp"
@@ -22,6 +31,156 @@ namespace pfs {
 namespace impl {
 namespace parsers {
 
+namespace {
+
+struct meminfo_field
+{
+    const char* key;
+    uint64_t meminfo::*member;
+};
+
+// In the order printed by the kernel
+// clang-format off
+static const meminfo_field FIELDS[] = {
+    { "MemTotal",          &meminfo::mem_total },
+    { "MemFree",           &meminfo::mem_free },
+    { "MemAvailable",      &meminfo::mem_available },
+    { "Buffers",           &meminfo::buffers },
+    { "Cached",            &meminfo::cached },
+    { "SwapCached",        &meminfo::swap_cached },
+    { "Active",            &meminfo::active },
+    { "Inactive",          &meminfo::inactive },
+    { "Active(anon)",      &meminfo::active_anon },
+    { "Inactive(anon)",    &meminfo::inactive_anon },
+    { "Active(file)",      &meminfo::active_file },
+    { "Inactive(file)",    &meminfo::inactive_file },
+    { "Unevictable",       &meminfo::unevictable },
+    { "Mlocked",           &meminfo::mlocked },
+    { "SwapTotal",         &meminfo::swap_total },
+    { "SwapFree",          &meminfo::swap_free },
+    { "Zswap",             &meminfo::zswap },
+    { "Zswapped",          &meminfo::zswapped },
+    { "Dirty",             &meminfo::dirty },
+    { "Writeback",         &meminfo::writeback },
+    { "AnonPages",         &meminfo::anon_pages },
+    { "Mapped",            &meminfo::mapped },
+    { "Shmem",             &meminfo::shmem },
+    { "KReclaimable",      &meminfo::kreclaimable },
+    { "Slab",              &meminfo::slab },
+    { "SReclaimable",      &meminfo::sreclaimable },
+    { "SUnreclaim",        &meminfo::sunreclaim },
+    { "KernelStack",       &meminfo::kernel_stack },
+    { "PageTables",        &meminfo::page_tables },
+    { "SecPageTables",     &meminfo::sec_page_tables },
+    { "NFS_Unstable",      &meminfo::nfs_unstable },
+    { "Bounce",            &meminfo::bounce },
+    { "WritebackTmp",      &meminfo::writeback_tmp },
+    { "CommitLimit",       &meminfo::commit_limit },
+    { "Committed_AS",      &meminfo::committed_as },
+    { "VmallocTotal",      &meminfo::vmalloc_total },
+    { "VmallocUsed",       &meminfo::vmalloc_used },
+    { "VmallocChunk",      &meminfo::vmalloc_chunk },
+    { "Percpu",            &meminfo::percpu },
+    { "HardwareCorrupted", &meminfo::hardware_corrupted },
+    { "AnonHugePages",     &meminfo::anon_huge_pages },
+    { "ShmemHugePages",    &meminfo::shmem_huge_pages },
+    { "ShmemPmdMapped",    &meminfo::shmem_pmd_mapped },
+    { "FileHugePages",     &meminfo::file_huge_pages },
+    { "FilePmdMapped",     &meminfo::file_pmd_mapped },
+    { "CmaTotal",          &meminfo::cma_total },
+    { "CmaFree",           &meminfo::cma_free },
+    { "HugePages_Total",   &meminfo::huge_pages_total },
+    { "HugePages_Free",    &meminfo::huge_pages_free },
+    { "HugePages_Rsvd",    &meminfo::huge_pages_rsvd },
+    { "HugePages_Surp",    &meminfo::huge_pages_surp },
+    { "Hugepagesize",      &meminfo::hugepagesize },
+    { "Hugetlb",           &meminfo::hugetlb },
+    { "DirectMap4k",       &meminfo::direct_map_4k },
+    { "DirectMap2M",       &meminfo::direct_map_2m },
+    { "DirectMap1G",       &meminfo::direct_map_1g },
+};
+// clang-format on
+
+static const size_t FIELDS_COUNT = sizeof(FIELDS) / sizeof(FIELDS[0]);
+
+// The file is a few KBs, and lines are much shorter than that
+static const size_t BUFFER_SIZE = 4 * 1024;
+
+// Look for the key, starting at the field that follows the previous one
+const meminfo_field* find_field(const char* begin, const char* end,
+                                size_t& hint)
+{
+    for (size_t i = 0; i < FIELDS_COUNT; ++i)
+    {
+        size_t index = (hint + i) % FIELDS_COUNT;
+        if (utils::equals(begin, end, FIELDS[index].key))
+        {
+            hint = index + 1;
+            return &FIELDS[index];
+        }
+    }
+    return nullptr;
+}
+
+// Parse a line such as 'MemTotal:  6147400 kB'
+void parse_line(const char* begin, const char* end, meminfo& out,
+                size_t& others, size_t& hint)
+{
+    const char* key_end = static_cast<const char*>(
+        memchr(begin, ':', static_cast<size_t>(end - begin)));
+    if (!key_end || key_end == begin)
+    {
+        throw parser_error("Corrupted meminfo - Missing key",
+                           std::string(begin, end));
+    }
+
+    uint64_t value;
+    try
+    {
+        const char* value_begin = utils::skip_spaces(key_end + 1, end);
+        const char* value_end   = utils::parse_number(value_begin, end, value);
+
+        // Followed by the unit, if any
+        const char* unit = utils::skip_spaces(value_end, end);
+        if ((value_end != end && !isspace(static_cast<unsigned char>(*value_end))) ||
+            (unit != end && !utils::equals(unit, end, "kB")))
+        {
+            throw std::invalid_argument("Invalid unit");
+        }
+    }
+    catch (const std::invalid_argument&)
+    {
+        throw parser_error("Corrupted meminfo - Invalid argument",
+                           std::string(begin, end));
+    }
+    catch (const std::out_of_range&)
+    {
+        throw parser_error("Corrupted meminfo - Out of range",
+                           std::string(begin, end));
+    }
+
+    auto field = find_field(begin, key_end, hint);
+    if (field)
+    {
+        out.*(field->member) = value;
+        return;
+    }
+
+    // Slots of the previous parse are reused
+    if (others < out.other.size())
+    {
+        out.other[others].first.assign(begin, key_end);
+        out.other[others].second = value;
+    }
+    else
+    {
+        out.other.emplace_back(std::string(begin, key_end), value);
+    }
+    ++others;
+}
+
+} // anonymous namespace
+
 std::pair<std::string, size_t> parse_meminfo_line(const std::string& line)
 {
     // Some examples:
@@ -79,6 +238,79 @@ std::pair<std::string, size_t> parse_meminfo_line(const std::string& line)
     }
 }
 
+void parse_meminfo(const std::string& path, meminfo& out)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw parser_error("Couldn't open file", path);
+    }
+    defer close_fd([fd] { close(fd); });
+
+    for (const auto& field : FIELDS)
+    {
+        out.*(field.member) = 0;
+    }
+
+    size_t others = 0;
+    size_t hint   = 0;
+
+    char buffer[BUFFER_SIZE];
+    size_t size = 0; // Of the partial line at the beginning of the buffer
+    while (true)
+    {
+        ssize_t bytes = read(fd, buffer + size, sizeof(buffer) - size);
+        if (bytes < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw std::system_error(errno, std::system_category(),
+                                    "Couldn't read meminfo");
+        }
+
+        size += static_cast<size_t>(bytes);
+        bool eof = (bytes == 0);
+
+        const char* begin = buffer;
+        const char* end   = buffer + size;
+        while (begin != end)
+        {
+            const char* line_end = static_cast<const char*>(
+                memchr(begin, '\n', static_cast<size_t>(end - begin)));
+            if (!line_end)
+            {
+                if (!eof)
+                {
+                    break; // Completed by the next read
+                }
+                line_end = end;
+            }
+
+            if (line_end != begin)
+            {
+                parse_line(begin, line_end, out, others, hint);
+            }
+            begin = (line_end == end) ? end : line_end + 1;
+        }
+
+        if (eof)
+        {
+            break;
+        }
+
+        size = static_cast<size_t>(end - begin);
+        if (size == sizeof(buffer))
+        {
+            throw parser_error("Corrupted meminfo - Line too long", path);
+        }
+        memmove(buffer, begin, size);
+    }
+
+    out.other.resize(others);
+}
+
 } // namespace parsers
 } // namespace impl
 } // namespace pfs
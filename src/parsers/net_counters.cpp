@@ -0,0 +1,357 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "pfs/parsers/net_counters.hpp"
+#include "pfs/parser_error.hpp"
+#include "pfs/utils.hpp"
+
+namespace pfs {
+namespace impl {
+namespace parsers {
+
+namespace {
+
+template <typename T>
+struct counter_field
+{
+    const char* section;
+    const char* key;
+    uint64_t T::*member;
+};
+
+// Fields of the same section must be adjacent
+// clang-format off
+static const counter_field<net_snmp> SNMP_FIELDS[] = {
+    { "Ip",   "InReceives",      &net_snmp::ip_in_receives },
+    { "Ip",   "InHdrErrors",     &net_snmp::ip_in_hdr_errors },
+    { "Ip",   "InAddrErrors",    &net_snmp::ip_in_addr_errors },
+    { "Ip",   "ForwDatagrams",   &net_snmp::ip_forw_datagrams },
+    { "Ip",   "InUnknownProtos", &net_snmp::ip_in_unknown_protos },
+    { "Ip",   "InDiscards",      &net_snmp::ip_in_discards },
+    { "Ip",   "InDelivers",      &net_snmp::ip_in_delivers },
+    { "Ip",   "OutRequests",     &net_snmp::ip_out_requests },
+    { "Ip",   "OutDiscards",     &net_snmp::ip_out_discards },
+    { "Ip",   "OutNoRoutes",     &net_snmp::ip_out_no_routes },
+    { "Ip",   "ReasmFails",      &net_snmp::ip_reasm_fails },
+    { "Ip",   "FragFails",       &net_snmp::ip_frag_fails },
+    { "Icmp", "InMsgs",          &net_snmp::icmp_in_msgs },
+    { "Icmp", "InErrors",        &net_snmp::icmp_in_errors },
+    { "Icmp", "InCsumErrors",    &net_snmp::icmp_in_csum_errors },
+    { "Icmp", "InDestUnreachs",  &net_snmp::icmp_in_dest_unreachs },
+    { "Icmp", "OutMsgs",         &net_snmp::icmp_out_msgs },
+    { "Icmp", "OutErrors",       &net_snmp::icmp_out_errors },
+    { "Icmp", "OutDestUnreachs", &net_snmp::icmp_out_dest_unreachs },
+    { "Tcp",  "ActiveOpens",     &net_snmp::tcp_active_opens },
+    { "Tcp",  "PassiveOpens",    &net_snmp::tcp_passive_opens },
+    { "Tcp",  "AttemptFails",    &net_snmp::tcp_attempt_fails },
+    { "Tcp",  "EstabResets",     &net_snmp::tcp_estab_resets },
+    { "Tcp",  "CurrEstab",       &net_snmp::tcp_curr_estab },
+    { "Tcp",  "InSegs",          &net_snmp::tcp_in_segs },
+    { "Tcp",  "OutSegs",         &net_snmp::tcp_out_segs },
+    { "Tcp",  "RetransSegs",     &net_snmp::tcp_retrans_segs },
+    { "Tcp",  "InErrs",          &net_snmp::tcp_in_errs },
+    { "Tcp",  "OutRsts",         &net_snmp::tcp_out_rsts },
+    { "Tcp",  "InCsumErrors",    &net_snmp::tcp_in_csum_errors },
+    { "Udp",  "InDatagrams",     &net_snmp::udp_in_datagrams },
+    { "Udp",  "NoPorts",         &net_snmp::udp_no_ports },
+    { "Udp",  "InErrors",        &net_snmp::udp_in_errors },
+    { "Udp",  "OutDatagrams",    &net_snmp::udp_out_datagrams },
+    { "Udp",  "RcvbufErrors",    &net_snmp::udp_rcvbuf_errors },
+    { "Udp",  "SndbufErrors",    &net_snmp::udp_sndbuf_errors },
+    { "Udp",  "InCsumErrors",    &net_snmp::udp_in_csum_errors },
+};
+
+static const counter_field<net_netstat> NETSTAT_FIELDS[] = {
+    { "TcpExt", "SyncookiesSent",       &net_netstat::syncookies_sent },
+    { "TcpExt", "SyncookiesRecv",       &net_netstat::syncookies_recv },
+    { "TcpExt", "SyncookiesFailed",     &net_netstat::syncookies_failed },
+    { "TcpExt", "EmbryonicRsts",        &net_netstat::embryonic_rsts },
+    { "TcpExt", "PruneCalled",          &net_netstat::prune_called },
+    { "TcpExt", "RcvPruned",            &net_netstat::rcv_pruned },
+    { "TcpExt", "OfoPruned",            &net_netstat::ofo_pruned },
+    { "TcpExt", "TW",                   &net_netstat::tw },
+    { "TcpExt", "TWRecycled",           &net_netstat::tw_recycled },
+    { "TcpExt", "TWKilled",             &net_netstat::tw_killed },
+    { "TcpExt", "DelayedACKs",          &net_netstat::delayed_acks },
+    { "TcpExt", "ListenOverflows",      &net_netstat::listen_overflows },
+    { "TcpExt", "ListenDrops",          &net_netstat::listen_drops },
+    { "TcpExt", "TCPLostRetransmit",    &net_netstat::tcp_lost_retransmit },
+    { "TcpExt", "TCPFastRetrans",       &net_netstat::tcp_fast_retrans },
+    { "TcpExt", "TCPSlowStartRetrans",  &net_netstat::tcp_slow_start_retrans },
+    { "TcpExt", "TCPTimeouts",          &net_netstat::tcp_timeouts },
+    { "TcpExt", "TCPMemoryPressures",   &net_netstat::tcp_memory_pressures },
+    { "TcpExt", "TCPAbortOnData",       &net_netstat::tcp_abort_on_data },
+    { "TcpExt", "TCPAbortOnClose",      &net_netstat::tcp_abort_on_close },
+    { "TcpExt", "TCPAbortOnMemory",     &net_netstat::tcp_abort_on_memory },
+    { "TcpExt", "TCPAbortOnTimeout",    &net_netstat::tcp_abort_on_timeout },
+    { "TcpExt", "TCPBacklogDrop",       &net_netstat::tcp_backlog_drop },
+    { "TcpExt", "TCPRcvQDrop",          &net_netstat::tcp_rcvq_drop },
+    { "TcpExt", "TCPZeroWindowDrop",    &net_netstat::tcp_zero_window_drop },
+    { "TcpExt", "TCPReqQFullDrop",      &net_netstat::tcp_reqq_full_drop },
+    { "TcpExt", "TCPReqQFullDoCookies", &net_netstat::tcp_reqq_full_do_cookies },
+    { "IpExt",  "InNoRoutes",           &net_netstat::ip_in_no_routes },
+    { "IpExt",  "InTruncatedPkts",      &net_netstat::ip_in_truncated_pkts },
+    { "IpExt",  "InMcastPkts",          &net_netstat::ip_in_mcast_pkts },
+    { "IpExt",  "OutMcastPkts",         &net_netstat::ip_out_mcast_pkts },
+    { "IpExt",  "InBcastPkts",          &net_netstat::ip_in_bcast_pkts },
+    { "IpExt",  "OutBcastPkts",         &net_netstat::ip_out_bcast_pkts },
+    { "IpExt",  "InOctets",             &net_netstat::ip_in_octets },
+    { "IpExt",  "OutOctets",            &net_netstat::ip_out_octets },
+    { "IpExt",  "InCsumErrors",         &net_netstat::ip_in_csum_errors },
+};
+
+static const counter_field<net_sockstat> SOCKSTAT_FIELDS[] = {
+    { "sockets",  "used",   &net_sockstat::sockets_used },
+    { "TCP",      "inuse",  &net_sockstat::tcp_inuse },
+    { "TCP",      "orphan", &net_sockstat::tcp_orphan },
+    { "TCP",      "tw",     &net_sockstat::tcp_tw },
+    { "TCP",      "alloc",  &net_sockstat::tcp_alloc },
+    { "TCP",      "mem",    &net_sockstat::tcp_mem },
+    { "UDP",      "inuse",  &net_sockstat::udp_inuse },
+    { "UDP",      "mem",    &net_sockstat::udp_mem },
+    { "UDPLITE",  "inuse",  &net_sockstat::udplite_inuse },
+    { "RAW",      "inuse",  &net_sockstat::raw_inuse },
+    { "FRAG",     "inuse",  &net_sockstat::frag_inuse },
+    { "FRAG",     "memory", &net_sockstat::frag_memory },
+    { "TCP6",     "inuse",  &net_sockstat::tcp_inuse },
+    { "UDP6",     "inuse",  &net_sockstat::udp_inuse },
+    { "UDPLITE6", "inuse",  &net_sockstat::udplite_inuse },
+    { "RAW6",     "inuse",  &net_sockstat::raw_inuse },
+    { "FRAG6",    "inuse",  &net_sockstat::frag_inuse },
+    { "FRAG6",    "memory", &net_sockstat::frag_memory },
+};
+// clang-format on
+
+// The fields of a section, as a [first, last) range
+template <typename T, size_t N>
+std::pair<const counter_field<T>*, const counter_field<T>*>
+find_section(const counter_field<T> (&fields)[N], const char* begin,
+             const char* end)
+{
+    const counter_field<T>* first = fields;
+    while (first != fields + N && !utils::equals(begin, end, first->section))
+    {
+        ++first;
+    }
+
+    const counter_field<T>* last = first;
+    while (last != fields + N && utils::equals(begin, end, last->section))
+    {
+        ++last;
+    }
+
+    return std::make_pair(first, last);
+}
+
+template <typename T>
+const counter_field<T>* find_key(const counter_field<T>* first,
+                                 const counter_field<T>* last,
+                                 const char* begin, const char* end)
+{
+    for (; first != last; ++first)
+    {
+        if (utils::equals(begin, end, first->key))
+        {
+            return first;
+        }
+    }
+    return nullptr;
+}
+
+// Split the "<section>:" prefix of a line. Returns a pointer past it.
+const char* parse_section(const std::string& line, const char*& section_end)
+{
+    static const char DELIM = ':';
+
+    const char* begin = line.c_str();
+    const char* end   = begin + line.size();
+
+    section_end = std::find(begin, end, DELIM);
+    if (section_end == end)
+    {
+        throw parser_error("Corrupted counters - Missing section", line);
+    }
+
+    return section_end + 1;
+}
+
+// Parse a whole token as an unsigned counter. Returns a pointer past it.
+const char* parse_counter(const char* begin, const char* end, uint64_t& out)
+{
+    const char* token_end = utils::find_space(begin, end);
+    utils::parse_whole_number(begin, token_end, out);
+    return token_end;
+}
+
+template <typename T, size_t N>
+void parse_paired_lines(std::istream& in, const counter_field<T> (&fields)[N],
+                        T& out)
+{
+    std::string header;
+    std::string values;
+    while (std::getline(in, header))
+    {
+        if (header.empty())
+        {
+            continue;
+        }
+
+        if (!std::getline(in, values))
+        {
+            throw parser_error("Corrupted counters - Missing values", header);
+        }
+
+        const char* section_end;
+        const char* key = parse_section(header, section_end);
+
+        const char* values_section_end;
+        const char* value = parse_section(values, values_section_end);
+
+        const char* header_begin = header.c_str();
+        const char* values_begin = values.c_str();
+        if ((section_end - header_begin) !=
+                (values_section_end - values_begin) ||
+            !std::equal(header_begin, section_end, values_begin))
+        {
+            throw parser_error("Corrupted counters - Mismatching sections",
+                               values);
+        }
+
+        auto range = find_section(fields, header_begin, section_end);
+        if (range.first == range.second)
+        {
+            continue; // Unsupported section, ignore
+        }
+
+        const char* keys_end   = header_begin + header.size();
+        const char* values_end = values_begin + values.size();
+
+        try
+        {
+            for (key = utils::skip_spaces(key, keys_end); key != keys_end;
+                 key = utils::skip_spaces(key, keys_end))
+            {
+                value = utils::skip_spaces(value, values_end);
+                if (value == values_end)
+                {
+                    throw parser_error(
+                        "Corrupted counters - Not enough values", values);
+                }
+
+                const char* key_end = utils::find_space(key, keys_end);
+                auto field = find_key(range.first, range.second, key, key_end);
+                if (field)
+                {
+                    value = parse_counter(value, values_end, out.*field->member);
+                }
+                else
+                {
+                    // Unsupported counter, which may be negative (MaxConn)
+                    value = utils::find_space(value, values_end);
+                }
+
+                key = key_end;
+            }
+        }
+        catch (const std::invalid_argument&)
+        {
+            throw parser_error("Corrupted counters - Invalid argument", values);
+        }
+        catch (const std::out_of_range&)
+        {
+            throw parser_error("Corrupted counters - Out of range", values);
+        }
+    }
+}
+
+template <typename T, size_t N>
+void parse_inline_pairs(std::istream& in, const counter_field<T> (&fields)[N],
+                        T& out)
+{
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (line.empty())
+        {
+            continue;
+        }
+
+        const char* section_end;
+        const char* curr = parse_section(line, section_end);
+        const char* end  = line.c_str() + line.size();
+
+        auto range = find_section(fields, line.c_str(), section_end);
+
+        try
+        {
+            for (curr = utils::skip_spaces(curr, end); curr != end;
+                 curr = utils::skip_spaces(curr, end))
+            {
+                const char* key_end = utils::find_space(curr, end);
+                const char* value   = utils::skip_spaces(key_end, end);
+                if (value == end)
+                {
+                    throw parser_error("Corrupted counters - Missing value",
+                                       line);
+                }
+
+                auto field = find_key(range.first, range.second, curr, key_end);
+                if (field)
+                {
+                    curr = parse_counter(value, end, out.*field->member);
+                }
+                else
+                {
+                    curr = utils::find_space(value, end);
+                }
+            }
+        }
+        catch (const std::invalid_argument&)
+        {
+            throw parser_error("Corrupted counters - Invalid argument", line);
+        }
+        catch (const std::out_of_range&)
+        {
+            throw parser_error("Corrupted counters - Out of range", line);
+        }
+    }
+}
+
+} // anonymous namespace
+
+void parse_snmp(std::istream& in, net_snmp& out)
+{
+    parse_paired_lines(in, SNMP_FIELDS, out);
+}
+
+void parse_netstat(std::istream& in, net_netstat& out)
+{
+    parse_paired_lines(in, NETSTAT_FIELDS, out);
+}
+
+void parse_sockstat(std::istream& in, net_sockstat& out)
+{
+    parse_inline_pairs(in, SOCKSTAT_FIELDS, out);
+}
+
+} // namespace parsers
+} // namespace impl
+} // namespace pfs
@@ -19,6 +19,8 @@
 #include "pfs/utils.hpp"
 #include "pfs/types.hpp"
 
+#include <arpa/inet.h>
+
 #include <set>
 #include <sstream>
 
@@ -89,6 +91,89 @@ net_route parse_net_route_line(const std::string& line)
     return route;
 }
 
+namespace {
+
+// Unlike the other net files, addresses are printed in network byte order
+ip parse_network_order_ipv6_address(const std::string& str)
+{
+    static const size_t LENGTH = 32;
+
+    if (str.size() != LENGTH)
+    {
+        throw std::invalid_argument("IPv6 address has a bad length");
+    }
+
+    ipv6 raw = utils::parse_ipv6_address(str).storage;
+    for (auto& word : raw)
+    {
+        word = htonl(word);
+    }
+    return ip(raw);
+}
+
+} // anonymous namespace
+
+net_ipv6_route parse_net_ipv6_route_line(const std::string& line)
+{
+    // Some examples:
+    // clang-format off
+    // fe800000000000000000000000000000 40 00000000000000000000000000000000 00 00000000000000000000000000000000 00000100 00000002 00000000 00000001     eth0
+    // 00000000000000000000000000000000 00 00000000000000000000000000000000 00 fd000000000000000000000000000001 00000400 00000001 00000000 00000003     eth0
+    // clang-format on
+
+    enum token
+    {
+        DESTINATION            = 0,
+        DESTINATION_PREFIX_LEN = 1,
+        SOURCE                 = 2,
+        SOURCE_PREFIX_LEN      = 3,
+        NEXT_HOP               = 4,
+        METRIC                 = 5,
+        REFCNT                 = 6,
+        USE                    = 7,
+        FLAGS                  = 8,
+        INTERFACE              = 9,
+        COUNT
+    };
+
+    net_ipv6_route route;
+
+    auto tokens = utils::split(line);
+    if (tokens.size() != COUNT)
+    {
+        throw parser_error("Corrupted net ipv6 route - Unexpected tokens count",
+                           line);
+    }
+
+    try
+    {
+        route.destination = parse_network_order_ipv6_address(tokens[DESTINATION]);
+        route.source      = parse_network_order_ipv6_address(tokens[SOURCE]);
+        route.next_hop    = parse_network_order_ipv6_address(tokens[NEXT_HOP]);
+
+        utils::stot(tokens[DESTINATION_PREFIX_LEN],
+                    route.destination_prefix_len, utils::base::hex);
+        utils::stot(tokens[SOURCE_PREFIX_LEN], route.source_prefix_len,
+                    utils::base::hex);
+        utils::stot(tokens[METRIC], route.metric, utils::base::hex);
+        utils::stot(tokens[REFCNT], route.refcnt, utils::base::hex);
+        utils::stot(tokens[USE], route.use, utils::base::hex);
+        utils::stot(tokens[FLAGS], route.flags, utils::base::hex);
+
+        route.iface = tokens[INTERFACE];
+    }
+    catch (const std::invalid_argument& ex)
+    {
+        throw parser_error("Corrupted net ipv6 route - Invalid argument", line);
+    }
+    catch (const std::out_of_range& ex)
+    {
+        throw parser_error("Corrupted net ipv6 route - Out of range", line);
+    }
+
+    return route;
+}
+
 } // namespace parsers
 } // namespace impl
 } // namespace pfs
@@ -14,7 +14,8 @@
  *  limitations under the License.
  */
 
-#include <arpa/inet.h>
+#include <algorithm>
+#include <cctype>
 
 #include "pfs/parsers/net_socket.hpp"
 #include "pfs/parser_error.hpp"
@@ -26,88 +27,113 @@ namespace parsers {
 
 namespace {
 
-net_socket::net_state parse_state(const std::string& state_str)
+// Skip to the next column. Throws if there is none.
+const char* next_column(const char* curr, const char* begin, const char* end)
 {
-    int state_int;
-    utils::stot(state_str, state_int, utils::base::hex);
-
-    auto state = static_cast<net_socket::net_state>(state_int);
-    if (state < net_socket::net_state::established ||
-        state > net_socket::net_state::closing)
+    curr = utils::skip_spaces(curr, end);
+    if (curr == end)
     {
-        throw parser_error("Corrupted net socket state - Illegal value",
-                           state_str);
+        throw parser_error("Corrupted net socket line - Not enough tokens",
+                           std::string(begin, end));
     }
-
-    return state;
+    return curr;
 }
 
-std::pair<size_t, size_t> parse_queues(const std::string& queues_str)
+// Make sure the column ends right after the value that was just parsed
+const char* end_column(const char* curr, const char* end)
 {
-    enum token
+    if (curr != end && !std::isspace(static_cast<unsigned char>(*curr)))
     {
-        TX = 0,
-        RX = 1,
-        COUNT
-    };
+        throw std::invalid_argument("Unexpected char in column");
+    }
+    return curr;
+}
 
+const char* skip_delim(const char* curr, const char* end)
+{
     static const char DELIM = ':';
 
-    auto tokens = utils::split(queues_str, DELIM);
-    if (tokens.size() != COUNT)
+    if (curr == end || *curr != DELIM)
     {
-        throw parser_error(
-            "Corrupted net socket queues - Unexpected token counts",
-            queues_str);
+        throw std::invalid_argument("Missing column delimiter");
     }
-
-    size_t tx_queue;
-    utils::stot(tokens[TX], tx_queue, utils::base::hex);
-
-    size_t rx_queue;
-    utils::stot(tokens[RX], rx_queue, utils::base::hex);
-
-    return std::make_pair(tx_queue, rx_queue);
+    return curr + 1;
 }
 
-std::pair<net_socket::timer, size_t> parse_timer(const std::string& timer_str)
+net_socket::net_state parse_state(unsigned state_int, const char* begin,
+                                  const char* end)
 {
-    enum token
-    {
-        ACTIVE = 0,
-        EXPIRE = 1,
-        COUNT
-    };
-
-    static const char DELIM = ':';
-
-    auto tokens = utils::split(timer_str, DELIM);
-    if (tokens.size() != COUNT)
+    auto state = static_cast<net_socket::net_state>(state_int);
+    if (state < net_socket::net_state::established ||
+        state > net_socket::net_state::closing)
     {
-        throw parser_error(
-            "Corrupted net socket timer - Unexpected token counts", timer_str);
+        throw parser_error("Corrupted net socket state - Illegal value",
+                           std::string(begin, end));
     }
+    return state;
+}
 
-    int timer_int;
-    utils::stot(tokens[ACTIVE], timer_int);
-
+net_socket::timer parse_timer(unsigned timer_int, const char* begin,
+                              const char* end)
+{
     auto timer = static_cast<net_socket::timer>(timer_int);
-    if (timer < net_socket::timer::none ||
-        timer > net_socket::timer::zero_window)
+    if (timer > net_socket::timer::zero_window)
     {
         throw parser_error("Corrupted net socket timer - Illegal value",
-                           timer_str);
+                           std::string(begin, end));
     }
+    return timer;
+}
 
-    size_t expire_jiffies;
-    utils::stot(tokens[EXPIRE], expire_jiffies, utils::base::hex);
+int parse_hex_digit(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
 
-    return std::make_pair(timer, expire_jiffies);
+// Parse exactly 'count' hex digits. Returns -1 if any of them is invalid.
+long parse_hex_digits(const char* begin, size_t count)
+{
+    long value = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        int digit = parse_hex_digit(begin[i]);
+        if (digit < 0)
+        {
+            return -1;
+        }
+        value = (value << 4) | digit;
+    }
+    return value;
+}
+
+// Skip to the column after the current one
+const char* skip_column(const char* curr, const char* end)
+{
+    return utils::skip_spaces(utils::find_space(curr, end), end);
 }
 
 } // anonymous namespace
 
 net_socket parse_net_socket_line(const std::string& line)
+{
+    net_socket sock;
+    parse_net_socket(line.data(), line.data() + line.size(), sock);
+    return sock;
+}
+
+void parse_net_socket(const char* begin, const char* end, net_socket& out)
 {
     // Some examples:
     // clang-format off
@@ -121,72 +147,211 @@ net_socket parse_net_socket_line(const std::string& line)
     // sl  local_address                         remote_address                        st tx_queue rx_queue tr tm->when retrnsmt   uid  timeout inode
     // 0: 00000000000000000000000000000000:006F 00000000000000000000000000000000:0000 0A 00000000:00000000 00:00000000 00000000     0        0 15737 1 ffff9f55bdb91980 100 0 0 10 0
     // 1: 00000000000000000000000000000000:0016 00000000000000000000000000000000:0000 0A 00000000:00000000 00:00000000 00000000     0        0 18668 1 ffff9f55bdb94c80 100 0 0 10 0
+    //
+    // The columns are parsed in place, following the kernel's format:
+    // "%4d: %08X:%04X %08X:%04X %02X %08X:%08X %02X:%08lX %08X %5u %8d %lu %d %pK"
     // clang-format on
+    // More columns are expected, but ignored.
 
-    enum token
-    {
-        SLOT           = 0,
-        LOCAL_ADDRESS  = 1,
-        REMOTE_ADDRESS = 2,
-        STATE          = 3,
-        QUEUES         = 4,
-        TIMER          = 5,
-        RETRANSMITS    = 6,
-        UID            = 7,
-        TIMEOUTS       = 8,
-        INODE          = 9,
-        REF_COUNT      = 10,
-        SKBUFF         = 11,
-        MIN_COUNT // More tokens are expected, but ignored
-    };
-
-    auto tokens = utils::split(line);
-    if (tokens.size() < MIN_COUNT)
-    {
-        throw parser_error("Corrupted net socket line - Not enough tokens",
-                           line);
-    }
+    using utils::base;
+    using utils::parse_number;
 
     try
     {
         net_socket sock;
+        const char* curr = begin;
+
+        curr = parse_number(next_column(curr, begin, end), end, sock.slot);
+        curr = end_column(skip_delim(curr, end), end);
 
-        utils::stot(tokens[SLOT], sock.slot, utils::base::hex);
+        curr = utils::parse_address(next_column(curr, begin, end), end,
+                                    sock.local_ip, sock.local_port);
+        curr = end_column(curr, end);
 
-        std::tie(sock.local_ip, sock.local_port) =
-            utils::parse_address(tokens[LOCAL_ADDRESS]);
-        std::tie(sock.remote_ip, sock.remote_port) =
-            utils::parse_address(tokens[REMOTE_ADDRESS]);
+        curr = utils::parse_address(next_column(curr, begin, end), end,
+                                    sock.remote_ip, sock.remote_port);
+        curr = end_column(curr, end);
 
-        sock.socket_net_state = parse_state(tokens[STATE]);
+        unsigned state;
+        curr = parse_number(next_column(curr, begin, end), end, state,
+                            base::hex);
+        sock.socket_net_state = parse_state(state, begin, end);
+        curr = end_column(curr, end);
 
-        std::tie(sock.tx_queue, sock.rx_queue) = parse_queues(tokens[QUEUES]);
+        curr = parse_number(next_column(curr, begin, end), end, sock.tx_queue,
+                            base::hex);
+        curr = parse_number(skip_delim(curr, end), end, sock.rx_queue,
+                            base::hex);
+        curr = end_column(curr, end);
 
-        std::tie(sock.timer_active, sock.timer_expire_jiffies) =
-            parse_timer(tokens[TIMER]);
+        unsigned timer;
+        curr = parse_number(next_column(curr, begin, end), end, timer,
+                            base::hex);
+        sock.timer_active = parse_timer(timer, begin, end);
+        curr = parse_number(skip_delim(curr, end), end,
+                            sock.timer_expire_jiffies, base::hex);
+        curr = end_column(curr, end);
 
-        utils::stot(tokens[RETRANSMITS], sock.retransmits);
+        curr = parse_number(next_column(curr, begin, end), end,
+                            sock.retransmits, base::hex);
+        curr = end_column(curr, end);
 
-        utils::stot(tokens[UID], sock.uid);
+        curr = parse_number(next_column(curr, begin, end), end, sock.uid);
+        curr = end_column(curr, end);
 
-        utils::stot(tokens[TIMEOUTS], sock.timeouts);
+        curr = parse_number(next_column(curr, begin, end), end, sock.timeouts);
+        curr = end_column(curr, end);
 
-        utils::stot(tokens[INODE], sock.inode);
+        curr = parse_number(next_column(curr, begin, end), end, sock.inode);
+        curr = end_column(curr, end);
 
-        utils::stot(tokens[REF_COUNT], sock.ref_count);
+        curr = parse_number(next_column(curr, begin, end), end, sock.ref_count);
+        curr = end_column(curr, end);
 
-        utils::stot(tokens[SKBUFF], sock.skbuff, utils::base::hex);
+        curr = parse_number(next_column(curr, begin, end), end, sock.skbuff,
+                            base::hex);
+        end_column(curr, end);
 
-        return sock;
+        out = sock;
     }
     catch (const std::invalid_argument& ex)
     {
-        throw parser_error("Corrupted net socket - Invalid argument", line);
+        throw parser_error("Corrupted net socket - Invalid argument",
+                           std::string(begin, end));
     }
     catch (const std::out_of_range& ex)
     {
-        throw parser_error("Corrupted net socket - Out of range", line);
+        throw parser_error("Corrupted net socket - Out of range",
+                           std::string(begin, end));
+    }
+}
+
+net_socket_prefilter::net_socket_prefilter(const net_socket_query& query)
+    : _states(0), _local_ports(make_port_set(query.local_ports)),
+      _remote_ports(make_port_set(query.remote_ports)), _uids(query.uids)
+{
+    for (auto state : query.states)
+    {
+        _states |= (1U << static_cast<unsigned>(state));
+    }
+}
+
+net_socket_prefilter::port_set
+net_socket_prefilter::make_port_set(const std::vector<uint16_t>& ports)
+{
+    static const size_t WORD_BITS = 64;
+    static const size_t WORDS     = (UINT16_MAX + 1) / WORD_BITS;
+
+    port_set set;
+    if (!ports.empty())
+    {
+        set.resize(WORDS, 0);
+        for (auto port : ports)
+        {
+            set[port / WORD_BITS] |= (1ULL << (port % WORD_BITS));
+        }
+    }
+    return set;
+}
+
+bool net_socket_prefilter::has_port(const port_set& ports,
+                                    const char* column_begin,
+                                    const char* column_end)
+{
+    // The address column ends with ":%04X"
+    static const size_t WORD_BITS = 64;
+    static const size_t PORT_LEN  = 4;
+    static const char DELIM       = ':';
+
+    if (static_cast<size_t>(column_end - column_begin) <= PORT_LEN ||
+        column_end[-static_cast<long>(PORT_LEN) - 1] != DELIM)
+    {
+        return true; // Corrupted
+    }
+
+    long port = parse_hex_digits(column_end - PORT_LEN, PORT_LEN);
+    if (port < 0)
+    {
+        return true; // Corrupted
+    }
+
+    return (ports[port / WORD_BITS] >> (port % WORD_BITS)) & 1;
+}
+
+bool net_socket_prefilter::matches(const char* begin, const char* end) const
+{
+    static const size_t STATE_LEN = 2;
+
+    if (!_states && _local_ports.empty() && _remote_ports.empty() &&
+        _uids.empty())
+    {
+        return true;
     }
+
+    // sl local_address rem_address st tx_queue:rx_queue tr:tm->when retrnsmt uid
+    const char* local      = skip_column(utils::skip_spaces(begin, end), end);
+    const char* local_end  = utils::find_space(local, end);
+    const char* remote     = utils::skip_spaces(local_end, end);
+    const char* remote_end = utils::find_space(remote, end);
+    const char* state      = utils::skip_spaces(remote_end, end);
+
+    if (static_cast<size_t>(end - state) < STATE_LEN)
+    {
+        return true; // Corrupted
+    }
+
+    // The state is the most selective, e.g. Listening sockets among many
+    // established connections
+    if (_states)
+    {
+        long value = parse_hex_digits(state, STATE_LEN);
+        if (value >= 0 && value < 32 && !((_states >> value) & 1))
+        {
+            return false;
+        }
+    }
+
+    if (!_local_ports.empty() && !has_port(_local_ports, local, local_end))
+    {
+        return false;
+    }
+
+    if (!_remote_ports.empty() &&
+        !has_port(_remote_ports, remote, remote_end))
+    {
+        return false;
+    }
+
+    if (!_uids.empty())
+    {
+        enum column
+        {
+            STATE = 0,
+            QUEUES,
+            TIMER,
+            RETRANSMITS,
+            UID,
+        };
+
+        const char* uid_column = state;
+        for (int i = STATE; i < UID; ++i)
+        {
+            uid_column = skip_column(uid_column, end);
+        }
+
+        try
+        {
+            uid_t uid;
+            utils::parse_number(uid_column, end, uid);
+            return std::find(_uids.begin(), _uids.end(), uid) != _uids.end();
+        }
+        catch (const std::exception&)
+        {
+            return true; // Corrupted
+        }
+    }
+
+    return true;
 }
 
 } // namespace parsers
@@ -0,0 +1,101 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "pfs/parsers/net_softnet_stat.hpp"
+#include "pfs/parser_error.hpp"
+#include "pfs/utils.hpp"
+
+namespace pfs {
+namespace impl {
+namespace parsers {
+
+net_softnet_stat parse_net_softnet_stat_line(const std::string& line,
+                                             unsigned index)
+{
+    // Example (5.10+):
+    // clang-format off
+    // 0000272d 00000000 00000001 00000000 00000000 00000000 00000000 00000000 00000000 00000000 00000000 00000000 00000000
+    // clang-format on
+    // Older kernels print fewer columns, newer kernels might print more.
+
+    enum token
+    {
+        PROCESSED        = 0,
+        DROPPED          = 1,
+        TIME_SQUEEZE     = 2,
+        // 3-7 are always zero, 8 is the obsolete cpu_collision
+        RECEIVED_RPS     = 9,
+        FLOW_LIMIT_COUNT = 10,
+        BACKLOG_LEN      = 11,
+        CPU              = 12,
+        MIN_COUNT        = 9,
+    };
+
+    auto tokens = utils::split(line);
+    if (tokens.size() < MIN_COUNT)
+    {
+        throw parser_error(
+            "Corrupted softnet stat line - Not enough tokens", line);
+    }
+
+    try
+    {
+        net_softnet_stat stat;
+        stat.cpu = index;
+
+        utils::stot(tokens[PROCESSED], stat.processed, utils::base::hex);
+        utils::stot(tokens[DROPPED], stat.dropped, utils::base::hex);
+        utils::stot(tokens[TIME_SQUEEZE], stat.time_squeeze, utils::base::hex);
+
+        if (tokens.size() > RECEIVED_RPS)
+        {
+            utils::stot(tokens[RECEIVED_RPS], stat.received_rps,
+                        utils::base::hex);
+        }
+
+        if (tokens.size() > FLOW_LIMIT_COUNT)
+        {
+            utils::stot(tokens[FLOW_LIMIT_COUNT], stat.flow_limit_count,
+                        utils::base::hex);
+        }
+
+        if (tokens.size() > BACKLOG_LEN)
+        {
+            utils::stot(tokens[BACKLOG_LEN], stat.backlog_len,
+                        utils::base::hex);
+        }
+
+        if (tokens.size() > CPU)
+        {
+            utils::stot(tokens[CPU], stat.cpu, utils::base::hex);
+        }
+
+        return stat;
+    }
+    catch (const std::invalid_argument& ex)
+    {
+        throw parser_error("Corrupted softnet stat - Invalid argument", line);
+    }
+    catch (const std::out_of_range& ex)
+    {
+        throw parser_error("Corrupted softnet stat - Out of range", line);
+    }
+}
+
+} // namespace parsers
+} // namespace impl
+} // namespace pfs
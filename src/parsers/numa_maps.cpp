@@ -0,0 +1,210 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cstring>
+
+#include "pfs/parsers/numa_maps.hpp"
+#include "pfs/parser_error.hpp"
+#include "pfs/utils.hpp"
+
+namespace pfs {
+namespace impl {
+namespace parsers {
+
+namespace {
+
+struct numa_maps_field
+{
+    const char* key;
+    size_t numa_region::*member;
+};
+
+// clang-format off
+static const numa_maps_field FIELDS[] = {
+    { "anon",              &numa_region::anon },
+    { "dirty",             &numa_region::dirty },
+    { "mapped",            &numa_region::mapped },
+    { "mapmax",            &numa_region::mapmax },
+    { "swapcache",         &numa_region::swapcache },
+    { "active",            &numa_region::active },
+    { "writeback",         &numa_region::writeback },
+    { "kernelpagesize_kB", &numa_region::page_size_kb },
+};
+// clang-format on
+
+bool starts_with(const char* begin, const char* end, const char* str)
+{
+    size_t len = strlen(str);
+    return static_cast<size_t>(end - begin) >= len &&
+           memcmp(begin, str, len) == 0;
+}
+
+void parse_node_pages(const char* key, const char* value, const char* end,
+                      numa_region& out)
+{
+    static const size_t NODE_PREFIX_LEN = 1; // 'N'
+    // The kernel supports up to 2^NODES_SHIFT nodes, and NODES_SHIFT is 10
+    // at most. Also keeps a corrupted id from growing the vector.
+    static const size_t MAX_NODES = 1024;
+
+    size_t node;
+    utils::parse_whole_number(key + NODE_PREFIX_LEN, value - 1, node);
+
+    if (node >= MAX_NODES)
+    {
+        throw std::out_of_range("Node id out of range");
+    }
+
+    if (node >= out.node_pages.size())
+    {
+        out.node_pages.resize(node + 1, 0);
+    }
+
+    utils::parse_whole_number(value, end, out.node_pages[node]);
+}
+
+void parse_value(const char* key, const char* value, const char* end,
+                 numa_region& out)
+{
+    static const char NODE_PREFIX = 'N';
+    static const char* FILE_KEY   = "file";
+
+    if (*key == NODE_PREFIX)
+    {
+        parse_node_pages(key, value, end, out);
+        return;
+    }
+
+    if (utils::equals(key, value - 1, FILE_KEY))
+    {
+        out.pathname.assign(value, end);
+        return;
+    }
+
+    for (const auto& field : FIELDS)
+    {
+        if (!utils::equals(key, value - 1, field.key))
+        {
+            continue;
+        }
+
+        utils::parse_whole_number(value, end, out.*field.member);
+        return;
+    }
+
+    // Unsupported key, ignore
+}
+
+void parse_flag(const char* begin, const char* end, numa_region& out)
+{
+    static const char* HEAP  = "heap";
+    static const char* STACK = "stack"; // Before 4.5, also "stack:<tid>"
+    static const char* HUGE  = "huge";
+
+    if (utils::equals(begin, end, HEAP))
+    {
+        out.is_heap = true;
+    }
+    else if (starts_with(begin, end, STACK))
+    {
+        out.is_stack = true;
+    }
+    else if (utils::equals(begin, end, HUGE))
+    {
+        out.is_huge = true;
+    }
+
+    // Unsupported flag, ignore
+}
+
+} // anonymous namespace
+
+numa_region parse_numa_maps_line(const std::string& line)
+{
+    // Some examples:
+    // clang-format off
+    // 559a3ad05000 default file=/usr/bin/head mapped=2 N0=2 kernelpagesize_kB=4
+    // 559a3ad10000 default file=/usr/bin/head anon=1 dirty=1 active=0 N0=1 kernelpagesize_kB=4
+    // 559a3b4b8000 default heap anon=33 dirty=33 active=0 N0=33 kernelpagesize_kB=4
+    // 7f3c1c000000 interleave:0-1 anon=4096 dirty=4096 N0=2048 N1=2048 kernelpagesize_kB=4
+    // 7ffd7a3f1000 default stack anon=3 dirty=3 active=0 N0=3 kernelpagesize_kB=4
+    // 7ffd7a3fa000 default
+    // clang-format on
+    //
+    // Note: Whitespaces in the pathname are escaped by the kernel, so the
+    // line can safely be tokenized by whitespaces.
+
+    static const char VALUE_DELIM = '=';
+
+    numa_region region;
+
+    const char* end = line.data() + line.size();
+
+    try
+    {
+        const char* curr = utils::parse_number(line.data(), end,
+                                               region.start_address,
+                                               utils::base::hex);
+        if (curr == end || *curr != ' ')
+        {
+            throw parser_error("Corrupted numa_maps line - Missing policy",
+                               line);
+        }
+
+        curr                   = utils::skip_spaces(curr, end);
+        const char* policy_end = utils::find_space(curr, end);
+        region.policy.assign(curr, policy_end);
+        curr = policy_end;
+
+        while ((curr = utils::skip_spaces(curr, end)) != end)
+        {
+            const char* token_end = utils::find_space(curr, end);
+            const char* delim =
+                static_cast<const char*>(memchr(curr, VALUE_DELIM,
+                                                token_end - curr));
+            if (delim)
+            {
+                parse_value(curr, delim + 1, token_end, region);
+            }
+            else
+            {
+                parse_flag(curr, token_end, region);
+            }
+            curr = token_end;
+        }
+    }
+    catch (const std::invalid_argument& ex)
+    {
+        throw parser_error("Corrupted numa_maps line - Invalid argument",
+                           line);
+    }
+    catch (const std::out_of_range& ex)
+    {
+        throw parser_error("Corrupted numa_maps line - Out of range", line);
+    }
+
+    if (region.policy.empty())
+    {
+        throw parser_error("Corrupted numa_maps line - Missing policy", line);
+    }
+
+    return region;
+}
+
+} // namespace parsers
+} // namespace impl
+} // namespace pfs
@@ -14,10 +14,19 @@
  *  limitations under the License.
  */
 
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
 #include <chrono>
 #include <cstring>
+#include <system_error>
 
-#include "pfs/parsers/number.hpp"
+#include "pfs/defer.hpp"
+#include "pfs/parser_error.hpp"
 #include "pfs/parsers/proc_stat.hpp"
 #include "pfs/utils.hpp"
 
@@ -27,209 +36,403 @@ namespace parsers {
 
 namespace {
 
-template <typename T>
-static void to_sequence(const std::string& value, proc_stat::sequence<T>& out)
-{
-    // Some examples:
-    // clang-format off
-    // 975101428 40707218 345522235 433770 2054357 19668 0 1807723 381659448 33954 202863055
-    // clang-format on
+// The intr line alone can be tens of KBs, so lines aren't buffered whole
+static const size_t BUFFER_SIZE = 16 * 1024;
 
-    enum token
-    {
-        TOTAL     = 0,
-        MIN_COUNT = 1,
-    };
-
-    auto tokens = utils::split(value);
-    if (tokens.size() < MIN_COUNT)
-    {
-        throw parser_error("Corrupted sequence - Unexpected tokens count",
-                           value);
-    }
-
-    try
+// Read whitespace-separated tokens out of a file, using a fixed-size buffer
+class token_reader
+{
+public:
+    explicit token_reader(int fd)
+        : _fd(fd), _begin(_buffer), _end(_buffer), _line_start(true),
+          _eof(false)
+    {}
+
+    // Return false at the end of the file.
+    // 'first' is set when the token is the first one of its line.
+    bool next(const char*& begin, const char*& end, bool& first)
     {
-        proc_stat::sequence<T> sequence;
+        static const char NEWLINE = '\n';
 
-        utils::stot(tokens[TOTAL], out.total);
-
-        for (size_t i = MIN_COUNT; i < tokens.size(); i++)
+        while (true)
         {
-            unsigned long long value;
-            utils::stot(tokens[i], value);
-            out.per_item.push_back(value);
+            while (_begin < _end && isspace(*_begin))
+            {
+                _line_start |= (*_begin == NEWLINE);
+                ++_begin;
+            }
+
+            if (_begin < _end)
+            {
+                break;
+            }
+
+            if (!fill())
+            {
+                return false;
+            }
         }
-    }
-    catch (const std::invalid_argument& ex)
-    {
-        throw parser_error("Corrupted sequence - Invalid argument", value);
-    }
-    catch (const std::out_of_range& ex)
-    {
-        throw parser_error("Corrupted sequence - Out of range", value);
-    }
-}
 
-static void to_cpu(const std::string& value, proc_stat::cpu& out)
-{
-    // Some examples:
-    // clang-format off
-    // 21497341 899627 8830588 433191163 93490 0 1844976 0 0 0
-    // 2684811 115236 1094082 54162041 10674 0 890071 0 0 0
-    // clang-format on
+        size_t length = 0;
+        while (true)
+        {
+            while (_begin + length < _end && !isspace(_begin[length]))
+            {
+                ++length;
+            }
+
+            // The token might continue in the next chunk
+            if (_begin + length < _end || !fill())
+            {
+                break;
+            }
+        }
 
-    enum token
-    {
-        USER       = 0,
-        NICE       = 1,
-        SYSTEM     = 2,
-        IDLE       = 3,
-        MIN_COUNT  = 4,
-        IOWAIT     = 4,
-        IRQ        = 5,
-        SOFTIRQ    = 6,
-        STEAL      = 7,
-        GUEST      = 8,
-        GUEST_NICE = 9,
-        COUNT
-    };
-
-    auto tokens = utils::split(value);
-    if (tokens.size() < MIN_COUNT || tokens.size() > COUNT)
-    {
-        throw parser_error("Corrupted cpu - Unexpected tokens count", value);
+        begin       = _begin;
+        end         = _begin + length;
+        first       = _line_start;
+        _line_start = false;
+        _begin += length;
+        return true;
     }
 
-    try
+    void skip_line()
     {
-        utils::stot(tokens[USER], out.user);
-        utils::stot(tokens[NICE], out.nice);
-        utils::stot(tokens[SYSTEM], out.system);
-        utils::stot(tokens[IDLE], out.idle);
+        static const char NEWLINE = '\n';
 
-        if (tokens.size() > IOWAIT)
+        while (true)
         {
-            utils::stot(tokens[IOWAIT], out.iowait);
-        }
-
-        if (tokens.size() > IRQ)
-        {
-            utils::stot(tokens[IRQ], out.irq);
+            auto newline = static_cast<char*>(
+                memchr(_begin, NEWLINE, static_cast<size_t>(_end - _begin)));
+            if (newline)
+            {
+                _begin      = newline + 1;
+                _line_start = true;
+                return;
+            }
+
+            _begin = _end;
+            if (!fill())
+            {
+                return;
+            }
         }
+    }
 
-        if (tokens.size() > SOFTIRQ)
+private:
+    // Keep the unconsumed data, and read more after it.
+    // Returns false if there's nothing more to read.
+    bool fill()
+    {
+        if (_eof)
         {
-            utils::stot(tokens[SOFTIRQ], out.softirq);
+            return false;
         }
 
-        if (tokens.size() > STEAL)
+        size_t left = static_cast<size_t>(_end - _begin);
+        if (left == BUFFER_SIZE)
         {
-            utils::stot(tokens[STEAL], out.steal);
+            throw parser_error("Corrupted stat - Token is too long",
+                               std::string(_begin, _begin + 64));
         }
 
-        if (tokens.size() > GUEST)
-        {
-            utils::stot(tokens[GUEST], out.guest);
-        }
+        memmove(_buffer, _begin, left);
+        _begin = _buffer;
+        _end   = _buffer + left;
 
-        if (tokens.size() > GUEST_NICE)
+        while (true)
         {
-            utils::stot(tokens[GUEST_NICE], out.guest_nice);
+            ssize_t bytes = read(_fd, _end, BUFFER_SIZE - left);
+            if (bytes == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+
+                throw std::system_error(errno, std::system_category(),
+                                        "Couldn't read file");
+            }
+
+            if (bytes == 0)
+            {
+                _eof = true;
+                return false;
+            }
+
+            _end += bytes;
+            return true;
         }
     }
-    catch (const std::invalid_argument& ex)
-    {
-        throw parser_error("Corrupted cpu - Invalid argument", value);
-    }
-    catch (const std::out_of_range& ex)
-    {
-        throw parser_error("Corrupted cpu - Out of range", value);
-    }
-}
-
-static void parse_cpu_total(const std::string& value, proc_stat& out)
-{
-    proc_stat::cpu cpu;
-    to_cpu(value, cpu);
 
-    out.cpus.total = cpu;
-}
+private:
+    int _fd;
+    char _buffer[BUFFER_SIZE];
+    char* _begin;
+    char* _end;
+    bool _line_start;
+    bool _eof;
+};
 
-static void parse_cpu_single(const std::string& value, proc_stat& out)
+enum class key
 {
-    proc_stat::cpu cpu;
-    to_cpu(value, cpu);
-
-    out.cpus.per_item.push_back(cpu);
-}
+    cpu_total,
+    cpu_single,
+    intr,
+    ctxt,
+    btime,
+    processes,
+    procs_running,
+    procs_blocked,
+    softirq,
+    unknown,
+};
 
-static void parse_intr(const std::string& value, proc_stat& out)
+// clang-format off
+static const struct
 {
-    to_sequence(value, out.intr);
-}
+    const char* name;
+    key value;
+    unsigned section;
+} KEYS[] = {
+    { "cpu",           key::cpu_total,     proc_stat::section::CPUS },
+    { "intr",          key::intr,          proc_stat::section::INTR },
+    { "ctxt",          key::ctxt,          proc_stat::section::CTXT },
+    { "btime",         key::btime,         proc_stat::section::BTIME },
+    { "processes",     key::processes,     proc_stat::section::PROCESSES },
+    { "procs_running", key::procs_running, proc_stat::section::PROCS },
+    { "procs_blocked", key::procs_blocked, proc_stat::section::PROCS },
+    { "softirq",       key::softirq,       proc_stat::section::SOFTIRQ },
+};
 
-static void parse_ctxt(const std::string& value, proc_stat& out)
-{
-    to_number(value, out.ctxt);
-}
+static unsigned long long proc_stat::cpu::* const CPU_FIELDS[] = {
+    &proc_stat::cpu::user,
+    &proc_stat::cpu::nice,
+    &proc_stat::cpu::system,
+    &proc_stat::cpu::idle,
+    &proc_stat::cpu::iowait,     // Since 2.5.41
+    &proc_stat::cpu::irq,        // Since 2.6.0
+    &proc_stat::cpu::softirq,    // Since 2.6.0
+    &proc_stat::cpu::steal,      // Since 2.6.11
+    &proc_stat::cpu::guest,      // Since 2.6.24
+    &proc_stat::cpu::guest_nice, // Since 2.6.33
+};
+// clang-format on
 
-static void parse_btime(const std::string& value, proc_stat& out)
-{
-    time_t btime;
-    to_number(value, btime);
-    out.btime = std::chrono::system_clock::from_time_t(btime);
-}
+static const size_t CPU_MIN_FIELDS = 4;
+static const size_t CPU_MAX_FIELDS = sizeof(CPU_FIELDS) / sizeof(CPU_FIELDS[0]);
 
-static void parse_processes(const std::string& value, proc_stat& out)
-{
-    to_number(value, out.processes);
-}
+static const char CPU_PREFIX[]      = "cpu";
+static const size_t CPU_PREFIX_LEN = sizeof(CPU_PREFIX) - 1;
 
-static void parse_procs_running(const std::string& value, proc_stat& out)
+key parse_key(const char* begin, const char* end, unsigned sections)
 {
-    to_number(value, out.procs_running);
-}
+    size_t len = static_cast<size_t>(end - begin);
+    for (const auto& entry : KEYS)
+    {
+        if (utils::equals(begin, end, entry.name))
+        {
+            return (sections & entry.section) ? entry.value : key::unknown;
+        }
+    }
 
-static void parse_procs_blocked(const std::string& value, proc_stat& out)
-{
-    to_number(value, out.procs_blocked);
+    if (len > CPU_PREFIX_LEN && memcmp(begin, CPU_PREFIX, CPU_PREFIX_LEN) == 0)
+    {
+        return (sections & proc_stat::section::CPUS) ? key::cpu_single
+                                                     : key::unknown;
+    }
+
+    return key::unknown;
 }
 
-static void parse_softirq(const std::string& value, proc_stat& out)
+// Overwrite an item, or add it if the vector is too short
+template <typename T>
+T& set_item(std::vector<T>& items, size_t index, const T& value)
 {
-    to_sequence(value, out.softirq);
+    if (index < items.size())
+    {
+        items[index] = value;
+    }
+    else
+    {
+        items.push_back(value);
+    }
+    return items[index];
 }
 
 } // anonymous namespace
 
-const char proc_stat_parser::DELIM = ' ';
-
-void proc_stat_parser::key_remap(std::string& key)
+void parse_proc_stat(const std::string& path, unsigned sections,
+                     proc_stat& out)
 {
-    if (key == "cpu")
+    // Some examples:
+    // clang-format off
+    // cpu  21497341 899627 8830588 433191163 93490 0 1844976 0 0 0
+    // cpu0 2684811 115236 1094082 54162041 10674 0 890071 0 0 0
+    // intr 975101428 40707218 345522235 433770 2054357 19668 0 1807723 ...
+    // ctxt 1953372737
+    // btime 1688388813
+    // processes 4164913
+    // procs_running 2
+    // procs_blocked 0
+    // softirq 524623431 11 113741706 27556 7431307 172939 0 1139451 ...
+    // clang-format on
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
     {
-        key = "cpu_total";
+        throw parser_error("Couldn't open file", path);
     }
-    else if (key.rfind("cpu", 0) == 0)
+    defer close_fd([fd] { close(fd); });
+
+    out.cpus.total    = proc_stat::cpu();
+    out.intr.total    = 0;
+    out.ctxt          = 0;
+    out.btime         = std::chrono::system_clock::time_point();
+    out.processes     = 0;
+    out.procs_running = 0;
+    out.procs_blocked = 0;
+    out.softirq.total = 0;
+
+    size_t cpus          = 0;
+    size_t intr_items    = 0;
+    size_t softirq_items = 0;
+
+    token_reader reader(fd);
+
+    const char* begin;
+    const char* end;
+    bool first;
+    bool has_token = reader.next(begin, end, first);
+    while (has_token)
     {
-        key = "cpu_single";
+        auto line_key = parse_key(begin, end, sections);
+        if (line_key == key::unknown)
+        {
+            reader.skip_line();
+            has_token = reader.next(begin, end, first);
+            continue;
+        }
+
+        // Kept for the error messages
+        size_t key_len    = static_cast<size_t>(end - begin);
+        char key_name[32] = {};
+        memcpy(key_name, begin, std::min(key_len, sizeof(key_name) - 1));
+
+        proc_stat::cpu* cpu = nullptr;
+        if (line_key == key::cpu_total)
+        {
+            cpu = &out.cpus.total;
+        }
+        else if (line_key == key::cpu_single)
+        {
+            cpu = &set_item(out.cpus.per_item, cpus++, proc_stat::cpu());
+            try
+            {
+                utils::parse_whole_number(begin + CPU_PREFIX_LEN, end, cpu->id);
+            }
+            catch (const std::exception&)
+            {
+                throw parser_error("Corrupted cpu - Invalid id", key_name);
+            }
+        }
+
+        size_t count = 0;
+        try
+        {
+            while ((has_token = reader.next(begin, end, first)) && !first)
+            {
+                switch (line_key)
+                {
+                case key::cpu_total:
+                case key::cpu_single:
+                    if (count >= CPU_MAX_FIELDS)
+                    {
+                        throw parser_error(
+                            "Corrupted cpu - Unexpected tokens count",
+                            key_name);
+                    }
+                    utils::parse_whole_number(begin, end, cpu->*CPU_FIELDS[count]);
+                    break;
+
+                case key::intr:
+                case key::softirq:
+                {
+                    auto& sequence =
+                        (line_key == key::intr) ? out.intr : out.softirq;
+                    auto& items =
+                        (line_key == key::intr) ? intr_items : softirq_items;
+
+                    unsigned long long value;
+                    utils::parse_whole_number(begin, end, value);
+                    if (count == 0)
+                    {
+                        sequence.total = value;
+                    }
+                    else
+                    {
+                        set_item(sequence.per_item, items++, value);
+                    }
+                    break;
+                }
+
+                default:
+                    if (count > 0)
+                    {
+                        throw parser_error(
+                            "Corrupted stat - Unexpected tokens count",
+                            key_name);
+                    }
+
+                    if (line_key == key::ctxt)
+                    {
+                        utils::parse_whole_number(begin, end, out.ctxt);
+                    }
+                    else if (line_key == key::btime)
+                    {
+                        time_t btime;
+                        utils::parse_whole_number(begin, end, btime);
+                        out.btime = std::chrono::system_clock::from_time_t(btime);
+                    }
+                    else if (line_key == key::processes)
+                    {
+                        utils::parse_whole_number(begin, end, out.processes);
+                    }
+                    else if (line_key == key::procs_running)
+                    {
+                        utils::parse_whole_number(begin, end, out.procs_running);
+                    }
+                    else
+                    {
+                        utils::parse_whole_number(begin, end, out.procs_blocked);
+                    }
+                    break;
+                }
+
+                ++count;
+            }
+        }
+        catch (const std::invalid_argument&)
+        {
+            throw parser_error("Corrupted stat - Invalid argument", key_name);
+        }
+        catch (const std::out_of_range&)
+        {
+            throw parser_error("Corrupted stat - Out of range", key_name);
+        }
+
+        size_t min_count = cpu ? CPU_MIN_FIELDS : 1;
+        if (count < min_count)
+        {
+            throw parser_error("Corrupted stat - Unexpected tokens count",
+                               key_name);
+        }
     }
-}
 
-// clang-format off
-const proc_stat_parser::value_parsers proc_stat_parser::PARSERS = {
-    { "cpu_total", parse_cpu_total },
-    { "cpu_single", parse_cpu_single },
-    { "intr", parse_intr },
-    { "ctxt", parse_ctxt },
-    { "btime", parse_btime },
-    { "processes", parse_processes },
-    { "procs_running", parse_procs_running },
-    { "procs_blocked", parse_procs_blocked },
-    { "softirq", parse_softirq },
-};
-// clang-format on
+    out.cpus.per_item.resize(cpus);
+    out.intr.per_item.resize(intr_items);
+    out.softirq.per_item.resize(softirq_items);
+}
 
 } // namespace parsers
 } // namespace impl
@@ -0,0 +1,117 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <cstring>
+
+#include "pfs/parsers/smaps.hpp"
+#include "pfs/parser_error.hpp"
+#include "pfs/utils.hpp"
+
+namespace pfs {
+namespace impl {
+namespace parsers {
+
+namespace {
+
+struct smaps_field
+{
+    const char* key;
+    size_t smaps_region::*member;
+};
+
+// clang-format off
+static const smaps_field FIELDS[] = {
+    { "Size",          &smaps_region::size },
+    { "Rss",           &smaps_region::rss },
+    { "Pss",           &smaps_region::pss },
+    { "Shared_Clean",  &smaps_region::shared_clean },
+    { "Shared_Dirty",  &smaps_region::shared_dirty },
+    { "Private_Clean", &smaps_region::private_clean },
+    { "Private_Dirty", &smaps_region::private_dirty },
+    { "Referenced",    &smaps_region::referenced },
+    { "Anonymous",     &smaps_region::anonymous },
+    { "AnonHugePages", &smaps_region::anon_huge_pages },
+    { "Swap",          &smaps_region::swap },
+    { "SwapPss",       &smaps_region::swap_pss },
+    { "Locked",        &smaps_region::locked },
+};
+// clang-format on
+
+} // anonymous namespace
+
+bool is_smaps_header_line(const std::string& line)
+{
+    // Header lines start with an address range, and value lines start with
+    // a key that is terminated by a colon.
+    static const char KEY_DELIM = ':';
+
+    const char* begin = line.data();
+    const char* space = utils::find_space(begin, begin + line.size());
+    return space != begin && space[-1] != KEY_DELIM;
+}
+
+void parse_smaps_value_line(const std::string& line, smaps_region& out)
+{
+    // Some examples:
+    // clang-format off
+    // Size:                  8 kB
+    // Pss_Dirty:             0 kB
+    // THPeligible:           0
+    // VmFlags: rd mr mw me
+    // clang-format on
+
+    static const char KEY_DELIM = ':';
+
+    size_t delim = line.find(KEY_DELIM);
+    if (delim == std::string::npos)
+    {
+        throw parser_error("Corrupted smaps line - Missing key", line);
+    }
+
+    for (const auto& field : FIELDS)
+    {
+        if (strlen(field.key) != delim ||
+            line.compare(0, delim, field.key) != 0)
+        {
+            continue;
+        }
+
+        const char* end   = line.data() + line.size();
+        const char* value = utils::skip_spaces(line.data() + delim + 1, end);
+
+        try
+        {
+            utils::parse_number(value, end, out.*field.member);
+        }
+        catch (const std::invalid_argument& ex)
+        {
+            throw parser_error("Corrupted smaps line - Invalid argument", line);
+        }
+        catch (const std::out_of_range& ex)
+        {
+            throw parser_error("Corrupted smaps line - Out of range", line);
+        }
+
+        return;
+    }
+
+    // Unsupported key, ignore
+}
+
+} // namespace parsers
+} // namespace impl
+} // namespace pfs
@@ -14,21 +14,29 @@
  *  limitations under the License.
  */
 
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <map>
 #include <system_error>
 
 #include "pfs/parsers/filesystems.hpp"
 #include "pfs/parsers/meminfo.hpp"
 #include "pfs/parsers/buddyinfo.hpp"
 #include "pfs/parsers/cgroup_controller.hpp"
+#include "pfs/parsers/fd_link.hpp"
 #include "pfs/parsers/loadavg.hpp"
 #include "pfs/parsers/uptime.hpp"
 #include "pfs/parsers/modules.hpp"
 #include "pfs/parsers/lines.hpp"
 #include "pfs/parsers/proc_stat.hpp"
+#include "pfs/parsers/interrupts.hpp"
+#include "pfs/defer.hpp"
 #include "pfs/procfs.hpp"
 #include "pfs/utils.hpp"
 
@@ -36,6 +44,140 @@ namespace pfs {
 
 using namespace impl;
 
+namespace {
+
+struct object_key
+{
+    dev_t device;
+    ino_t inode;
+
+    bool operator==(const object_key& rhs) const
+    {
+        return device == rhs.device && inode == rhs.inode;
+    }
+};
+
+struct object_key_hash
+{
+    size_t operator()(const object_key& key) const
+    {
+        return std::hash<uint64_t>()(static_cast<uint64_t>(key.inode) ^
+                                     (static_cast<uint64_t>(key.device) << 32));
+    }
+};
+
+using object_map =
+    std::unordered_map<object_key, mapped_object, object_key_hash>;
+
+mapped_object& get_object(object_map& objects, const mem_region& region)
+{
+    object_key key = {region.device, region.inode};
+
+    auto iter = objects.find(key);
+    if (iter == objects.end())
+    {
+        mapped_object object;
+        object.device   = region.device;
+        object.inode    = region.inode;
+        object.pathname = region.pathname;
+        object.mappers  = 1;
+        iter            = objects.emplace(key, std::move(object)).first;
+    }
+
+    return iter->second;
+}
+
+void add_region(object_map& objects, const mem_region& region)
+{
+    auto& object = get_object(objects, region);
+    object.mapped_bytes += region.end_address - region.start_address;
+}
+
+void add_region(object_map& objects, const smaps_region& smaps)
+{
+    static const size_t KB = 1024;
+
+    size_t private_kb = smaps.private_clean + smaps.private_dirty;
+
+    // Private pages are charged in full, so the rest of the PSS is this
+    // process' share of the shared pages
+    size_t unique_kb = std::min(private_kb, smaps.pss);
+
+    auto& object = get_object(objects, smaps.region);
+    object.mapped_bytes += smaps.region.end_address - smaps.region.start_address;
+    object.rss_bytes += smaps.rss * KB;
+    object.pss_bytes += smaps.pss * KB;
+    object.unique_bytes += unique_kb * KB;
+    object.shared_pss_bytes += (smaps.pss - unique_kb) * KB;
+    object.swap_pss_bytes += smaps.swap_pss * KB;
+    object.private_bytes += private_kb * KB;
+    object.shared_bytes += (smaps.shared_clean + smaps.shared_dirty) * KB;
+}
+
+const mem_region& region_of(const mem_region& region)
+{
+    return region;
+}
+
+const mem_region& region_of(const smaps_region& smaps)
+{
+    return smaps.region;
+}
+
+template <typename Region>
+object_map group_by_object(const std::vector<Region>& regions)
+{
+    object_map objects;
+    for (const auto& region : regions)
+    {
+        // Skip anonymous and special mappings
+        if (region_of(region).inode != INVALID_INODE)
+        {
+            add_region(objects, region);
+        }
+    }
+    return objects;
+}
+
+using socket_fd = std::pair<ino_t, socket_owner>;
+
+void collect_socket_fds(const std::string& fds_dir, int pid,
+                        std::vector<socket_fd>& out)
+{
+    // Socket links are short, so anything that doesn't fit is not a socket
+    static const size_t MAX_SOCKET_LINK = 32;
+
+    int dirfd = open(fds_dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirfd == -1)
+    {
+        throw std::system_error(errno, std::system_category(),
+                                "Couldn't open fds dir");
+    }
+    defer close_dirfd([dirfd] { close(dirfd); });
+
+    utils::iterate_files(dirfd, /* include_dots */ false, [&](const char* name) {
+        char link[MAX_SOCKET_LINK];
+        ssize_t bytes = readlinkat(dirfd, name, link, sizeof(link));
+        if (bytes <= 0 || static_cast<size_t>(bytes) == sizeof(link))
+        {
+            return; // Closed in the meantime, or too long to be a socket
+        }
+
+        ino_t inode;
+        if (!parsers::parse_socket_link(link, bytes, inode))
+        {
+            return;
+        }
+
+        socket_owner owner;
+        owner.pid = pid;
+        utils::parse_number(name, name + strlen(name), owner.fd);
+        out.emplace_back(inode, owner);
+    });
+}
+
+} // anonymous namespace
+
 const std::string procfs::DEFAULT_ROOT("/proc/");
 
 procfs::procfs(const std::string& root) : _root(build_root(root))
@@ -65,6 +207,57 @@ void procfs::validate_root(const std::string& root)
     }
 }
 
+bool procfs::is_process_unavailable(const std::system_error& err)
+{
+    switch (err.code().value())
+    {
+    case ENOENT: // Exited before its files were opened
+    case ESRCH:  // Exited while its files were read
+    case EACCES:
+    case EPERM:
+        return true;
+    default:
+        return false;
+    }
+}
+
+template <typename T, typename Fn>
+std::vector<std::pair<int, T>> procfs::for_each_process(size_t workers,
+                                                        Fn fn) const
+{
+    auto ids = utils::enumerate_numeric_files(_root);
+    std::vector<int> pids(ids.begin(), ids.end());
+
+    std::vector<T> results(pids.size());
+    std::vector<char> valid(pids.size(), false); // Not bool, to avoid races
+
+    utils::parallel_for(pids.size(), workers, [&](size_t i) {
+        try
+        {
+            results[i] = fn(get_task(pids[i]));
+            valid[i]   = true;
+        }
+        catch (const std::system_error& err)
+        {
+            if (!is_process_unavailable(err))
+            {
+                throw;
+            }
+        }
+    });
+
+    std::vector<std::pair<int, T>> output;
+    output.reserve(pids.size());
+    for (size_t i = 0; i < pids.size(); ++i)
+    {
+        if (valid[i])
+        {
+            output.emplace_back(pids[i], std::move(results[i]));
+        }
+    }
+    return output;
+}
+
 task procfs::get_task(int task_id) const
 {
     return task(_root, task_id);
@@ -81,11 +274,150 @@ std::set<task> procfs::get_processes() const
     return tasks;
 }
 
+std::unordered_map<int, std::vector<compact_mem_region>>
+procfs::get_processes_maps(string_pool& pool, size_t workers) const
+{
+    auto maps = for_each_process<std::vector<compact_mem_region>>(
+        workers, [&pool](const task& task) { return task.get_maps(pool); });
+
+    std::unordered_map<int, std::vector<compact_mem_region>> output;
+    for (auto& entry : maps)
+    {
+        output.emplace(entry.first, std::move(entry.second));
+    }
+    return output;
+}
+
+std::unordered_map<int, std::vector<size_t>>
+procfs::get_processes_numa_usage(size_t workers) const
+{
+    auto usage = for_each_process<std::vector<size_t>>(
+        workers, [](const task& task) { return task.get_numa_usage(); });
+
+    std::unordered_map<int, std::vector<size_t>> output;
+    for (auto& entry : usage)
+    {
+        output.emplace(entry.first, std::move(entry.second));
+    }
+    return output;
+}
+
+std::vector<mapped_object>
+procfs::get_mapped_objects(mapping_source source, size_t workers) const
+{
+    // Every process is grouped on its own, so that processes mapping
+    // the same object more than once are counted as a single mapper.
+    auto per_process = for_each_process<object_map>(
+        workers, [source](const task& task) {
+            if (source == mapping_source::smaps)
+            {
+                return group_by_object(task.get_smaps());
+            }
+            return group_by_object(task.get_maps());
+        });
+
+    object_map objects;
+    for (auto& process : per_process)
+    {
+        for (auto& entry : process.second)
+        {
+            auto iter = objects.find(entry.first);
+            if (iter == objects.end())
+            {
+                objects.emplace(entry.first, std::move(entry.second));
+                continue;
+            }
+
+            auto& object = iter->second;
+            object.mappers += entry.second.mappers;
+            object.mapped_bytes += entry.second.mapped_bytes;
+            object.rss_bytes += entry.second.rss_bytes;
+            object.pss_bytes += entry.second.pss_bytes;
+            object.unique_bytes += entry.second.unique_bytes;
+            object.shared_pss_bytes += entry.second.shared_pss_bytes;
+            object.swap_pss_bytes += entry.second.swap_pss_bytes;
+            object.private_bytes += entry.second.private_bytes;
+            object.shared_bytes += entry.second.shared_bytes;
+        }
+    }
+
+    std::vector<mapped_object> output;
+    output.reserve(objects.size());
+    for (auto& entry : objects)
+    {
+        output.emplace_back(std::move(entry.second));
+    }
+
+    std::sort(output.begin(), output.end(),
+              [](const mapped_object& lhs, const mapped_object& rhs) {
+                  if (lhs.pss_bytes != rhs.pss_bytes)
+                  {
+                      return lhs.pss_bytes > rhs.pss_bytes;
+                  }
+                  return lhs.mapped_bytes > rhs.mapped_bytes;
+              });
+
+    return output;
+}
+
+std::unordered_multimap<ino_t, socket_owner>
+procfs::get_socket_owners(size_t workers) const
+{
+    static const std::string FDS_DIR("fd/");
+
+    auto sockets = for_each_process<std::vector<socket_fd>>(
+        workers, [](const task& task) {
+            std::vector<socket_fd> fds;
+            collect_socket_fds(task.dir() + FDS_DIR, task.id(), fds);
+            return fds;
+        });
+
+    size_t total = 0;
+    for (const auto& process : sockets)
+    {
+        total += process.second.size();
+    }
+
+    std::unordered_multimap<ino_t, socket_owner> output;
+    output.reserve(total);
+    for (const auto& process : sockets)
+    {
+        output.insert(process.second.begin(), process.second.end());
+    }
+    return output;
+}
+
 net procfs::get_net(int task_id) const
 {
     return get_task(task_id).get_net();
 }
 
+std::vector<net_namespace> procfs::get_net_namespaces(size_t workers) const
+{
+    static const std::string NET_NS("net");
+
+    auto inodes = for_each_process<ino_t>(
+        workers, [](const task& task) { return task.get_ns(NET_NS); });
+
+    // Tasks are sorted, so the pids of every namespace are sorted as well
+    std::map<ino_t, std::vector<int>> namespaces;
+    for (const auto& entry : inodes)
+    {
+        namespaces[entry.second].push_back(entry.first);
+    }
+
+    std::vector<net_namespace> output;
+    output.reserve(namespaces.size());
+    for (auto& ns : namespaces)
+    {
+        net_namespace entry;
+        entry.inode = ns.first;
+        entry.pids  = std::move(ns.second);
+        output.push_back(std::move(entry));
+    }
+    return output;
+}
+
 std::vector<zone> procfs::get_buddyinfo() const
 {
     static const std::string BUDDYINFO_FILE("buddyinfo");
@@ -130,6 +462,22 @@ std::unordered_map<std::string, bool> procfs::get_filesystems() const
     return output;
 }
 
+kpage_table procfs::get_kpagecount() const
+{
+    static const std::string KPAGECOUNT_FILE("kpagecount");
+    auto path = _root + KPAGECOUNT_FILE;
+
+    return kpage_table(path);
+}
+
+kpage_table procfs::get_kpageflags() const
+{
+    static const std::string KPAGEFLAGS_FILE("kpageflags");
+    auto path = _root + KPAGEFLAGS_FILE;
+
+    return kpage_table(path);
+}
+
 std::unordered_map<std::string, size_t> procfs::get_meminfo() const
 {
     static const std::string MEMINFO_FILE("meminfo");
@@ -141,6 +489,14 @@ std::unordered_map<std::string, size_t> procfs::get_meminfo() const
     return output;
 }
 
+void procfs::get_meminfo(meminfo& out) const
+{
+    static const std::string MEMINFO_FILE("meminfo");
+    auto path = _root + MEMINFO_FILE;
+
+    parsers::parse_meminfo(path, out);
+}
+
 load_average procfs::get_loadavg() const
 {
     static const std::string LOADAVG_FILE("loadavg");
@@ -159,12 +515,49 @@ uptime procfs::get_uptime() const
     return parsers::parse_uptime_line(line);
 }
 
-proc_stat procfs::get_stat() const
+proc_stat procfs::get_stat(unsigned sections) const
+{
+    proc_stat output;
+    get_stat(output, sections);
+    return output;
+}
+
+void procfs::get_stat(proc_stat& out, unsigned sections) const
 {
     static const std::string STATUS_FILE("stat");
     auto path = _root + STATUS_FILE;
 
-    return parsers::proc_stat_parser().parse(path);
+    parsers::parse_proc_stat(path, sections, out);
+}
+
+irq_matrix procfs::get_interrupts() const
+{
+    irq_matrix output;
+    get_interrupts(output);
+    return output;
+}
+
+void procfs::get_interrupts(irq_matrix& out) const
+{
+    static const std::string INTERRUPTS_FILE("interrupts");
+    auto path = _root + INTERRUPTS_FILE;
+
+    parsers::parse_irq_matrix(path, out);
+}
+
+irq_matrix procfs::get_softirqs() const
+{
+    irq_matrix output;
+    get_softirqs(output);
+    return output;
+}
+
+void procfs::get_softirqs(irq_matrix& out) const
+{
+    static const std::string SOFTIRQS_FILE("softirqs");
+    auto path = _root + SOFTIRQS_FILE;
+
+    parsers::parse_irq_matrix(path, out);
 }
 
 std::vector<module> procfs::get_modules() const
@@ -0,0 +1,268 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <arpa/inet.h>
+#include <net/route.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "pfs/route_table.hpp"
+
+namespace pfs {
+
+namespace {
+
+static const unsigned int ROOT_BITS = 16;
+static const unsigned int NODE_BITS = 8;
+static const size_t ROOT_SIZE       = 1 << ROOT_BITS;
+static const size_t NODE_SIZE       = 1 << NODE_BITS;
+
+static const unsigned int IPV4_BITS = 32;
+static const unsigned int IPV6_BITS = 128;
+
+// Lookups issued ahead of the current one in batches
+static const size_t PREFETCH_DISTANCE = 8;
+
+const uint8_t* key_of(const ip& addr)
+{
+    return reinterpret_cast<const uint8_t*>(addr.storage.data());
+}
+
+unsigned int mask_to_prefix_len(const ip& mask)
+{
+    uint32_t host_mask = ntohl(mask.storage[0]);
+
+    unsigned int prefix_len = __builtin_popcount(host_mask);
+    uint32_t expected = prefix_len ? ~0U << (IPV4_BITS - prefix_len) : 0;
+    if (host_mask != expected)
+    {
+        throw std::invalid_argument("Route mask isn't contiguous");
+    }
+    return prefix_len;
+}
+
+} // anonymous namespace
+
+const uint32_t route_table::trie::CHILD;
+
+route_table::route_table(const std::vector<net_route>& routes,
+                         const std::vector<net_ipv6_route>& ipv6_routes)
+{
+    _routes.reserve(routes.size() + ipv6_routes.size());
+
+    for (const auto& route : routes)
+    {
+        if (!(route.flags & RTF_UP))
+        {
+            continue;
+        }
+
+        route_entry entry;
+        entry.prefix_len  = mask_to_prefix_len(route.mask);
+        entry.destination = ip(static_cast<ipv4>(
+            route.destination.storage[0] & route.mask.storage[0]));
+        entry.gateway = route.gateway;
+        entry.iface   = route.iface;
+        entry.flags   = route.flags;
+        entry.metric  = static_cast<unsigned int>(route.metric);
+        _routes.push_back(std::move(entry));
+    }
+
+    for (const auto& route : ipv6_routes)
+    {
+        if (!(route.flags & RTF_UP))
+        {
+            continue;
+        }
+
+        if (route.destination_prefix_len > IPV6_BITS)
+        {
+            throw std::invalid_argument("Route prefix is too long");
+        }
+
+        route_entry entry;
+        entry.destination = route.destination;
+        entry.prefix_len  = route.destination_prefix_len;
+        entry.gateway     = route.next_hop;
+        entry.iface       = route.iface;
+        entry.flags       = route.flags;
+        entry.metric      = route.metric;
+        _routes.push_back(std::move(entry));
+    }
+
+    if (_routes.size() >= trie::CHILD)
+    {
+        throw std::length_error("Too many routes");
+    }
+
+    // Longer prefixes must override shorter ones, so they come last.
+    // Among equal prefixes, the lowest metric and then the first route
+    // listed wins, same as the kernel.
+    std::vector<uint32_t> order(_routes.size());
+    for (uint32_t i = 0; i < order.size(); ++i)
+    {
+        order[i] = i;
+    }
+
+    std::sort(order.begin(), order.end(), [this](uint32_t lhs, uint32_t rhs) {
+        const auto& left  = _routes[lhs];
+        const auto& right = _routes[rhs];
+        if (left.prefix_len != right.prefix_len)
+        {
+            return left.prefix_len < right.prefix_len;
+        }
+        if (left.metric != right.metric)
+        {
+            return left.metric > right.metric;
+        }
+        return lhs > rhs;
+    });
+
+    for (auto index : order)
+    {
+        const auto& entry = _routes[index];
+        auto& target      = entry.destination.is_v4() ? _ipv4 : _ipv6;
+        target.insert(key_of(entry.destination), entry.prefix_len, index + 1);
+    }
+}
+
+const route_entry* route_table::lookup(const ip& destination) const
+{
+    if (!destination.is_v4() && !destination.is_v6())
+    {
+        return nullptr;
+    }
+
+    uint32_t value = get_trie(destination).lookup(key_of(destination));
+    return value ? &_routes[value - 1] : nullptr;
+}
+
+void route_table::lookup(const std::vector<ip>& destinations,
+                         std::vector<const route_entry*>& out) const
+{
+    out.resize(destinations.size());
+
+    for (size_t i = 0; i < destinations.size(); ++i)
+    {
+        // The root slot is the likeliest cache miss, fetch it ahead of time
+        if (i + PREFETCH_DISTANCE < destinations.size())
+        {
+            const auto& ahead = destinations[i + PREFETCH_DISTANCE];
+            if (ahead.is_v4() || ahead.is_v6())
+            {
+                __builtin_prefetch(get_trie(ahead).root_slot(key_of(ahead)));
+            }
+        }
+
+        out[i] = lookup(destinations[i]);
+    }
+}
+
+const std::vector<route_entry>& route_table::routes() const
+{
+    return _routes;
+}
+
+const route_table::trie& route_table::get_trie(const ip& destination) const
+{
+    return destination.is_v4() ? _ipv4 : _ipv6;
+}
+
+void route_table::trie::insert(const uint8_t* key, unsigned int prefix_len,
+                               uint32_t value)
+{
+    if (_root.empty())
+    {
+        _root.assign(ROOT_SIZE, 0);
+    }
+
+    size_t root_index = (static_cast<size_t>(key[0]) << NODE_BITS) | key[1];
+
+    if (prefix_len <= ROOT_BITS)
+    {
+        size_t span  = size_t(1) << (ROOT_BITS - prefix_len);
+        size_t first = root_index & ~(span - 1);
+        std::fill_n(_root.begin() + first, span, value);
+        return;
+    }
+
+    // Nodes are appended as we go, so slots are tracked by index
+    bool in_root      = true;
+    size_t slot_index = root_index;
+    auto slot = [&]() -> uint32_t& {
+        return in_root ? _root[slot_index] : _nodes[slot_index];
+    };
+
+    for (size_t depth = 2, left = prefix_len - ROOT_BITS;; ++depth,
+                left -= NODE_BITS)
+    {
+        if (!(slot() & CHILD))
+        {
+            // Push the current value down to the new node
+            uint32_t child = add_node(slot());
+            slot()         = CHILD | child;
+        }
+
+        size_t base = static_cast<size_t>(slot() & ~CHILD) * NODE_SIZE;
+        if (left <= NODE_BITS)
+        {
+            size_t span  = size_t(1) << (NODE_BITS - left);
+            size_t first = key[depth] & ~(span - 1);
+            std::fill_n(_nodes.begin() + base + first, span, value);
+            return;
+        }
+
+        in_root    = false;
+        slot_index = base + key[depth];
+    }
+}
+
+uint32_t route_table::trie::lookup(const uint8_t* key) const
+{
+    if (_root.empty())
+    {
+        return 0;
+    }
+
+    uint32_t slot = _root[(static_cast<size_t>(key[0]) << NODE_BITS) | key[1]];
+    for (size_t depth = 2; slot & CHILD; ++depth)
+    {
+        slot = _nodes[static_cast<size_t>(slot & ~CHILD) * NODE_SIZE +
+                      key[depth]];
+    }
+    return slot;
+}
+
+const uint32_t* route_table::trie::root_slot(const uint8_t* key) const
+{
+    if (_root.empty())
+    {
+        return nullptr;
+    }
+    return &_root[(static_cast<size_t>(key[0]) << NODE_BITS) | key[1]];
+}
+
+uint32_t route_table::trie::add_node(uint32_t fill)
+{
+    auto node = static_cast<uint32_t>(_nodes.size() / NODE_SIZE);
+    _nodes.resize(_nodes.size() + NODE_SIZE, fill);
+    return node;
+}
+
+} // namespace pfs
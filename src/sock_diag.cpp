@@ -0,0 +1,589 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <arpa/inet.h>
+#include <linux/kdev_t.h>
+#include <linux/sock_diag.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <system_error>
+
+#include "pfs/sock_diag.hpp"
+
+namespace pfs {
+namespace impl {
+namespace sock_diag {
+
+namespace {
+
+static const size_t RECV_BUFFER_SIZE = 64 * 1024;
+
+// A single bytecode operation, including its operands.
+// All the 'yes' and 'no' jumps are resolved once the layout is known.
+struct bc_block
+{
+    uint8_t code;
+    std::vector<char> operands;
+
+    size_t size() const { return sizeof(inet_diag_bc_op) + operands.size(); }
+};
+
+// All the blocks of an alternative must match
+using bc_alternative = std::vector<bc_block>;
+
+// At least one of the alternatives of a group must match
+using bc_group = std::vector<bc_alternative>;
+
+bc_block make_port_block(uint8_t code, uint16_t port)
+{
+    // The port is stored in the 'no' field of a second operation
+    inet_diag_bc_op operand = {0, 0, port};
+
+    bc_block block;
+    block.code = code;
+    block.operands.resize(sizeof(operand));
+    memcpy(block.operands.data(), &operand, sizeof(operand));
+    return block;
+}
+
+bc_group make_port_group(const std::vector<uint16_t>& ports, bool local)
+{
+    // Use a pair of GE and LE comparisons, since EQ only exists since 4.17
+    bc_group group;
+    for (auto port : ports)
+    {
+        group.push_back({
+            make_port_block(local ? INET_DIAG_BC_S_GE : INET_DIAG_BC_D_GE, port),
+            make_port_block(local ? INET_DIAG_BC_S_LE : INET_DIAG_BC_D_LE, port),
+        });
+    }
+    return group;
+}
+
+bc_group make_address_group(const std::vector<ip>& ips, bool local)
+{
+    static const int ANY_PORT = -1;
+
+    bc_group group;
+    for (const auto& addr : ips)
+    {
+        size_t addr_size =
+            addr.is_v4() ? sizeof(ipv4) : sizeof(ipv6);
+
+        inet_diag_hostcond cond;
+        cond.family     = static_cast<uint8_t>(addr.domain);
+        cond.prefix_len = static_cast<uint8_t>(addr_size * 8);
+        cond.port       = ANY_PORT;
+
+        bc_block block;
+        block.code = local ? INET_DIAG_BC_S_COND : INET_DIAG_BC_D_COND;
+        block.operands.resize(sizeof(cond) + addr_size);
+        memcpy(block.operands.data(), &cond, sizeof(cond));
+        memcpy(block.operands.data() + sizeof(cond), addr.storage.data(),
+               addr_size);
+
+        group.push_back({block});
+    }
+    return group;
+}
+
+uint32_t to_states_mask(const std::set<net_socket::net_state>& states)
+{
+    // TCPF_ALL, i.e. TCP_ESTABLISHED to TCP_CLOSING. Anything above isn't a
+    // state procfs reports, e.g. TCP_BOUND_INACTIVE (Since 6.5) would also
+    // dump the sockets that are bound but don't listen.
+    static const uint32_t ALL_STATES = 0xFFF;
+
+    if (states.empty())
+    {
+        return ALL_STATES;
+    }
+
+    uint32_t mask = 0;
+    for (auto state : states)
+    {
+        mask |= 1U << static_cast<unsigned>(state);
+    }
+    return mask;
+}
+
+// The kernel's internal device encoding
+dev_t to_device(uint32_t sdev)
+{
+    static const unsigned MINOR_BITS = 20;
+    static const unsigned MINOR_MASK = (1U << MINOR_BITS) - 1;
+
+    return MKDEV(sdev >> MINOR_BITS, sdev & MINOR_MASK);
+}
+
+template <typename T>
+const T* get_payload(const rtattr* attr)
+{
+    if (!attr || RTA_PAYLOAD(attr) < sizeof(T))
+    {
+        return nullptr;
+    }
+    return static_cast<const T*>(RTA_DATA(const_cast<rtattr*>(attr)));
+}
+
+std::vector<char> build_request(uint8_t family, uint8_t protocol,
+                                const net_socket_query& query,
+                                uint8_t extensions)
+{
+    auto bytecode = build_inet_bytecode(query);
+
+    size_t attr_size = bytecode.empty() ? 0 : RTA_SPACE(bytecode.size());
+    size_t size      = NLMSG_SPACE(sizeof(inet_diag_req_v2)) + attr_size;
+
+    std::vector<char> request(size, 0);
+
+    auto header         = reinterpret_cast<nlmsghdr*>(request.data());
+    header->nlmsg_len   = static_cast<uint32_t>(size);
+    header->nlmsg_type  = SOCK_DIAG_BY_FAMILY;
+    header->nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+
+    auto req            = static_cast<inet_diag_req_v2*>(NLMSG_DATA(header));
+    req->sdiag_family   = family;
+    req->sdiag_protocol = protocol;
+    req->idiag_ext      = extensions;
+    req->idiag_states   = to_states_mask(query.states);
+    req->id.idiag_cookie[0] = INET_DIAG_NOCOOKIE;
+    req->id.idiag_cookie[1] = INET_DIAG_NOCOOKIE;
+
+    if (!bytecode.empty())
+    {
+        auto attr = reinterpret_cast<rtattr*>(
+            request.data() + NLMSG_SPACE(sizeof(inet_diag_req_v2)));
+        attr->rta_type = INET_DIAG_REQ_BYTECODE;
+        attr->rta_len  = static_cast<unsigned short>(RTA_LENGTH(bytecode.size()));
+        memcpy(RTA_DATA(attr), bytecode.data(), bytecode.size());
+    }
+
+    return request;
+}
+
+} // anonymous namespace
+
+diag_socket::diag_socket()
+    : _fd(socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_SOCK_DIAG)),
+      _buffer(RECV_BUFFER_SIZE)
+{
+    if (_fd < 0)
+    {
+        throw std::system_error(errno, std::system_category(),
+                                "Couldn't create sock_diag socket");
+    }
+}
+
+diag_socket::~diag_socket()
+{
+    close(_fd);
+}
+
+void diag_socket::dump(const std::vector<char>& request,
+                       const std::function<void(const nlmsghdr&)>& handler)
+{
+    sockaddr_nl kernel = {};
+    kernel.nl_family   = AF_NETLINK;
+
+    ssize_t sent;
+    do
+    {
+        sent = sendto(_fd, request.data(), request.size(), 0,
+                      reinterpret_cast<sockaddr*>(&kernel), sizeof(kernel));
+    } while (sent < 0 && errno == EINTR);
+
+    if (sent < 0)
+    {
+        throw std::system_error(errno, std::system_category(),
+                                "Couldn't send sock_diag request");
+    }
+
+    while (true)
+    {
+        ssize_t bytes = recv(_fd, _buffer.data(), _buffer.size(), 0);
+        if (bytes < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw std::system_error(errno, std::system_category(),
+                                    "Couldn't receive sock_diag response");
+        }
+
+        auto header = reinterpret_cast<const nlmsghdr*>(_buffer.data());
+        auto len    = static_cast<unsigned>(bytes);
+        for (; NLMSG_OK(header, len); header = NLMSG_NEXT(header, len))
+        {
+            if (header->nlmsg_type == NLMSG_DONE)
+            {
+                return;
+            }
+
+            if (header->nlmsg_type == NLMSG_ERROR)
+            {
+                auto error = static_cast<const nlmsgerr*>(NLMSG_DATA(header));
+                throw std::system_error(-error->error, std::system_category(),
+                                        "sock_diag request failed");
+            }
+
+            handler(*header);
+        }
+    }
+}
+
+void dump_inet(uint8_t family, uint8_t protocol,
+               const net_socket_query& query, uint8_t extensions,
+               const inet_handler& handler)
+{
+    auto request = build_request(family, protocol, query, extensions);
+
+    diag_socket sock;
+    sock.dump(request, [&](const nlmsghdr& header) {
+        if (header.nlmsg_len < NLMSG_LENGTH(sizeof(inet_diag_msg)))
+        {
+            return; // Truncated
+        }
+
+        auto msg = static_cast<const inet_diag_msg*>(
+            NLMSG_DATA(const_cast<nlmsghdr*>(&header)));
+
+        // The bytecode can't check uids
+        if (!query.uids.empty() &&
+            std::find(query.uids.begin(), query.uids.end(), msg->idiag_uid) ==
+                query.uids.end())
+        {
+            return;
+        }
+
+        handler(*msg, header);
+    });
+}
+
+void dump_unix(const unix_socket_query& query, const unix_handler& handler)
+{
+    size_t size = NLMSG_SPACE(sizeof(unix_diag_req));
+
+    std::vector<char> request(size, 0);
+
+    auto header         = reinterpret_cast<nlmsghdr*>(request.data());
+    header->nlmsg_len   = static_cast<uint32_t>(size);
+    header->nlmsg_type  = SOCK_DIAG_BY_FAMILY;
+    header->nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+
+    auto req            = static_cast<unix_diag_req*>(NLMSG_DATA(header));
+    req->sdiag_family   = AF_UNIX;
+    req->udiag_states   = to_states_mask(query.states);
+    req->udiag_show     = UDIAG_SHOW_NAME;
+    req->udiag_cookie[0] = INET_DIAG_NOCOOKIE;
+    req->udiag_cookie[1] = INET_DIAG_NOCOOKIE;
+
+    if (query.show_peer)
+    {
+        req->udiag_show |= UDIAG_SHOW_PEER | UDIAG_SHOW_ICONS;
+    }
+    if (query.show_rqlen)
+    {
+        req->udiag_show |= UDIAG_SHOW_RQLEN;
+    }
+    if (query.show_vfs)
+    {
+        req->udiag_show |= UDIAG_SHOW_VFS;
+    }
+
+    diag_socket sock;
+    sock.dump(request, [&handler](const nlmsghdr& header) {
+        if (header.nlmsg_len < NLMSG_LENGTH(sizeof(unix_diag_msg)))
+        {
+            return; // Truncated
+        }
+
+        auto msg = static_cast<const unix_diag_msg*>(
+            NLMSG_DATA(const_cast<nlmsghdr*>(&header)));
+        handler(*msg, header);
+    });
+}
+
+const rtattr* find_attribute(const nlmsghdr& header, size_t header_size,
+                             unsigned short type)
+{
+    auto msg  = reinterpret_cast<const char*>(NLMSG_DATA(&header));
+    auto attr = reinterpret_cast<const rtattr*>(msg + NLMSG_ALIGN(header_size));
+    int len   = static_cast<int>(header.nlmsg_len) -
+              static_cast<int>(NLMSG_LENGTH(NLMSG_ALIGN(header_size)));
+
+    for (; RTA_OK(attr, len); attr = RTA_NEXT(attr, len))
+    {
+        if (attr->rta_type == type)
+        {
+            return attr;
+        }
+    }
+
+    return nullptr;
+}
+
+size_t read_tcp_info(const nlmsghdr& header, tcp_info& info)
+{
+    std::memset(&info, 0, sizeof(info));
+
+    auto attr = find_attribute(header, sizeof(inet_diag_msg), INET_DIAG_INFO);
+    if (!attr)
+    {
+        return 0;
+    }
+
+    size_t length = RTA_PAYLOAD(attr);
+    std::memcpy(&info, RTA_DATA(const_cast<rtattr*>(attr)),
+                std::min(length, sizeof(info)));
+    return length;
+}
+
+std::vector<char> build_inet_bytecode(const net_socket_query& query)
+{
+    std::vector<bc_group> groups;
+    for (auto group : {make_port_group(query.local_ports, true),
+                       make_port_group(query.remote_ports, false),
+                       make_address_group(query.local_ips, true),
+                       make_address_group(query.remote_ips, false)})
+    {
+        if (!group.empty())
+        {
+            groups.push_back(std::move(group));
+        }
+    }
+
+    // Every alternative is followed by a jump to the end of its group,
+    // since 'yes' offsets are limited to a single byte, and the kernel
+    // verifies the bytecode by following the 'yes' offsets.
+    static const size_t JMP_SIZE = sizeof(inet_diag_bc_op);
+
+    auto alternative_size = [](const bc_alternative& alternative) {
+        size_t size = JMP_SIZE;
+        for (const auto& block : alternative)
+        {
+            size += block.size();
+        }
+        return size;
+    };
+
+    size_t total = 0;
+    for (const auto& group : groups)
+    {
+        for (const auto& alternative : group)
+        {
+            total += alternative_size(alternative);
+        }
+    }
+
+    // Jumping exactly to the end accepts the socket, and jumping 4 bytes
+    // past it rejects the socket.
+    std::vector<char> bytecode(total);
+
+    auto emit = [&bytecode](size_t pos, uint8_t code, size_t yes, size_t no) {
+        inet_diag_bc_op op;
+        op.code = code;
+        op.yes  = static_cast<uint8_t>(yes);
+        op.no   = static_cast<uint16_t>(no);
+        memcpy(&bytecode[pos], &op, sizeof(op));
+    };
+
+    size_t pos = 0;
+    for (const auto& group : groups)
+    {
+        size_t group_end = pos;
+        for (const auto& alternative : group)
+        {
+            group_end += alternative_size(alternative);
+        }
+
+        for (size_t a = 0; a < group.size(); ++a)
+        {
+            const auto& alternative = group[a];
+            size_t alternative_end  = pos + alternative_size(alternative);
+            bool last_alternative   = (a + 1 == group.size());
+
+            for (const auto& block : alternative)
+            {
+                size_t no = last_alternative ? (total + 4 - pos)
+                                             : (alternative_end - pos);
+                emit(pos, block.code, block.size(), no);
+                memcpy(&bytecode[pos + sizeof(inet_diag_bc_op)],
+                       block.operands.data(), block.operands.size());
+                pos += block.size();
+            }
+
+            emit(pos, INET_DIAG_BC_JMP, JMP_SIZE, group_end - pos);
+            pos += JMP_SIZE;
+        }
+    }
+
+    return bytecode;
+}
+
+net_socket to_net_socket(const inet_diag_msg& msg)
+{
+    static const long TICKS_PER_SEC = sysconf(_SC_CLK_TCK);
+    static const size_t MS_PER_SEC  = 1000;
+
+    net_socket sock;
+
+    if (msg.idiag_family == AF_INET)
+    {
+        sock.local_ip  = ip(static_cast<ipv4>(msg.id.idiag_src[0]));
+        sock.remote_ip = ip(static_cast<ipv4>(msg.id.idiag_dst[0]));
+    }
+    else
+    {
+        ipv6 src;
+        ipv6 dst;
+        std::copy(msg.id.idiag_src, msg.id.idiag_src + src.size(), src.begin());
+        std::copy(msg.id.idiag_dst, msg.id.idiag_dst + dst.size(), dst.begin());
+        sock.local_ip  = ip(src);
+        sock.remote_ip = ip(dst);
+    }
+
+    sock.local_port  = ntohs(msg.id.idiag_sport);
+    sock.remote_port = ntohs(msg.id.idiag_dport);
+
+    sock.socket_net_state = static_cast<net_socket::net_state>(msg.idiag_state);
+
+    // For listening sockets, the write queue holds the maximal backlog
+    bool listening = (sock.socket_net_state == net_socket::net_state::listen);
+    sock.tx_queue  = listening ? 0 : msg.idiag_wqueue;
+    sock.rx_queue  = msg.idiag_rqueue;
+
+    sock.timer_active = static_cast<net_socket::timer>(msg.idiag_timer);
+    sock.timer_expire_jiffies =
+        static_cast<size_t>(msg.idiag_expires) * TICKS_PER_SEC / MS_PER_SEC;
+    sock.retransmits = msg.idiag_retrans;
+    sock.uid         = msg.idiag_uid;
+    sock.inode       = msg.idiag_inode;
+
+    // Not reported by sock_diag
+    sock.slot      = 0;
+    sock.timeouts  = 0;
+    sock.ref_count = 0;
+    sock.skbuff    = 0;
+
+    return sock;
+}
+
+unix_socket to_unix_socket(const unix_diag_msg& msg, const nlmsghdr& header)
+{
+    // Hint: See 'unix_seq_show @ af_unix.c'
+    static const int SO_ACCEPTCON = (1 << 16);
+    static const char ABSTRACT_PREFIX = '@';
+
+    unix_socket sock;
+
+    sock.socket_type = static_cast<unix_socket::type>(msg.udiag_type);
+    sock.inode       = msg.udiag_ino;
+
+    switch (static_cast<net_socket::net_state>(msg.udiag_state))
+    {
+        case net_socket::net_state::established:
+            sock.socket_state = unix_socket::state::connected;
+            sock.flags        = 0;
+            break;
+
+        case net_socket::net_state::syn_sent:
+            sock.socket_state = unix_socket::state::connecting;
+            sock.flags        = 0;
+            break;
+
+        case net_socket::net_state::listen:
+            sock.socket_state = unix_socket::state::unconnected;
+            sock.flags        = SO_ACCEPTCON;
+            break;
+
+        default:
+            sock.socket_state = unix_socket::state::unconnected;
+            sock.flags        = 0;
+            break;
+    }
+
+    // Not reported by sock_diag
+    sock.skbuff    = 0;
+    sock.ref_count = 0;
+    sock.protocol  = 0;
+
+    static const size_t MSG_SIZE = sizeof(unix_diag_msg);
+
+    auto name = find_attribute(header, MSG_SIZE, UNIX_DIAG_NAME);
+    if (name)
+    {
+        auto data = static_cast<const char*>(RTA_DATA(const_cast<rtattr*>(name)));
+        size_t len = RTA_PAYLOAD(name);
+
+        if (len > 0 && data[0] != '\0')
+        {
+            // Filesystem paths are null-terminated
+            sock.path.assign(data, strnlen(data, len));
+        }
+        else
+        {
+            // Abstract names are shown with '@' instead of null bytes,
+            // same as in the text file.
+            sock.path.assign(data, len);
+            std::replace(sock.path.begin(), sock.path.end(), '\0',
+                         ABSTRACT_PREFIX);
+        }
+    }
+
+    auto peer = get_payload<uint32_t>(
+        find_attribute(header, MSG_SIZE, UNIX_DIAG_PEER));
+    if (peer)
+    {
+        sock.peer_inode = *peer;
+    }
+
+    auto icons = find_attribute(header, MSG_SIZE, UNIX_DIAG_ICONS);
+    if (icons)
+    {
+        auto data  = static_cast<const uint32_t*>(
+            RTA_DATA(const_cast<rtattr*>(icons)));
+        size_t count = RTA_PAYLOAD(icons) / sizeof(uint32_t);
+        sock.pending_connections.assign(data, data + count);
+    }
+
+    auto rqlen = get_payload<unix_diag_rqlen>(
+        find_attribute(header, MSG_SIZE, UNIX_DIAG_RQLEN));
+    if (rqlen)
+    {
+        sock.rqueue = rqlen->udiag_rqueue;
+        sock.wqueue = rqlen->udiag_wqueue;
+    }
+
+    auto vfs = get_payload<unix_diag_vfs>(
+        find_attribute(header, MSG_SIZE, UNIX_DIAG_VFS));
+    if (vfs)
+    {
+        sock.vfs_inode  = vfs->udiag_vfs_ino;
+        sock.vfs_device = to_device(vfs->udiag_vfs_dev);
+    }
+
+    return sock;
+}
+
+} // namespace sock_diag
+} // namespace impl
+} // namespace pfs
@@ -0,0 +1,242 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <stdexcept>
+
+#include "pfs/socket_snapshot.hpp"
+#include "pfs/utils.hpp"
+
+namespace pfs {
+
+const uint32_t socket_snapshot::NONE;
+
+namespace {
+
+using impl::utils::hash_address;
+using impl::utils::mix_hash;
+
+uint64_t hash_local(const ip& local_ip, uint16_t local_port)
+{
+    return hash_address(0, local_ip, local_port);
+}
+
+uint64_t hash_tuple(const ip& local_ip, uint16_t local_port,
+                    const ip& remote_ip, uint16_t remote_port)
+{
+    return hash_address(hash_local(local_ip, local_port), remote_ip,
+                        remote_port);
+}
+
+// Keep the load factor at 50% at most, so probe sequences stay short and
+// there is always an empty slot to stop at
+std::vector<uint32_t> make_index(size_t count)
+{
+    size_t size = 1;
+    while (size < count * 2)
+    {
+        size <<= 1;
+    }
+    return std::vector<uint32_t>(size, UINT32_MAX);
+}
+
+// Return the position of the slot that holds a matching socket, or of the
+// empty slot where it should be inserted.
+template <typename Equals>
+size_t probe(const std::vector<uint32_t>& index, uint64_t hash, Equals equals)
+{
+    size_t mask = index.size() - 1;
+    size_t pos  = hash & mask;
+    while (index[pos] != UINT32_MAX && !equals(index[pos]))
+    {
+        pos = (pos + 1) & mask;
+    }
+    return pos;
+}
+
+ip wildcard(const ip& addr)
+{
+    return addr.is_v4() ? ip(ipv4(0)) : ip(ipv6{{0, 0, 0, 0}});
+}
+
+} // anonymous namespace
+
+socket_snapshot::socket_snapshot(std::vector<net_socket> sockets,
+                                 std::vector<unix_socket> unix_sockets)
+    : _sockets(std::move(sockets)), _unix_sockets(std::move(unix_sockets)),
+      _by_inode(make_index(_sockets.size())),
+      _by_unix_inode(make_index(_unix_sockets.size())),
+      _by_local(make_index(_sockets.size())),
+      _by_tuple(make_index(_sockets.size())),
+      _next_local(_sockets.size(), NONE)
+{
+    if (_sockets.size() >= NONE || _unix_sockets.size() >= NONE)
+    {
+        throw std::length_error("Too many sockets for a snapshot");
+    }
+
+    // The first socket wins every conflict, so insert in reverse order, and
+    // chain the sockets that share a local address in their original order
+    for (size_t i = _sockets.size(); i-- > 0;)
+    {
+        const auto& sock = _sockets[i];
+        auto index       = static_cast<uint32_t>(i);
+
+        if (sock.inode != 0)
+        {
+            auto pos = probe(_by_inode, mix_hash(sock.inode), [&](uint32_t other) {
+                return _sockets[other].inode == sock.inode;
+            });
+            _by_inode[pos] = index;
+        }
+
+        auto pos = probe(_by_local, hash_local(sock.local_ip, sock.local_port),
+                         [&](uint32_t other) {
+                             return _sockets[other].local_ip == sock.local_ip &&
+                                    _sockets[other].local_port ==
+                                        sock.local_port;
+                         });
+        _next_local[i] = _by_local[pos];
+        _by_local[pos] = index;
+
+        pos = probe(_by_tuple,
+                    hash_tuple(sock.local_ip, sock.local_port, sock.remote_ip,
+                               sock.remote_port),
+                    [&](uint32_t other) {
+                        const auto& rhs = _sockets[other];
+                        return rhs.local_ip == sock.local_ip &&
+                               rhs.local_port == sock.local_port &&
+                               rhs.remote_ip == sock.remote_ip &&
+                               rhs.remote_port == sock.remote_port;
+                    });
+        _by_tuple[pos] = index;
+    }
+
+    for (size_t i = _unix_sockets.size(); i-- > 0;)
+    {
+        const auto& sock = _unix_sockets[i];
+        auto pos         = probe(_by_unix_inode, mix_hash(sock.inode),
+                                 [&](uint32_t other) {
+                             return _unix_sockets[other].inode == sock.inode;
+                         });
+        _by_unix_inode[pos] = static_cast<uint32_t>(i);
+    }
+}
+
+socket_snapshot::socket_snapshot(socket_snapshot&& other)
+    : socket_snapshot(std::vector<net_socket>())
+{
+    // The indexes of an empty snapshot still have an empty slot to stop at,
+    // unlike moved-from vectors
+    _sockets.swap(other._sockets);
+    _unix_sockets.swap(other._unix_sockets);
+    _by_inode.swap(other._by_inode);
+    _by_unix_inode.swap(other._by_unix_inode);
+    _by_local.swap(other._by_local);
+    _by_tuple.swap(other._by_tuple);
+    _next_local.swap(other._next_local);
+}
+
+const std::vector<net_socket>& socket_snapshot::sockets() const
+{
+    return _sockets;
+}
+
+const std::vector<unix_socket>& socket_snapshot::unix_sockets() const
+{
+    return _unix_sockets;
+}
+
+const net_socket* socket_snapshot::find_by_inode(ino_t inode) const
+{
+    if (inode == 0)
+    {
+        return nullptr;
+    }
+
+    auto pos = probe(_by_inode, mix_hash(inode), [&](uint32_t index) {
+        return _sockets[index].inode == inode;
+    });
+    auto index = _by_inode[pos];
+    return (index != NONE) ? &_sockets[index] : nullptr;
+}
+
+const unix_socket* socket_snapshot::find_unix_by_inode(ino_t inode) const
+{
+    auto pos = probe(_by_unix_inode, mix_hash(inode), [&](uint32_t index) {
+        return _unix_sockets[index].inode == inode;
+    });
+    auto index = _by_unix_inode[pos];
+    return (index != NONE) ? &_unix_sockets[index] : nullptr;
+}
+
+uint32_t socket_snapshot::find_local(const ip& local_ip,
+                                     uint16_t local_port) const
+{
+    auto pos = probe(_by_local, hash_local(local_ip, local_port),
+                     [&](uint32_t index) {
+                         return _sockets[index].local_ip == local_ip &&
+                                _sockets[index].local_port == local_port;
+                     });
+    return _by_local[pos];
+}
+
+const net_socket* socket_snapshot::find_by_local(const ip& local_ip,
+                                                 uint16_t local_port) const
+{
+    auto index = find_local(local_ip, local_port);
+    if (index == NONE)
+    {
+        index = find_local(wildcard(local_ip), local_port);
+    }
+    return (index != NONE) ? &_sockets[index] : nullptr;
+}
+
+size_t socket_snapshot::for_each_local(const ip& local_ip, uint16_t local_port,
+        const std::function<void(const net_socket&)>& handler) const
+{
+    size_t count = 0;
+    for (auto index = find_local(local_ip, local_port); index != NONE;
+         index      = _next_local[index])
+    {
+        if (handler)
+        {
+            handler(_sockets[index]);
+        }
+        ++count;
+    }
+    return count;
+}
+
+const net_socket* socket_snapshot::find_by_tuple(const ip& local_ip,
+                                                 uint16_t local_port,
+                                                 const ip& remote_ip,
+                                                 uint16_t remote_port) const
+{
+    auto pos = probe(_by_tuple,
+                     hash_tuple(local_ip, local_port, remote_ip, remote_port),
+                     [&](uint32_t index) {
+                         const auto& sock = _sockets[index];
+                         return sock.local_ip == local_ip &&
+                                sock.local_port == local_port &&
+                                sock.remote_ip == remote_ip &&
+                                sock.remote_port == remote_port;
+                     });
+    auto index = _by_tuple[pos];
+    return (index != NONE) ? &_sockets[index] : nullptr;
+}
+
+} // namespace pfs
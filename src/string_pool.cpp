@@ -0,0 +1,96 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <limits>
+#include <stdexcept>
+
+#include "pfs/string_pool.hpp"
+
+namespace pfs {
+
+const string_pool::id_type string_pool::EMPTY_ID;
+
+string_pool::string_pool()
+{
+    _strings.emplace_back();
+}
+
+uint64_t string_pool::hash(const char* data, size_t size)
+{
+    // FNV-1a
+    static const uint64_t OFFSET_BASIS = 14695981039346656037ULL;
+    static const uint64_t PRIME        = 1099511628211ULL;
+
+    uint64_t h = OFFSET_BASIS;
+    for (size_t i = 0; i < size; ++i)
+    {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= PRIME;
+    }
+    return h;
+}
+
+string_pool::id_type string_pool::intern(const char* data, size_t size)
+{
+    if (size == 0)
+    {
+        return EMPTY_ID;
+    }
+
+    uint64_t h = hash(data, size);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto range = _ids.equal_range(h);
+    for (auto iter = range.first; iter != range.second; ++iter)
+    {
+        const auto& str = _strings[iter->second];
+        if (str.size() == size && str.compare(0, size, data, size) == 0)
+        {
+            return iter->second;
+        }
+    }
+
+    if (_strings.size() > std::numeric_limits<id_type>::max())
+    {
+        throw std::length_error("String pool is full");
+    }
+
+    auto id = static_cast<id_type>(_strings.size());
+    _strings.emplace_back(data, size);
+    _ids.emplace(h, id);
+    return id;
+}
+
+string_pool::id_type string_pool::intern(const std::string& str)
+{
+    return intern(str.data(), str.size());
+}
+
+const std::string& string_pool::get(id_type id) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _strings.at(id);
+}
+
+size_t string_pool::size() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _strings.size();
+}
+
+} // namespace pfs
@@ -23,16 +23,23 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <system_error>
 
 #include "pfs/defer.hpp"
 #include "pfs/parsers/cgroup.hpp"
+#include "pfs/parsers/fd_link.hpp"
+#include "pfs/parsers/fdinfo.hpp"
 #include "pfs/parsers/maps.hpp"
 #include "pfs/parsers/mountinfo.hpp"
+#include "pfs/parsers/numa_maps.hpp"
 #include "pfs/parsers/lines.hpp"
 #include "pfs/parsers/common.hpp"
+#include "pfs/parsers/smaps.hpp"
 #include "pfs/parsers/task_io.hpp"
 #include "pfs/parsers/task_status.hpp"
 #include "pfs/task.hpp"
@@ -155,6 +162,46 @@ io_stats task::get_io() const {
     return parsers::task_io_parser().parse(path);
 }
 
+std::vector<smaps_region> task::get_smaps() const
+{
+    static const std::string SMAPS_FILE("smaps");
+    auto path = _task_root + SMAPS_FILE;
+
+    std::ifstream in(path);
+    if (!in)
+    {
+        throw std::system_error(errno, std::system_category(),
+                                "Couldn't open file");
+    }
+
+    std::vector<smaps_region> output;
+
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (line.empty())
+        {
+            continue;
+        }
+
+        if (parsers::is_smaps_header_line(line))
+        {
+            output.emplace_back();
+            output.back().region = parsers::parse_maps_line(line);
+            continue;
+        }
+
+        if (output.empty())
+        {
+            throw parser_error("Corrupted smaps - Value without region", line);
+        }
+
+        parsers::parse_smaps_value_line(line, output.back());
+    }
+
+    return output;
+}
+
 task_stat task::get_stat() const
 {
     static const std::string STAT_FILE("stat");
@@ -350,6 +397,20 @@ std::vector<mem_region> task::get_maps() const
     return output;
 }
 
+std::vector<compact_mem_region> task::get_maps(string_pool& pool) const
+{
+    static const std::string MAPS_FILE("maps");
+    auto path = _task_root + MAPS_FILE;
+
+    auto parser = [&pool](const std::string& line) {
+        return parsers::parse_compact_maps_line(line, pool);
+    };
+
+    std::vector<compact_mem_region> output;
+    parsers::parse_file_lines(path, std::back_inserter(output), parser);
+    return output;
+}
+
 mem task::get_mem() const
 {
     static const std::string MEM_FILE("mem");
@@ -385,7 +446,7 @@ std::unordered_map<int, fd> task::get_fds() const
     std::unordered_map<int, fd> fds;
     for (const auto& num : utils::enumerate_numeric_files(path))
     {
-        fds.emplace(num, fd(path, num));
+        fds.emplace(num, fd(_task_root, num));
     }
 
     return fds;
@@ -403,6 +464,102 @@ std::set<ino_t> task::get_fds_inodes() const
     return inodes;
 }
 
+fd_table task::get_fd_table() const
+{
+    static const std::string FDS_DIR("fd/");
+    auto path = _task_root + FDS_DIR;
+
+    int dirfd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirfd == -1)
+    {
+        throw std::system_error(errno, std::system_category(),
+                                "Couldn't open fds directory");
+    }
+    defer close_dirfd([dirfd] { close(dirfd); });
+
+    fd_table table;
+    char link[PATH_MAX];
+
+    utils::iterate_files(dirfd, /* include_dots */ false, [&](const char* name) {
+        ssize_t bytes = readlinkat(dirfd, name, link, sizeof(link));
+        if (bytes < 0)
+        {
+            return; // Closed in the meantime
+        }
+
+        fd_entry entry;
+        utils::parse_number(name, name + strlen(name), entry.num);
+        entry.kind          = parsers::parse_fd_link(link, bytes, entry.inode);
+        entry.target_offset = table.targets.size();
+        entry.target_size   = bytes;
+
+        table.targets.append(link, bytes);
+        table.entries.push_back(entry);
+    });
+
+    std::sort(table.entries.begin(), table.entries.end(),
+              [](const fd_entry& lhs, const fd_entry& rhs) {
+                  return lhs.num < rhs.num;
+              });
+
+    return table;
+}
+
+std::unordered_map<int, fd_info> task::get_fdinfo() const
+{
+    static const std::string FDINFO_DIR("fdinfo/");
+    auto path = _task_root + FDINFO_DIR;
+
+    int dirfd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirfd == -1)
+    {
+        throw std::system_error(errno, std::system_category(),
+                                "Couldn't open fdinfo directory");
+    }
+    defer close_dirfd([dirfd] { close(dirfd); });
+
+    parsers::fdinfo_parser parser;
+    std::string buffer;
+
+    std::unordered_map<int, fd_info> output;
+
+    utils::iterate_files(dirfd, /* include_dots */ false, [&](const char* name) {
+        try
+        {
+            utils::readfile(name, buffer, dirfd);
+        }
+        catch (const std::system_error& ex)
+        {
+            if (ex.code().value() == ENOENT)
+            {
+                return; // Closed in the meantime
+            }
+            throw;
+        }
+
+        int num;
+        utils::parse_number(name, name + strlen(name), num);
+
+        std::istringstream in(buffer);
+        output.emplace(num, parser.parse(in));
+    });
+
+    return output;
+}
+
+pagemap task::get_pagemap() const
+{
+    static const std::string PAGEMAP_FILE("pagemap");
+    auto path = _task_root + PAGEMAP_FILE;
+
+    return pagemap(path);
+}
+
+std::vector<pagemap_entry> task::get_pagemap(const mem_region& region) const
+{
+    return get_pagemap().read(region);
+}
+
 net task::get_net() const
 {
     return net(_task_root);
@@ -440,6 +597,71 @@ std::unordered_map<std::string, ino_t> task::get_ns() const
     return ns;
 }
 
+std::vector<numa_region> task::get_numa_maps() const
+{
+    static const std::string NUMA_MAPS_FILE("numa_maps");
+    auto path = _task_root + NUMA_MAPS_FILE;
+
+    std::vector<numa_region> output;
+    parsers::parse_file_lines(path, std::back_inserter(output),
+                              parsers::parse_numa_maps_line);
+    return output;
+}
+
+std::vector<std::pair<mem_region, numa_region>>
+task::get_maps_with_numa() const
+{
+    auto maps      = get_maps();
+    auto numa_maps = get_numa_maps();
+
+    std::vector<std::pair<mem_region, numa_region>> output;
+    output.reserve(std::min(maps.size(), numa_maps.size()));
+
+    // Both are sorted by the start address
+    auto numa_iter = numa_maps.begin();
+    for (auto& region : maps)
+    {
+        while (numa_iter != numa_maps.end() &&
+               numa_iter->start_address < region.start_address)
+        {
+            ++numa_iter;
+        }
+
+        if (numa_iter == numa_maps.end())
+        {
+            break;
+        }
+
+        if (numa_iter->start_address == region.start_address)
+        {
+            output.emplace_back(std::move(region), std::move(*numa_iter));
+            ++numa_iter;
+        }
+    }
+
+    return output;
+}
+
+std::vector<size_t> task::get_numa_usage() const
+{
+    std::vector<size_t> output;
+
+    for (const auto& region : get_numa_maps())
+    {
+        if (region.node_pages.size() > output.size())
+        {
+            output.resize(region.node_pages.size(), 0);
+        }
+
+        for (size_t node = 0; node < region.node_pages.size(); ++node)
+        {
+            output[node] += region.node_pages[node] * region.page_size_kb;
+        }
+    }
+
+    return output;
+}
+
 task task::get_task(int id) const
 {
     static const std::string TASKS_DIR("task/");
@@ -489,4 +711,26 @@ std::vector<id_map> task::get_gid_map() const
     return output;
 }
 
+void task::clear_refs(clear_refs_mode mode) const
+{
+    static const std::string CLEAR_REFS_FILE("clear_refs");
+    auto path = _task_root + CLEAR_REFS_FILE;
+
+    int fd = open(path.c_str(), O_WRONLY);
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::system_category(),
+                                "Couldn't open file");
+    }
+    defer close_fd([fd] { close(fd); });
+
+    auto value = std::to_string(static_cast<int>(mode));
+    if (write(fd, value.c_str(), value.size()) !=
+        static_cast<ssize_t>(value.size()))
+    {
+        throw std::system_error(errno, std::system_category(),
+                                "Couldn't write clear_refs");
+    }
+}
+
 } // namespace pfs
@@ -0,0 +1,358 @@
+/*
+ *  Copyright 2020-present Daniel Trugman
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <iterator>
+
+#include "pfs/tcp_churn.hpp"
+#include "pfs/utils.hpp"
+
+namespace pfs {
+
+const size_t tcp_churn_tracker::STATES;
+
+namespace {
+
+using impl::utils::hash_address;
+
+static const size_t INITIAL_CAPACITY = 1024;
+
+// The inode isn't hashed, as it changes to 0 once the socket is orphaned
+uint64_t hash_connection(const ip& local_ip, uint16_t local_port,
+                         const ip& remote_ip, uint16_t remote_port)
+{
+    return hash_address(hash_address(0, local_ip, local_port), remote_ip,
+                        remote_port);
+}
+
+} // anonymous namespace
+
+size_t tcp_churn_tracker::ip_hash::operator()(const ip& addr) const
+{
+    return hash_address(0, addr, 0);
+}
+
+tcp_churn_tracker::tcp_churn_tracker()
+    : _entries(INITIAL_CAPACITY), _size(0), _generation(0), _baseline(true),
+      _states()
+{}
+
+void tcp_churn_tracker::update(const std::vector<net_socket>& sockets,
+                               const event_handler& handler)
+{
+    begin();
+    for (const auto& socket : sockets)
+    {
+        add(socket, handler);
+    }
+    end(handler);
+}
+
+void tcp_churn_tracker::update(const net_socket_table& table,
+                               const event_handler& handler)
+{
+    begin();
+    for (size_t i = 0; i < table.size(); ++i)
+    {
+        add(table.local_ip[i], table.local_port[i], table.remote_ip[i],
+            table.remote_port[i], table.inode[i], table.socket_net_state[i],
+            handler);
+    }
+    end(handler);
+}
+
+void tcp_churn_tracker::begin()
+{
+    ++_generation;
+}
+
+void tcp_churn_tracker::add(const net_socket& socket,
+                            const event_handler& handler)
+{
+    add(socket.local_ip, socket.local_port, socket.remote_ip,
+        socket.remote_port, socket.inode, socket.socket_net_state, handler);
+}
+
+void tcp_churn_tracker::add(const ip& local_ip, uint16_t local_port,
+                            const ip& remote_ip, uint16_t remote_port,
+                            ino_t inode, net_socket::net_state state,
+                            const event_handler& handler)
+{
+    // Keep the load factor at 50% at most
+    if ((_size + 1) * 2 > _entries.size())
+    {
+        grow();
+    }
+
+    uint64_t hash = hash_connection(local_ip, local_port, remote_ip,
+                                    remote_port);
+    auto& e = _entries[find(local_ip, local_port, remote_ip, remote_port,
+                            inode, hash)];
+
+    if (!e.used)
+    {
+        e.hash        = hash;
+        e.local_ip    = local_ip;
+        e.local_port  = local_port;
+        e.remote_ip   = remote_ip;
+        e.remote_port = remote_port;
+        e.inode       = inode;
+        e.state       = state;
+        e.generation  = _generation;
+        e.used        = true;
+        ++_size;
+
+        on_opened(e, handler);
+        return;
+    }
+
+    if (e.generation == _generation)
+    {
+        return; // Already seen in this snapshot
+    }
+    e.generation = _generation;
+
+    // An orphaned connection keeps the inode it was seen with
+    if (e.state == state)
+    {
+        return;
+    }
+
+    auto previous_state = e.state;
+    --_states[static_cast<size_t>(e.state)];
+    e.state = state;
+    ++_states[static_cast<size_t>(e.state)];
+
+    if (handler)
+    {
+        auto event = make_event(tcp_churn_event::type::state_changed, e);
+        event.previous_state = previous_state;
+        handler(event);
+    }
+}
+
+void tcp_churn_tracker::end(const event_handler& handler)
+{
+    // Erasing shifts the following entries back, so the same position is
+    // checked again. Entries that wrap around were already checked.
+    for (size_t pos = 0; pos < _entries.size();)
+    {
+        auto& e = _entries[pos];
+        if (e.used && e.generation != _generation)
+        {
+            on_closed(e, handler);
+            erase(pos);
+            continue;
+        }
+        ++pos;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    double seconds =
+        std::chrono::duration<double>(now - _last_end).count();
+
+    for (auto it = _remotes.begin(); it != _remotes.end();)
+    {
+        auto& remote = it->second;
+
+        if (!_baseline && seconds > 0)
+        {
+            remote.open_rate  = remote.recently_opened / seconds;
+            remote.close_rate = remote.recently_closed / seconds;
+        }
+
+        bool active = remote.connections || remote.recently_opened ||
+                      remote.recently_closed;
+        remote.recently_opened = 0;
+        remote.recently_closed = 0;
+
+        it = active ? std::next(it) : _remotes.erase(it);
+    }
+
+    _baseline = false;
+    _last_end = now;
+}
+
+size_t tcp_churn_tracker::count(net_socket::net_state state) const
+{
+    return _states.at(static_cast<size_t>(state));
+}
+
+size_t tcp_churn_tracker::size() const
+{
+    return _size;
+}
+
+std::vector<tcp_remote_churn> tcp_churn_tracker::get_remote_churn() const
+{
+    std::vector<tcp_remote_churn> output;
+    output.reserve(_remotes.size());
+
+    for (const auto& remote : _remotes)
+    {
+        tcp_remote_churn churn;
+        churn.remote_ip   = remote.first;
+        churn.connections = remote.second.connections;
+        churn.opened      = remote.second.opened;
+        churn.closed      = remote.second.closed;
+        churn.open_rate   = remote.second.open_rate;
+        churn.close_rate  = remote.second.close_rate;
+        output.push_back(churn);
+    }
+
+    return output;
+}
+
+size_t tcp_churn_tracker::find(const ip& local_ip, uint16_t local_port,
+                               const ip& remote_ip, uint16_t remote_port,
+                               ino_t inode, uint64_t hash) const
+{
+    size_t mask     = _entries.size() - 1;
+    size_t orphaned = _entries.size();
+
+    for (size_t pos = hash & mask;; pos = (pos + 1) & mask)
+    {
+        const auto& e = _entries[pos];
+        if (!e.used)
+        {
+            return (orphaned != _entries.size()) ? orphaned : pos;
+        }
+
+        bool same_tuple = e.hash == hash && e.local_port == local_port &&
+                          e.remote_port == remote_port &&
+                          e.local_ip == local_ip && e.remote_ip == remote_ip;
+        if (!same_tuple)
+        {
+            continue;
+        }
+
+        if (e.inode == inode)
+        {
+            return pos;
+        }
+
+        // Once closed, a socket is orphaned and reported with inode 0 (e.g.
+        // in FIN_WAIT2 or TIME_WAIT), but it's still the same connection.
+        // Different non-zero inodes are different connections (e.g. a new
+        // connection that reused the 4-tuple, or SO_REUSEPORT listeners).
+        if (inode == 0 && e.generation != _generation &&
+            orphaned == _entries.size())
+        {
+            orphaned = pos;
+        }
+    }
+}
+
+// Hint: Backward shift deletion, so no tombstones are needed
+void tcp_churn_tracker::erase(size_t pos)
+{
+    size_t mask = _entries.size() - 1;
+    size_t hole = pos;
+
+    for (size_t next = (pos + 1) & mask; _entries[next].used;
+         next        = (next + 1) & mask)
+    {
+        // An entry can't move before its home slot
+        size_t home = _entries[next].hash & mask;
+        bool stays  = (hole <= next) ? (hole < home && home <= next)
+                                     : (hole < home || home <= next);
+        if (!stays)
+        {
+            _entries[hole] = _entries[next];
+            hole           = next;
+        }
+    }
+
+    _entries[hole].used = false;
+    --_size;
+}
+
+void tcp_churn_tracker::grow()
+{
+    std::vector<entry> entries(_entries.size() * 2);
+    size_t mask = entries.size() - 1;
+
+    for (const auto& e : _entries)
+    {
+        if (!e.used)
+        {
+            continue;
+        }
+
+        size_t pos = e.hash & mask;
+        while (entries[pos].used)
+        {
+            pos = (pos + 1) & mask;
+        }
+        entries[pos] = e;
+    }
+
+    _entries.swap(entries);
+}
+
+void tcp_churn_tracker::on_opened(const entry& e, const event_handler& handler)
+{
+    ++_states[static_cast<size_t>(e.state)];
+
+    auto& remote = _remotes[e.remote_ip];
+    ++remote.connections;
+
+    // Everything in the first snapshot was opened before tracking started
+    if (_baseline)
+    {
+        return;
+    }
+
+    ++remote.opened;
+    ++remote.recently_opened;
+
+    if (handler)
+    {
+        handler(make_event(tcp_churn_event::type::opened, e));
+    }
+}
+
+void tcp_churn_tracker::on_closed(const entry& e, const event_handler& handler)
+{
+    --_states[static_cast<size_t>(e.state)];
+
+    auto& remote = _remotes[e.remote_ip];
+    --remote.connections;
+    ++remote.closed;
+    ++remote.recently_closed;
+
+    if (handler)
+    {
+        handler(make_event(tcp_churn_event::type::closed, e));
+    }
+}
+
+tcp_churn_event tcp_churn_tracker::make_event(tcp_churn_event::type type,
+                                              const entry& e)
+{
+    tcp_churn_event event;
+    event.event_type     = type;
+    event.local_ip       = e.local_ip;
+    event.local_port     = e.local_port;
+    event.remote_ip      = e.remote_ip;
+    event.remote_port    = e.remote_port;
+    event.inode          = e.inode;
+    event.state          = e.state;
+    event.previous_state = e.state;
+    return event;
+}
+
+} // namespace pfs
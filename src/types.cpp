@@ -17,6 +17,9 @@
 #include <arpa/inet.h>
 #include <sys/socket.h>
 
+#include <algorithm>
+#include <cmath>
+
 #include "pfs/types.hpp"
 
 namespace pfs {
@@ -53,6 +56,82 @@ bool signal_mask::operator==(const signal_mask& rhs) const
     return raw == rhs.raw;
 }
 
+// =============================================================
+// Pagemap entry
+// =============================================================
+
+namespace {
+
+enum pagemap_bit
+{
+    PAGEMAP_BIT_SOFT_DIRTY     = 55,
+    PAGEMAP_BIT_EXCLUSIVE      = 56,
+    PAGEMAP_BIT_FILE_OR_SHARED = 61,
+    PAGEMAP_BIT_SWAPPED        = 62,
+    PAGEMAP_BIT_PRESENT        = 63,
+};
+
+static const uint64_t PAGEMAP_PFN_MASK       = (1ULL << 55) - 1;
+static const unsigned PAGEMAP_SWAP_TYPE_BITS = 5;
+static const uint64_t PAGEMAP_SWAP_TYPE_MASK =
+    (1ULL << PAGEMAP_SWAP_TYPE_BITS) - 1;
+
+bool is_bit_set(uint64_t raw, pagemap_bit bit)
+{
+    return (raw >> bit) & 1;
+}
+
+} // anonymous namespace
+
+pagemap_entry::pagemap_entry(raw_type raw) : raw(raw) {}
+
+bool pagemap_entry::is_present() const
+{
+    return is_bit_set(raw, PAGEMAP_BIT_PRESENT);
+}
+
+bool pagemap_entry::is_swapped() const
+{
+    return is_bit_set(raw, PAGEMAP_BIT_SWAPPED);
+}
+
+bool pagemap_entry::is_file_or_shared_anon() const
+{
+    return is_bit_set(raw, PAGEMAP_BIT_FILE_OR_SHARED);
+}
+
+bool pagemap_entry::is_exclusive() const
+{
+    return is_bit_set(raw, PAGEMAP_BIT_EXCLUSIVE);
+}
+
+bool pagemap_entry::is_soft_dirty() const
+{
+    return is_bit_set(raw, PAGEMAP_BIT_SOFT_DIRTY);
+}
+
+uint64_t pagemap_entry::pfn() const
+{
+    return is_present() ? (raw & PAGEMAP_PFN_MASK) : 0;
+}
+
+unsigned pagemap_entry::swap_type() const
+{
+    return is_swapped() ? static_cast<unsigned>(raw & PAGEMAP_SWAP_TYPE_MASK)
+                        : 0;
+}
+
+uint64_t pagemap_entry::swap_offset() const
+{
+    return is_swapped() ? (raw & PAGEMAP_PFN_MASK) >> PAGEMAP_SWAP_TYPE_BITS
+                        : 0;
+}
+
+bool pagemap_entry::operator==(const pagemap_entry& rhs) const
+{
+    return raw == rhs.raw;
+}
+
 // =============================================================
 // IP
 // =============================================================
@@ -80,4 +159,448 @@ std::string ip::to_string() const
     return std::string(buff);
 }
 
+// =============================================================
+// Net socket table
+// =============================================================
+
+size_t net_socket_table::size() const
+{
+    return inode.size();
+}
+
+bool net_socket_table::empty() const
+{
+    return inode.empty();
+}
+
+void net_socket_table::clear()
+{
+    slot.clear();
+    local_ip.clear();
+    local_port.clear();
+    remote_ip.clear();
+    remote_port.clear();
+    socket_net_state.clear();
+    tx_queue.clear();
+    rx_queue.clear();
+    timer_active.clear();
+    timer_expire_jiffies.clear();
+    retransmits.clear();
+    uid.clear();
+    timeouts.clear();
+    inode.clear();
+    ref_count.clear();
+    skbuff.clear();
+}
+
+void net_socket_table::reserve(size_t count)
+{
+    slot.reserve(count);
+    local_ip.reserve(count);
+    local_port.reserve(count);
+    remote_ip.reserve(count);
+    remote_port.reserve(count);
+    socket_net_state.reserve(count);
+    tx_queue.reserve(count);
+    rx_queue.reserve(count);
+    timer_active.reserve(count);
+    timer_expire_jiffies.reserve(count);
+    retransmits.reserve(count);
+    uid.reserve(count);
+    timeouts.reserve(count);
+    inode.reserve(count);
+    ref_count.reserve(count);
+    skbuff.reserve(count);
+}
+
+void net_socket_table::push_back(const net_socket& socket)
+{
+    slot.push_back(socket.slot);
+    local_ip.push_back(socket.local_ip);
+    local_port.push_back(socket.local_port);
+    remote_ip.push_back(socket.remote_ip);
+    remote_port.push_back(socket.remote_port);
+    socket_net_state.push_back(socket.socket_net_state);
+    tx_queue.push_back(socket.tx_queue);
+    rx_queue.push_back(socket.rx_queue);
+    timer_active.push_back(socket.timer_active);
+    timer_expire_jiffies.push_back(socket.timer_expire_jiffies);
+    retransmits.push_back(socket.retransmits);
+    uid.push_back(socket.uid);
+    timeouts.push_back(socket.timeouts);
+    inode.push_back(socket.inode);
+    ref_count.push_back(socket.ref_count);
+    skbuff.push_back(socket.skbuff);
+}
+
+net_socket net_socket_table::at(size_t index) const
+{
+    net_socket socket;
+    socket.slot                 = slot.at(index);
+    socket.local_ip             = local_ip.at(index);
+    socket.local_port           = local_port.at(index);
+    socket.remote_ip            = remote_ip.at(index);
+    socket.remote_port          = remote_port.at(index);
+    socket.socket_net_state     = socket_net_state.at(index);
+    socket.tx_queue             = tx_queue.at(index);
+    socket.rx_queue             = rx_queue.at(index);
+    socket.timer_active         = timer_active.at(index);
+    socket.timer_expire_jiffies = timer_expire_jiffies.at(index);
+    socket.retransmits          = retransmits.at(index);
+    socket.uid                  = uid.at(index);
+    socket.timeouts             = timeouts.at(index);
+    socket.inode                = inode.at(index);
+    socket.ref_count            = ref_count.at(index);
+    socket.skbuff               = skbuff.at(index);
+    return socket;
+}
+
+// =============================================================
+// Net socket query
+// =============================================================
+
+namespace {
+
+template <typename T>
+bool matches_any(const std::vector<T>& values, const T& value)
+{
+    return values.empty() ||
+           std::find(values.begin(), values.end(), value) != values.end();
+}
+
+} // anonymous namespace
+
+bool net_socket_query::empty() const
+{
+    return states.empty() && local_ports.empty() && remote_ports.empty() &&
+           local_ips.empty() && remote_ips.empty() && uids.empty();
+}
+
+bool net_socket_query::matches(const net_socket& socket) const
+{
+    return (states.empty() || states.count(socket.socket_net_state)) &&
+           matches_any(local_ports, socket.local_port) &&
+           matches_any(remote_ports, socket.remote_port) &&
+           matches_any(local_ips, socket.local_ip) &&
+           matches_any(remote_ips, socket.remote_ip) &&
+           matches_any(uids, socket.uid);
+}
+
+// =============================================================
+// Unix socket query
+// =============================================================
+
+bool unix_socket_query::matches(const unix_socket& socket) const
+{
+    // Hint: See 'unix_seq_show @ af_unix.c'
+    static const int SO_ACCEPTCON = (1 << 16);
+
+    if (states.empty())
+    {
+        return true;
+    }
+
+    net_socket::net_state state;
+    if (socket.flags & SO_ACCEPTCON)
+    {
+        state = net_socket::net_state::listen;
+    }
+    else if (socket.socket_state == unix_socket::state::connected)
+    {
+        state = net_socket::net_state::established;
+    }
+    else if (socket.socket_state == unix_socket::state::connecting)
+    {
+        state = net_socket::net_state::syn_sent;
+    }
+    else
+    {
+        state = net_socket::net_state::close;
+    }
+
+    return states.count(state) != 0;
+}
+
+// =============================================================
+// Log2 histogram
+// =============================================================
+
+const size_t log2_histogram::BUCKETS;
+
+namespace {
+
+size_t to_bucket(uint64_t value)
+{
+    static const size_t BITS = 64;
+    return value ? BITS - __builtin_clzll(value) : 0;
+}
+
+uint64_t bucket_upper_bound(size_t bucket)
+{
+    static const size_t BITS = 64;
+    return bucket < BITS ? (1ULL << bucket) - 1 : UINT64_MAX;
+}
+
+} // anonymous namespace
+
+void log2_histogram::add(uint64_t value)
+{
+    ++buckets[to_bucket(value)];
+    ++count;
+    sum += value;
+    min = std::min(min, value);
+    max = std::max(max, value);
+}
+
+uint64_t log2_histogram::mean() const
+{
+    return count ? sum / count : 0;
+}
+
+uint64_t log2_histogram::percentile(double p) const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    auto rank = static_cast<uint64_t>(std::ceil(p / 100 * count));
+    rank      = std::max<uint64_t>(rank, 1);
+
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKETS; ++bucket)
+    {
+        seen += buckets[bucket];
+        if (seen >= rank)
+        {
+            return std::max(min, std::min(max, bucket_upper_bound(bucket)));
+        }
+    }
+
+    return max;
+}
+
+// =============================================================
+// Net stats sample
+// =============================================================
+
+net_stats_rates
+net_stats_sample::rates_since(const net_stats_sample& previous) const
+{
+    net_stats_rates rates;
+
+    double seconds = std::chrono::duration<double>(time - previous.time).count();
+    if (seconds <= 0)
+    {
+        return rates;
+    }
+
+    auto rate = [seconds](uint64_t before, uint64_t after) {
+        return (after > before) ? (after - before) / seconds : 0;
+    };
+
+    const auto& snmp_before    = previous.snmp;
+    const auto& netstat_before = previous.netstat;
+
+    rates.tcp_in_segs = rate(snmp_before.tcp_in_segs, snmp.tcp_in_segs);
+    rates.tcp_out_segs = rate(snmp_before.tcp_out_segs, snmp.tcp_out_segs);
+    rates.tcp_retrans_segs =
+        rate(snmp_before.tcp_retrans_segs, snmp.tcp_retrans_segs);
+    rates.tcp_retrans_ratio =
+        rates.tcp_out_segs ? rates.tcp_retrans_segs / rates.tcp_out_segs : 0;
+    rates.tcp_attempt_fails =
+        rate(snmp_before.tcp_attempt_fails, snmp.tcp_attempt_fails);
+    rates.tcp_estab_resets =
+        rate(snmp_before.tcp_estab_resets, snmp.tcp_estab_resets);
+    rates.tcp_out_rsts = rate(snmp_before.tcp_out_rsts, snmp.tcp_out_rsts);
+    rates.tcp_in_errs  = rate(snmp_before.tcp_in_errs, snmp.tcp_in_errs);
+    rates.tcp_timeouts =
+        rate(netstat_before.tcp_timeouts, netstat.tcp_timeouts);
+
+    rates.listen_overflows =
+        rate(netstat_before.listen_overflows, netstat.listen_overflows);
+    rates.listen_drops = rate(netstat_before.listen_drops, netstat.listen_drops);
+
+    rates.syncookies_sent =
+        rate(netstat_before.syncookies_sent, netstat.syncookies_sent);
+    rates.syncookies_recv =
+        rate(netstat_before.syncookies_recv, netstat.syncookies_recv);
+    rates.syncookies_failed =
+        rate(netstat_before.syncookies_failed, netstat.syncookies_failed);
+
+    rates.tcp_memory_pressures = rate(netstat_before.tcp_memory_pressures,
+                                      netstat.tcp_memory_pressures);
+    rates.tcp_abort_on_memory =
+        rate(netstat_before.tcp_abort_on_memory, netstat.tcp_abort_on_memory);
+    rates.prune_called = rate(netstat_before.prune_called, netstat.prune_called);
+
+    rates.udp_in_errors = rate(snmp_before.udp_in_errors, snmp.udp_in_errors);
+    rates.udp_rcvbuf_errors =
+        rate(snmp_before.udp_rcvbuf_errors, snmp.udp_rcvbuf_errors);
+    rates.udp_no_ports = rate(snmp_before.udp_no_ports, snmp.udp_no_ports);
+
+    rates.ip_in_discards =
+        rate(snmp_before.ip_in_discards, snmp.ip_in_discards);
+    rates.ip_out_discards =
+        rate(snmp_before.ip_out_discards, snmp.ip_out_discards);
+
+    return rates;
+}
+
+// =============================================================
+// Net softnet sample
+// =============================================================
+
+std::vector<net_softnet_rates>
+net_softnet_sample::rates_since(const net_softnet_sample& previous) const
+{
+    std::vector<net_softnet_rates> output;
+
+    double seconds = std::chrono::duration<double>(time - previous.time).count();
+    if (seconds <= 0)
+    {
+        return output;
+    }
+
+    // The counters are 32-bit, so the unsigned difference survives a wrap
+    auto rate = [seconds](uint32_t before, uint32_t after) {
+        return static_cast<uint32_t>(after - before) / seconds;
+    };
+
+    output.reserve(cpus.size());
+    for (size_t i = 0; i < cpus.size(); ++i)
+    {
+        const auto& after = cpus[i];
+
+        // CPUs are usually at the same position in both samples
+        auto before = previous.cpus.end();
+        if (i < previous.cpus.size() && previous.cpus[i].cpu == after.cpu)
+        {
+            before = previous.cpus.begin() + i;
+        }
+        else
+        {
+            before = std::find_if(previous.cpus.begin(), previous.cpus.end(),
+                                  [&after](const net_softnet_stat& stat) {
+                                      return stat.cpu == after.cpu;
+                                  });
+        }
+
+        if (before == previous.cpus.end())
+        {
+            continue; // CPU went online between the samples
+        }
+
+        net_softnet_rates rates;
+        rates.cpu          = after.cpu;
+        rates.processed    = rate(before->processed, after.processed);
+        rates.dropped      = rate(before->dropped, after.dropped);
+        rates.time_squeeze = rate(before->time_squeeze, after.time_squeeze);
+        rates.received_rps = rate(before->received_rps, after.received_rps);
+        rates.flow_limit_count =
+            rate(before->flow_limit_count, after.flow_limit_count);
+        output.push_back(rates);
+    }
+
+    return output;
+}
+
+// =============================================================
+// IRQ matrix
+// =============================================================
+
+std::vector<irq_delta>
+irq_matrix::deltas_since(const irq_matrix& previous) const
+{
+    std::vector<irq_delta> output;
+    deltas_since(previous, output);
+    return output;
+}
+
+void irq_matrix::deltas_since(const irq_matrix& previous,
+                              std::vector<irq_delta>& out) const
+{
+    out.clear();
+
+    // The columns of the previous matrix, by the column of this one.
+    // Only needed if CPUs went offline or online between the matrices.
+    static const size_t MISSING = static_cast<size_t>(-1);
+    std::vector<size_t> columns;
+    bool same_columns = (cpus == previous.cpus);
+    if (!same_columns)
+    {
+        columns.resize(cpus.size(), MISSING);
+        for (size_t i = 0; i < cpus.size(); ++i)
+        {
+            auto iter = std::find(previous.cpus.begin(), previous.cpus.end(),
+                                  cpus[i]);
+            if (iter != previous.cpus.end())
+            {
+                columns[i] = static_cast<size_t>(iter - previous.cpus.begin());
+            }
+        }
+    }
+
+    for (size_t i = 0; i < rows(); ++i)
+    {
+        // Rows are usually at the same position in both matrices
+        size_t before = i;
+        if (i >= previous.rows() || previous.names[i] != names[i])
+        {
+            auto iter = std::find(previous.names.begin(), previous.names.end(),
+                                  names[i]);
+            if (iter == previous.names.end())
+            {
+                continue; // Registered between the matrices
+            }
+            before = static_cast<size_t>(iter - previous.names.begin());
+        }
+
+        const uint64_t* after_row  = row(i);
+        const uint64_t* before_row = previous.row(before);
+
+        irq_delta delta;
+        delta.row           = i;
+        delta.total         = 0;
+        delta.top_cpu       = -1;
+        delta.top_count     = 0;
+        delta.concentration = 0;
+
+        for (size_t column = 0; column < cpus.size(); ++column)
+        {
+            size_t previous_column = same_columns ? column : columns[column];
+            if (previous_column == MISSING)
+            {
+                continue;
+            }
+
+            // The counters are 32-bit, so the unsigned difference survives
+            // a wrap
+            uint64_t count = static_cast<uint32_t>(
+                after_row[column] - before_row[previous_column]);
+
+            delta.total += count;
+            if (count > delta.top_count)
+            {
+                delta.top_cpu   = cpus[column];
+                delta.top_count = count;
+            }
+        }
+
+        if (delta.total == 0)
+        {
+            continue;
+        }
+
+        delta.concentration = static_cast<double>(delta.top_count) /
+                              static_cast<double>(delta.total);
+        out.push_back(delta);
+    }
+
+    std::stable_sort(out.begin(), out.end(),
+                     [](const irq_delta& lhs, const irq_delta& rhs) {
+                         return lhs.total > rhs.total;
+                     });
+}
+
 } // namespace pfs
@@ -18,12 +18,18 @@
 #include <linux/limits.h>
 #include <stddef.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
 #include <fstream>
+#include <mutex>
 #include <system_error>
+#include <thread>
 
 #include "pfs/defer.hpp"
 #include "pfs/utils.hpp"
@@ -34,6 +40,84 @@ namespace pfs {
 namespace impl {
 namespace utils {
 
+const char* parse_number(const char* begin, const char* end,
+                         unsigned long long& out, base b)
+{
+    static const unsigned long long MAX =
+        std::numeric_limits<unsigned long long>::max();
+
+    const auto radix = static_cast<unsigned>(b);
+
+    unsigned long long value = 0;
+
+    const char* curr = begin;
+    for (; curr != end; ++curr)
+    {
+        unsigned digit;
+        char c = *curr;
+        if (c >= '0' && c <= '9')
+        {
+            digit = c - '0';
+        }
+        else if (c >= 'a' && c <= 'f')
+        {
+            digit = c - 'a' + 10;
+        }
+        else if (c >= 'A' && c <= 'F')
+        {
+            digit = c - 'A' + 10;
+        }
+        else
+        {
+            break;
+        }
+
+        if (digit >= radix)
+        {
+            break;
+        }
+
+        if (value > (MAX - digit) / radix)
+        {
+            throw std::out_of_range("Number is out of range");
+        }
+
+        value = value * radix + digit;
+    }
+
+    if (curr == begin)
+    {
+        throw std::invalid_argument("No digits to parse");
+    }
+
+    out = value;
+    return curr;
+}
+
+bool equals(const char* begin, const char* end, const char* str)
+{
+    size_t len = static_cast<size_t>(end - begin);
+    return strlen(str) == len && memcmp(begin, str, len) == 0;
+}
+
+const char* skip_spaces(const char* begin, const char* end)
+{
+    while (begin != end && std::isspace(static_cast<unsigned char>(*begin)))
+    {
+        ++begin;
+    }
+    return begin;
+}
+
+const char* find_space(const char* begin, const char* end)
+{
+    while (begin != end && !std::isspace(static_cast<unsigned char>(*begin)))
+    {
+        ++begin;
+    }
+    return begin;
+}
+
 size_t iterate_files(const std::string& dir, bool include_dots,
                      std::function<void(const char*)> handle)
 {
@@ -70,6 +154,62 @@ size_t iterate_files(const std::string& dir, bool include_dots,
     return count;
 }
 
+size_t iterate_files(int dirfd, bool include_dots,
+                     const std::function<void(const char*)>& handle)
+{
+    static const char DOTFILE_PREFIX = '.';
+    static const size_t BUFFER_SIZE  = 32 * 1024;
+
+    // The kernel's 'struct linux_dirent64', which isn't exported by any header
+    struct linux_dirent64
+    {
+        uint64_t d_ino;
+        int64_t d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[1]; // Actually null-terminated, of any length
+    };
+
+    alignas(linux_dirent64) char buffer[BUFFER_SIZE];
+
+    size_t count = 0;
+
+    while (true)
+    {
+        long bytes = syscall(SYS_getdents64, dirfd, buffer, sizeof(buffer));
+        if (bytes < 0)
+        {
+            throw std::system_error(errno, std::system_category(),
+                                    "Couldn't read dir");
+        }
+
+        if (bytes == 0)
+        {
+            break;
+        }
+
+        for (long offset = 0; offset < bytes;)
+        {
+            auto entry = reinterpret_cast<linux_dirent64*>(buffer + offset);
+            offset += entry->d_reclen;
+
+            if (entry->d_name[0] == DOTFILE_PREFIX && !include_dots)
+            {
+                continue;
+            }
+
+            ++count;
+
+            if (handle)
+            {
+                handle(entry->d_name);
+            }
+        }
+    }
+
+    return count;
+}
+
 size_t count_files(const std::string& dir, bool include_dots)
 {
     return iterate_files(dir, include_dots, nullptr);
@@ -163,6 +303,50 @@ std::string readfile(const std::string& file, size_t max_bytes,
     return buffer;
 }
 
+void readfile(const std::string& file, std::string& buffer, int dirfd)
+{
+    static const size_t MIN_READ = 4096;
+
+    int fd = openat(dirfd, file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::system_category(),
+                                "Couldn't open file");
+    }
+    defer close_fd([fd] { close(fd); });
+
+    buffer.resize(std::max(buffer.capacity(), MIN_READ));
+
+    size_t total = 0;
+    while (true)
+    {
+        if (total == buffer.size())
+        {
+            buffer.resize(buffer.size() * 2);
+        }
+
+        ssize_t bytes = read(fd, &buffer[total], buffer.size() - total);
+        if (bytes < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw std::system_error(errno, std::system_category(),
+                                    "Couldn't read file");
+        }
+
+        if (bytes == 0)
+        {
+            break;
+        }
+
+        total += bytes;
+    }
+
+    buffer.resize(total);
+}
+
 std::string readline(const std::string& file)
 {
     std::ifstream in(file);
@@ -260,6 +444,118 @@ void ensure_dir_terminator(std::string& dir_path)
     }
 }
 
+void parallel_for(size_t count, size_t workers,
+                  const std::function<void(size_t)>& func)
+{
+    if (workers == 0)
+    {
+        workers = std::max(1U, std::thread::hardware_concurrency());
+    }
+    workers = std::min(workers, count);
+
+    std::atomic<size_t> next(0);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto work = [&] {
+        for (size_t i = next++; i < count; i = next++)
+        {
+            try
+            {
+                func(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers);
+
+    // The calling thread is one of the workers
+    for (size_t i = 1; i < workers; ++i)
+    {
+        threads.emplace_back(work);
+    }
+    work();
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+uint64_t mix_hash(uint64_t value)
+{
+    // The finalizer of splitmix64
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value;
+}
+
+uint64_t hash_address(uint64_t seed, const ip& addr, uint16_t port)
+{
+    uint64_t hash =
+        mix_hash(seed ^ (static_cast<uint64_t>(addr.domain) << 16) ^ port);
+    for (auto word : addr.storage)
+    {
+        hash = mix_hash(hash ^ word);
+    }
+    return hash;
+}
+
+namespace {
+
+static const size_t HEX_WORD_LEN = 8;
+
+// Parse a word of exactly HEX_WORD_LEN hex digits
+uint32_t parse_hex_word(const char* begin, const char* end)
+{
+    if (static_cast<size_t>(end - begin) < HEX_WORD_LEN)
+    {
+        throw std::invalid_argument("Hex word is too short");
+    }
+
+    uint32_t word;
+    if (parse_number(begin, begin + HEX_WORD_LEN, word, base::hex) !=
+        begin + HEX_WORD_LEN)
+    {
+        throw std::invalid_argument("Hex word has invalid digits");
+    }
+    return word;
+}
+
+ip parse_ipv4_address(const char* begin, const char* end)
+{
+    return ip(static_cast<ipv4>(parse_hex_word(begin, end)));
+}
+
+ip parse_ipv6_address(const char* begin, const char* end)
+{
+    ipv6 raw;
+    for (size_t i = 0; i < raw.size(); ++i)
+    {
+        raw[i] = parse_hex_word(begin + i * HEX_WORD_LEN, end);
+    }
+    return ip(raw);
+}
+
+} // anonymous namespace
+
 ip parse_ipv4_address(const std::string& ip_address_str)
 {
     ipv4 raw;
@@ -269,60 +565,60 @@ ip parse_ipv4_address(const std::string& ip_address_str)
 
 ip parse_ipv6_address(const std::string& ip_address_str)
 {
-    static const size_t HEX_BYTE_LEN = 8;
-
-    ipv6 raw;
-
-    for (size_t i = 0; i < raw.size(); ++i)
+    if (ip_address_str.size() < std::tuple_size<ipv6>::value * HEX_WORD_LEN)
     {
-        auto nibble = ip_address_str.substr(i * HEX_BYTE_LEN, HEX_BYTE_LEN);
-        utils::stot(nibble, raw[i], utils::base::hex);
+        throw std::invalid_argument("IPv6 address is too short");
     }
 
-    return ip(raw);
+    const char* begin = ip_address_str.data();
+    return parse_ipv6_address(begin, begin + ip_address_str.size());
 }
 
 std::pair<ip, uint16_t> parse_address(const std::string& address_str)
 {
-    enum token
+    const char* begin = address_str.data();
+    const char* end   = begin + address_str.size();
+
+    std::pair<ip, uint16_t> address;
+    if (parse_address(begin, end, address.first, address.second) != end)
     {
-        IP   = 0,
-        PORT = 1,
-        COUNT
-    };
+        throw parser_error(
+            "Corrupted net socket address - Unexpected token counts",
+            address_str);
+    }
 
-    static const size_t HEX_BYTE_LEN = 8;
+    return address;
+}
 
+const char* parse_address(const char* begin, const char* end, ip& addr,
+                          uint16_t& port)
+{
     static const char DELIM = ':';
 
-    auto tokens = utils::split(address_str, DELIM);
-    if (tokens.size() != COUNT)
+    const char* delim = std::find(begin, end, DELIM);
+    if (delim == end)
     {
         throw parser_error(
             "Corrupted net socket address - Unexpected token counts",
-            address_str);
+            std::string(begin, end));
     }
 
-    ip addr;
-    auto& ip_str = tokens[IP];
-    if (ip_str.size() == HEX_BYTE_LEN)
+    size_t length = delim - begin;
+    if (length == HEX_WORD_LEN)
     {
-        addr = utils::parse_ipv4_address(ip_str);
+        addr = parse_ipv4_address(begin, delim);
     }
-    else if (ip_str.size() == std::tuple_size<ipv6>::value * HEX_BYTE_LEN)
+    else if (length == std::tuple_size<ipv6>::value * HEX_WORD_LEN)
     {
-        addr = utils::parse_ipv6_address(ip_str);
+        addr = parse_ipv6_address(begin, delim);
     }
     else
     {
         throw parser_error("Corrupted net socket address - Bad length",
-                           address_str);
+                           std::string(begin, end));
     }
 
-    uint16_t port;
-    utils::stot(tokens[PORT], port, utils::base::hex);
-
-    return std::make_pair(addr, port);
+    return parse_number(delim + 1, end, port, base::hex);
 }
 
 } // namespace utils
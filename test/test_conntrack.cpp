@@ -0,0 +1,221 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <string>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+#include "pfs/parsers/conntrack.hpp"
+#include "pfs/parser_error.hpp"
+#include "pfs/procfs.hpp"
+
+using namespace pfs::impl::parsers;
+
+namespace {
+
+pfs::ip make_ipv4(const std::string& str)
+{
+    in_addr addr;
+    REQUIRE(inet_pton(AF_INET, str.c_str(), &addr) == 1);
+    return pfs::ip(static_cast<pfs::ipv4>(addr.s_addr));
+}
+
+void parse(const std::string& line, pfs::conntrack_entry& entry)
+{
+    parse_conntrack_line(line.data(), line.data() + line.size(), entry);
+}
+
+static const std::string TCP_LINE =
+    "ipv4     2 tcp      6 431999 ESTABLISHED src=10.0.0.2 dst=10.0.0.1 "
+    "sport=40000 dport=80 packets=3 bytes=180 src=10.0.0.1 dst=10.0.0.2 "
+    "sport=80 dport=40000 packets=2 bytes=112 [ASSURED] mark=7 zone=3 use=2";
+
+static const std::string UDP_LINE =
+    "ipv4     2 udp      17 28 src=10.0.1.2 dst=8.8.8.8 sport=53000 dport=53 "
+    "[UNREPLIED] src=8.8.8.8 dst=10.0.1.2 sport=53 dport=53000 mark=0 use=2";
+
+static const std::string ICMPV6_LINE =
+    "ipv6     10 icmpv6   58 29 src=fd00::2 dst=fd00::1 type=128 code=0 id=7 "
+    "src=fd00::1 dst=fd00::2 type=129 code=0 id=7 mark=0 use=2";
+
+static const std::string GRE_LINE =
+    "ipv4     2 gre      47 179 timeout=180, stream_timeout=18000 "
+    "src=10.0.2.2 dst=10.0.2.1 srckey=0x0 dstkey=0x0 src=10.0.2.1 "
+    "dst=10.0.2.2 srckey=0x0 dstkey=0x0 [ASSURED] mark=0 use=2";
+
+} // anonymous namespace
+
+TEST_CASE("Parse conntrack line", "[net][conntrack]")
+{
+    pfs::conntrack_entry entry;
+
+    SECTION("TCP")
+    {
+        parse(TCP_LINE, entry);
+
+        REQUIRE(entry.family == AF_INET);
+        REQUIRE(entry.protocol == IPPROTO_TCP);
+        REQUIRE(entry.conn_state == pfs::conntrack_entry::state::established);
+        REQUIRE(entry.timeout == 431999);
+        REQUIRE(entry.original.src == make_ipv4("10.0.0.2"));
+        REQUIRE(entry.original.dst == make_ipv4("10.0.0.1"));
+        REQUIRE(entry.original.src_port == 40000);
+        REQUIRE(entry.original.dst_port == 80);
+        REQUIRE(entry.reply.src == make_ipv4("10.0.0.1"));
+        REQUIRE(entry.reply.dst_port == 40000);
+        REQUIRE(entry.has_counters);
+        REQUIRE(entry.original_packets == 3);
+        REQUIRE(entry.original_bytes == 180);
+        REQUIRE(entry.reply_packets == 2);
+        REQUIRE(entry.reply_bytes == 112);
+        REQUIRE(entry.assured);
+        REQUIRE_FALSE(entry.unreplied);
+        REQUIRE(entry.mark == 7);
+        REQUIRE(entry.zone == 3);
+    }
+
+    SECTION("UDP reuses the entry")
+    {
+        parse(TCP_LINE, entry);
+        parse(UDP_LINE, entry);
+
+        REQUIRE(entry.protocol == IPPROTO_UDP);
+        REQUIRE(entry.conn_state == pfs::conntrack_entry::state::none);
+        REQUIRE(entry.timeout == 28);
+        REQUIRE(entry.original.dst == make_ipv4("8.8.8.8"));
+        REQUIRE(entry.original.dst_port == 53);
+        REQUIRE_FALSE(entry.has_counters);
+        REQUIRE_FALSE(entry.assured);
+        REQUIRE(entry.unreplied);
+        REQUIRE(entry.mark == 0);
+        REQUIRE(entry.zone == 0);
+    }
+
+    SECTION("ICMPv6")
+    {
+        parse(ICMPV6_LINE, entry);
+
+        pfs::ipv6 expected;
+        REQUIRE(inet_pton(AF_INET6, "fd00::2", expected.data()) == 1);
+
+        REQUIRE(entry.family == AF_INET6);
+        REQUIRE(entry.protocol == IPPROTO_ICMPV6);
+        REQUIRE(entry.original.src == pfs::ip(expected));
+        REQUIRE(entry.original.src_port == 0);
+        REQUIRE(entry.reply.dst == pfs::ip(expected));
+    }
+
+    SECTION("GRE")
+    {
+        parse(GRE_LINE, entry);
+
+        REQUIRE(entry.protocol == IPPROTO_GRE);
+        REQUIRE(entry.timeout == 179);
+        REQUIRE(entry.conn_state == pfs::conntrack_entry::state::none);
+        REQUIRE(entry.original.src == make_ipv4("10.0.2.2"));
+        REQUIRE(entry.original.dst == make_ipv4("10.0.2.1"));
+        REQUIRE(entry.original.src_port == 0);
+        REQUIRE(entry.reply.src == make_ipv4("10.0.2.1"));
+        REQUIRE(entry.assured);
+    }
+
+    SECTION("SCTP state")
+    {
+        parse("ipv4     2 sctp     132 10 COOKIE_WAIT src=10.0.0.1 "
+              "dst=10.0.0.2 sport=5000 dport=6000 src=10.0.0.2 dst=10.0.0.1 "
+              "sport=6000 dport=5000 mark=0 use=1",
+              entry);
+        REQUIRE(entry.conn_state == pfs::conntrack_entry::state::other);
+    }
+
+    SECTION("Corrupted")
+    {
+        // Missing the reply tuple
+        REQUIRE_THROWS_AS(parse("ipv4     2 udp      17 28 src=10.0.1.2 "
+                                "dst=8.8.8.8 sport=53000 dport=53",
+                                entry),
+                          pfs::parser_error);
+
+        // No tuples at all
+        REQUIRE_THROWS_AS(parse("ipv4     2 udp      17 28 mark=0 use=2", entry),
+                          pfs::parser_error);
+
+        // Invalid address
+        REQUIRE_THROWS_AS(parse("ipv4     2 udp      17 28 src=10.0.1 "
+                                "dst=8.8.8.8 src=8.8.8.8 dst=10.0.1.2",
+                                entry),
+                          pfs::parser_error);
+
+        // Invalid port
+        REQUIRE_THROWS_AS(parse("ipv4     2 udp      17 28 src=10.0.1.2 "
+                                "dst=8.8.8.8 sport=70000 src=8.8.8.8 "
+                                "dst=10.0.1.2",
+                                entry),
+                          pfs::parser_error);
+
+        // Truncated header
+        REQUIRE_THROWS_AS(parse("ipv4     2 udp", entry), pfs::parser_error);
+    }
+}
+
+TEST_CASE("Summarize conntrack table", "[net][conntrack]")
+{
+    static const int TASK_ID = 1;
+
+    temp_dir dir;
+    dir.create_file("1/net/nf_conntrack",
+                    TCP_LINE + "\n" + UDP_LINE + "\n" + UDP_LINE + "\n" +
+                        ICMPV6_LINE + "\n");
+
+    auto net = pfs::procfs(dir.get_root()).get_net(TASK_ID);
+
+    size_t count = 0;
+    net.for_each_conntrack([&count](const pfs::conntrack_entry&) { ++count; });
+    REQUIRE(count == 4);
+
+    pfs::conntrack_summary_options options;
+
+    SECTION("By state")
+    {
+        auto summary = net.get_conntrack_summary(options);
+        REQUIRE(summary.size() == 3);
+
+        REQUIRE(summary[0].protocol == IPPROTO_UDP);
+        REQUIRE(summary[0].entries == 2);
+        REQUIRE(summary[0].unreplied == 2);
+
+        REQUIRE(summary[1].protocol == IPPROTO_TCP);
+        REQUIRE(summary[1].conn_state ==
+                pfs::conntrack_entry::state::established);
+        REQUIRE(summary[1].assured == 1);
+        REQUIRE(summary[1].packets == 5);
+        REQUIRE(summary[1].bytes == 292);
+    }
+
+    SECTION("By destination port")
+    {
+        options.group_by = pfs::conntrack_summary::grouping::destination_port;
+
+        auto summary = net.get_conntrack_summary(options);
+        REQUIRE(summary.size() == 3);
+        REQUIRE(summary[0].destination_port == 53);
+        REQUIRE(summary[0].entries == 2);
+        REQUIRE(summary[1].destination_port == 80);
+    }
+
+    SECTION("By source subnet")
+    {
+        options.group_by        = pfs::conntrack_summary::grouping::source_subnet;
+        options.ipv4_prefix_len = 16;
+
+        auto summary = net.get_conntrack_summary(options);
+        REQUIRE(summary.size() == 2);
+        REQUIRE(summary[0].source_subnet == make_ipv4("10.0.0.0"));
+        REQUIRE(summary[0].prefix_len == 16);
+        REQUIRE(summary[0].entries == 3);
+        REQUIRE(summary[1].source_subnet.is_v6());
+        REQUIRE(summary[1].prefix_len == 64);
+    }
+}
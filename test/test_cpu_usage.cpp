@@ -0,0 +1,169 @@
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+#include "pfs/cpu_usage.hpp"
+#include "pfs/procfs.hpp"
+
+namespace {
+
+pfs::proc_stat::cpu make_cpu(int id, unsigned long long user,
+                             unsigned long long system,
+                             unsigned long long idle)
+{
+    pfs::proc_stat::cpu cpu;
+    cpu.id     = id;
+    cpu.user   = user;
+    cpu.system = system;
+    cpu.idle   = idle;
+    return cpu;
+}
+
+pfs::proc_stat make_stat(const std::vector<pfs::proc_stat::cpu>& cpus)
+{
+    pfs::proc_stat stat;
+    for (const auto& cpu : cpus)
+    {
+        stat.cpus.total.user   += cpu.user;
+        stat.cpus.total.system += cpu.system;
+        stat.cpus.total.idle   += cpu.idle;
+    }
+    stat.cpus.per_item = cpus;
+    return stat;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Track CPU usage", "[procfs][cpu_usage]")
+{
+    pfs::cpu_usage_tracker tracker(4);
+
+    tracker.update(make_stat({make_cpu(0, 100, 100, 800),
+                              make_cpu(1, 0, 0, 1000)}));
+
+    // The first sample is a baseline
+    REQUIRE(tracker.cpus() == 2);
+    REQUIRE(tracker.total().busy == 0);
+    REQUIRE(tracker.get_total_window(&pfs::cpu_utilization::busy).samples ==
+            0);
+
+    tracker.update(make_stat({make_cpu(0, 160, 120, 820),
+                              make_cpu(1, 10, 0, 1090)}));
+
+    REQUIRE(tracker.get_cpu(0).user == Approx(60));
+    REQUIRE(tracker.get_cpu(0).system == Approx(20));
+    REQUIRE(tracker.get_cpu(0).idle == Approx(20));
+    REQUIRE(tracker.get_cpu(0).busy == Approx(80));
+    REQUIRE(tracker.get_cpu(1).busy == Approx(10));
+    REQUIRE(tracker.total().busy == Approx(45));
+    REQUIRE_THROWS_AS(tracker.get_cpu(2), std::out_of_range);
+
+    SECTION("Guest time is part of user time")
+    {
+        auto stat = make_stat({make_cpu(0, 260, 120, 820),
+                               make_cpu(1, 10, 0, 1190)});
+        stat.cpus.per_item[0].guest = 50;
+        tracker.update(stat);
+
+        REQUIRE(tracker.get_cpu(0).user == Approx(100));
+        REQUIRE(tracker.get_cpu(0).guest == Approx(50));
+        REQUIRE(tracker.get_cpu(0).busy == Approx(100));
+    }
+
+    SECTION("No time passed")
+    {
+        tracker.update(make_stat({make_cpu(0, 160, 120, 820),
+                                  make_cpu(1, 10, 0, 1090)}));
+        REQUIRE(tracker.get_cpu(0).busy == Approx(80));
+        REQUIRE(tracker.get_cpu_window(0, &pfs::cpu_utilization::busy)
+                    .samples == 1);
+    }
+
+    SECTION("Counters reset")
+    {
+        tracker.update(make_stat({make_cpu(0, 10, 10, 10),
+                                  make_cpu(1, 10, 0, 1190)}));
+        REQUIRE(tracker.get_cpu(0).busy == 0);
+        REQUIRE(tracker.get_cpu(1).busy == 0);
+
+        tracker.update(make_stat({make_cpu(0, 60, 10, 60),
+                                  make_cpu(1, 10, 0, 1290)}));
+        REQUIRE(tracker.get_cpu(0).busy == Approx(50));
+    }
+
+    SECTION("Hotplug")
+    {
+        // CPU 1 goes offline, CPU 3 shows up
+        tracker.update(make_stat({make_cpu(0, 210, 120, 870),
+                                  make_cpu(3, 0, 0, 100)}));
+        REQUIRE(tracker.cpus() == 4);
+        REQUIRE(tracker.is_online(0));
+        REQUIRE_FALSE(tracker.is_online(1));
+        REQUIRE_FALSE(tracker.is_online(2));
+        REQUIRE(tracker.is_online(3));
+        REQUIRE(tracker.get_cpu(0).busy == Approx(50));
+        REQUIRE(tracker.get_cpu(1).busy == 0);
+        REQUIRE(tracker.get_cpu(3).busy == 0);
+
+        // CPU 1 is back, with a new baseline
+        tracker.update(make_stat({make_cpu(0, 260, 120, 920),
+                                  make_cpu(1, 50, 0, 1150),
+                                  make_cpu(3, 100, 0, 100)}));
+        REQUIRE(tracker.get_cpu(1).busy == 0);
+        REQUIRE(tracker.get_cpu(3).busy == Approx(100));
+
+        // The history is kept
+        auto window =
+            tracker.get_cpu_window(0, &pfs::cpu_utilization::busy);
+        REQUIRE(window.samples == 3);
+        REQUIRE(window.max == Approx(80));
+        REQUIRE(window.min == Approx(50));
+    }
+
+    SECTION("Rolling window")
+    {
+        // Busy 20%, 40%, ..., 100%, so the first 80% is rolled out
+        unsigned long long user = 160, idle = 820, idle1 = 1090;
+        for (unsigned long long percent = 20; percent <= 100; percent += 20)
+        {
+            user  += percent;
+            idle  += 100 - percent;
+            idle1 += 100;
+            tracker.update(make_stat({make_cpu(0, user, 120, idle),
+                                      make_cpu(1, 10, 0, idle1)}));
+        }
+
+        auto window = tracker.get_cpu_window(0, &pfs::cpu_utilization::busy);
+        REQUIRE(window.samples == 4);
+        REQUIRE(window.min == Approx(40));
+        REQUIRE(window.max == Approx(100));
+        REQUIRE(window.mean == Approx(70));
+        REQUIRE(window.p95 == Approx(100));
+
+        window = tracker.get_cpu_window(0, &pfs::cpu_utilization::busy, 2);
+        REQUIRE(window.samples == 2);
+        REQUIRE(window.min == Approx(80));
+
+        window = tracker.get_cpu_window(1, &pfs::cpu_utilization::idle);
+        REQUIRE(window.samples == 4);
+        REQUIRE(window.max == Approx(100));
+    }
+}
+
+TEST_CASE("Track CPU usage of the stat file", "[procfs][cpu_usage]")
+{
+    pfs::procfs procfs;
+    pfs::proc_stat stat;
+    pfs::cpu_usage_tracker tracker;
+
+    procfs.get_stat(stat, pfs::proc_stat::section::CPUS);
+    tracker.update(stat);
+    procfs.get_stat(stat, pfs::proc_stat::section::CPUS);
+    tracker.update(stat);
+
+    REQUIRE(tracker.cpus() >= stat.cpus.per_item.size());
+    for (const auto& cpu : stat.cpus.per_item)
+    {
+        REQUIRE(tracker.is_online(cpu.id));
+        REQUIRE(tracker.get_cpu(cpu.id).busy <= 100);
+    }
+}
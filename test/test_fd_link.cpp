@@ -0,0 +1,160 @@
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+#include "pfs/defer.hpp"
+#include "pfs/parsers/fd_link.hpp"
+#include "pfs/procfs.hpp"
+
+using pfs::impl::parsers::parse_fd_link;
+
+static bool parse_socket_link(const std::string& link, ino_t& inode)
+{
+    return pfs::impl::parsers::parse_socket_link(link.data(), link.size(),
+                                                 inode);
+}
+
+TEST_CASE("Parse socket link", "[fd][socket]")
+{
+    ino_t inode = 0;
+
+    SECTION("Socket")
+    {
+        REQUIRE(parse_socket_link("socket:[12345]", inode));
+        REQUIRE(inode == 12345);
+    }
+
+    SECTION("Not a socket")
+    {
+        REQUIRE_FALSE(parse_socket_link("pipe:[12345]", inode));
+        REQUIRE_FALSE(parse_socket_link("/tmp/socket:[12345]", inode));
+        REQUIRE_FALSE(parse_socket_link("anon_inode:[eventpoll]", inode));
+    }
+
+    SECTION("Corrupted")
+    {
+        REQUIRE_FALSE(parse_socket_link("socket:[]", inode));
+        REQUIRE_FALSE(parse_socket_link("socket:[12a45]", inode));
+        REQUIRE_FALSE(parse_socket_link("socket:[12345", inode));
+    }
+}
+
+TEST_CASE("Parse fd link", "[fd]")
+{
+    struct test_case
+    {
+        std::string link;
+        pfs::fd_kind kind;
+        ino_t inode;
+    };
+
+    // clang-format off
+    std::vector<test_case> cases = {
+        { "/dev/null",               pfs::fd_kind::file,       0 },
+        { "/tmp/a b (deleted)",      pfs::fd_kind::file,       0 },
+        { "/memfd:shm (deleted)",    pfs::fd_kind::memfd,      0 },
+        { "socket:[12345]",          pfs::fd_kind::socket,     12345 },
+        { "pipe:[54321]",            pfs::fd_kind::pipe,       54321 },
+        { "net:[4026531840]",        pfs::fd_kind::ns,         4026531840 },
+        { "anon_inode:[eventpoll]",  pfs::fd_kind::eventpoll,  0 },
+        { "anon_inode:[eventfd]",    pfs::fd_kind::eventfd,    0 },
+        { "anon_inode:[timerfd]",    pfs::fd_kind::timerfd,    0 },
+        { "anon_inode:[signalfd]",   pfs::fd_kind::signalfd,   0 },
+        { "anon_inode:inotify",      pfs::fd_kind::inotify,    0 },
+        { "anon_inode:[fanotify]",   pfs::fd_kind::fanotify,   0 },
+        { "anon_inode:[pidfd]",      pfs::fd_kind::pidfd,      0 },
+        { "anon_inode:[io_uring]",   pfs::fd_kind::anon_inode, 0 },
+        { "anon_inode:bpf-map",      pfs::fd_kind::anon_inode, 0 },
+        { "pipe:[]",                 pfs::fd_kind::unknown,    0 },
+        { "garbage",                 pfs::fd_kind::unknown,    0 },
+        { "",                        pfs::fd_kind::unknown,    0 },
+    };
+    // clang-format on
+
+    for (const auto& test : cases)
+    {
+        ino_t inode = 1;
+        auto kind = parse_fd_link(test.link.data(), test.link.size(), inode);
+
+        INFO(test.link);
+        REQUIRE(kind == test.kind);
+        REQUIRE(inode == test.inode);
+    }
+}
+
+TEST_CASE("Get fd table", "[task][fd]")
+{
+    int pipefd[2];
+    REQUIRE(pipe(pipefd) == 0);
+    pfs::impl::defer close_pipe([&pipefd] {
+        close(pipefd[0]);
+        close(pipefd[1]);
+    });
+
+    int event = eventfd(0, 0);
+    REQUIRE(event >= 0);
+    pfs::impl::defer close_event([event] { close(event); });
+
+    int file = open("/dev/null", O_RDONLY);
+    REQUIRE(file >= 0);
+    pfs::impl::defer close_file([file] { close(file); });
+
+    struct stat st;
+    REQUIRE(fstat(pipefd[0], &st) == 0);
+
+    auto table = pfs::procfs().get_task().get_fd_table();
+    REQUIRE(std::is_sorted(table.entries.begin(), table.entries.end(),
+                           [](const pfs::fd_entry& lhs,
+                              const pfs::fd_entry& rhs) {
+                               return lhs.num < rhs.num;
+                           }));
+
+    auto find = [&table](int num) {
+        auto iter = std::find_if(table.entries.begin(), table.entries.end(),
+                                 [num](const pfs::fd_entry& entry) {
+                                     return entry.num == num;
+                                 });
+        REQUIRE(iter != table.entries.end());
+        return *iter;
+    };
+
+    auto read_end = find(pipefd[0]);
+    REQUIRE(read_end.kind == pfs::fd_kind::pipe);
+    REQUIRE(read_end.inode == st.st_ino);
+    REQUIRE(find(pipefd[1]).inode == st.st_ino);
+
+    REQUIRE(find(event).kind == pfs::fd_kind::eventfd);
+
+    auto null = find(file);
+    REQUIRE(null.kind == pfs::fd_kind::file);
+    REQUIRE(table.target(null) == "/dev/null");
+}
+
+TEST_CASE("Collect socket owners", "[procfs][socket]")
+{
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    REQUIRE(sock >= 0);
+    pfs::impl::defer close_sock([sock] { close(sock); });
+
+    struct stat st;
+    REQUIRE(fstat(sock, &st) == 0);
+
+    auto owners = pfs::procfs().get_socket_owners(2);
+
+    auto range = owners.equal_range(st.st_ino);
+    REQUIRE(range.first != range.second);
+
+    bool found = false;
+    for (auto iter = range.first; iter != range.second; ++iter)
+    {
+        found |= (iter->second.pid == getpid() && iter->second.fd == sock);
+    }
+    REQUIRE(found);
+}
@@ -0,0 +1,202 @@
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <sstream>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+#include "pfs/defer.hpp"
+#include "pfs/parsers/fdinfo.hpp"
+#include "pfs/parser_error.hpp"
+#include "pfs/procfs.hpp"
+
+using namespace pfs::impl::parsers;
+
+static pfs::fd_info parse_fdinfo(const std::string& content)
+{
+    std::istringstream in(content);
+    return fdinfo_parser().parse(in);
+}
+
+TEST_CASE("Parse fdinfo", "[fd][fdinfo]")
+{
+    SECTION("Regular file")
+    {
+        auto info = parse_fdinfo("pos:\t4096\n"
+                                 "flags:\t0100002\n"
+                                 "mnt_id:\t25\n"
+                                 "ino:\t1057\n");
+
+        REQUIRE(info.pos == 4096);
+        REQUIRE(info.flags == 0100002);
+        REQUIRE(info.mnt_id == 25);
+        REQUIRE(info.inode == 1057);
+    }
+
+    SECTION("eventfd")
+    {
+        auto info = parse_fdinfo("pos:\t0\n"
+                                 "flags:\t02\n"
+                                 "mnt_id:\t16\n"
+                                 "ino:\t1057\n"
+                                 "eventfd-count:               1f\n"
+                                 "eventfd-id: 3\n");
+
+        REQUIRE(info.eventfd_count == 0x1f);
+    }
+
+    SECTION("epoll")
+    {
+        auto info = parse_fdinfo(
+            "pos:\t0\n"
+            "flags:\t02\n"
+            "mnt_id:\t16\n"
+            "ino:\t1057\n"
+            "tfd:        5 events:       19 data:                5  pos:0 ino:61af sdev:7\n"
+            "tfd:        7 events:        1 data:     7f0000000007  pos:0 ino:61b0 sdev:100003\n");
+
+        REQUIRE(info.epoll_targets.size() == 2);
+
+        REQUIRE(info.epoll_targets[0].fd == 5);
+        REQUIRE(info.epoll_targets[0].events == 0x19);
+        REQUIRE(info.epoll_targets[0].data == 5);
+        REQUIRE(info.epoll_targets[0].inode == 0x61af);
+        REQUIRE(info.epoll_targets[0].device == MKDEV(0, 7));
+
+        REQUIRE(info.epoll_targets[1].fd == 7);
+        REQUIRE(info.epoll_targets[1].data == 0x7f0000000007);
+        REQUIRE(info.epoll_targets[1].device == MKDEV(1, 3));
+    }
+
+    SECTION("inotify")
+    {
+        auto info = parse_fdinfo(
+            "pos:\t0\n"
+            "flags:\t00\n"
+            "mnt_id:\t16\n"
+            "ino:\t1057\n"
+            "inotify wd:3 ino:9e7e sdev:800013 mask:800afce ignored_mask:0 "
+            "fhandle-bytes:8 fhandle-type:1 f_handle:7e9e0000640d1b6d\n");
+
+        REQUIRE(info.inotify_watches.size() == 1);
+        REQUIRE(info.inotify_watches[0].wd == 3);
+        REQUIRE(info.inotify_watches[0].inode == 0x9e7e);
+        REQUIRE(info.inotify_watches[0].device == MKDEV(8, 0x13));
+        REQUIRE(info.inotify_watches[0].mask == 0x800afce);
+    }
+
+    SECTION("timerfd")
+    {
+        auto info = parse_fdinfo("pos:\t0\n"
+                                 "flags:\t02\n"
+                                 "mnt_id:\t16\n"
+                                 "ino:\t1057\n"
+                                 "clockid: 1\n"
+                                 "ticks: 12\n"
+                                 "settime flags: 01\n"
+                                 "it_value: (0, 49406829)\n"
+                                 "it_interval: (1, 0)\n");
+
+        REQUIRE(info.timerfd.clock_id == 1);
+        REQUIRE(info.timerfd.ticks == 12);
+        REQUIRE(info.timerfd.settime_flags == 1);
+        REQUIRE(info.timerfd.value == std::chrono::nanoseconds(49406829));
+        REQUIRE(info.timerfd.interval == std::chrono::seconds(1));
+    }
+
+    SECTION("signalfd")
+    {
+        auto info = parse_fdinfo("pos:\t0\n"
+                                 "flags:\t02\n"
+                                 "mnt_id:\t16\n"
+                                 "ino:\t1057\n"
+                                 "sigmask:\t0000000000004002\n");
+
+        REQUIRE(info.signalfd_mask.is_set(pfs::signal::sigint));
+        REQUIRE(info.signalfd_mask.is_set(pfs::signal::sigterm));
+        REQUIRE_FALSE(info.signalfd_mask.is_set(pfs::signal::sigkill));
+    }
+
+    SECTION("pidfd")
+    {
+        auto info = parse_fdinfo("pos:\t0\n"
+                                 "flags:\t02000002\n"
+                                 "mnt_id:\t16\n"
+                                 "ino:\t1057\n"
+                                 "Pid:\t1234\n"
+                                 "NSpid:\t1234\t1\n");
+
+        REQUIRE(info.pidfd_pid == 1234);
+    }
+}
+
+TEST_CASE("Parse corrupted fdinfo", "[fd][fdinfo]")
+{
+    std::string content;
+
+    SECTION("Invalid flags")
+    {
+        content = "flags:\tsome\n";
+    }
+
+    SECTION("Missing epoll value")
+    {
+        content = "tfd:        5 events:\n";
+    }
+
+    SECTION("Invalid timespec")
+    {
+        content = "it_value: 0, 49406829\n";
+    }
+
+    REQUIRE_THROWS_AS(parse_fdinfo(content), pfs::parser_error);
+}
+
+TEST_CASE("Get fdinfo", "[task][fd][fdinfo]")
+{
+    int epoll = epoll_create1(0);
+    REQUIRE(epoll >= 0);
+    pfs::impl::defer close_epoll([epoll] { close(epoll); });
+
+    int event = eventfd(5, 0);
+    REQUIRE(event >= 0);
+    pfs::impl::defer close_event([event] { close(event); });
+
+    struct epoll_event ev = {};
+    ev.events  = EPOLLIN;
+    ev.data.fd = event;
+    REQUIRE(epoll_ctl(epoll, EPOLL_CTL_ADD, event, &ev) == 0);
+
+    int timer = timerfd_create(CLOCK_MONOTONIC, 0);
+    REQUIRE(timer >= 0);
+    pfs::impl::defer close_timer([timer] { close(timer); });
+
+    struct itimerspec spec = {};
+    spec.it_value.tv_sec    = 100;
+    spec.it_interval.tv_sec = 1;
+    REQUIRE(timerfd_settime(timer, 0, &spec, nullptr) == 0);
+
+    auto task   = pfs::procfs().get_task();
+    auto fdinfo = task.get_fdinfo();
+
+    REQUIRE(fdinfo.count(epoll));
+    REQUIRE(fdinfo.at(epoll).epoll_targets.size() == 1);
+    REQUIRE(fdinfo.at(epoll).epoll_targets[0].fd == event);
+    REQUIRE(fdinfo.at(epoll).epoll_targets[0].data ==
+            static_cast<uint64_t>(event));
+
+    REQUIRE(fdinfo.count(event));
+    REQUIRE(fdinfo.at(event).eventfd_count == 5);
+
+    REQUIRE(fdinfo.count(timer));
+    REQUIRE(fdinfo.at(timer).timerfd.clock_id == CLOCK_MONOTONIC);
+    REQUIRE(fdinfo.at(timer).timerfd.interval == std::chrono::seconds(1));
+
+    auto fds = task.get_fds();
+    REQUIRE(fds.at(event).get_info().eventfd_count == 5);
+}
@@ -0,0 +1,179 @@
+#include <algorithm>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+#include "pfs/parser_error.hpp"
+#include "pfs/procfs.hpp"
+
+namespace {
+
+// CPU 2 is offline
+const char INTERRUPTS[] =
+    "           CPU0       CPU1       CPU3       \n"
+    "  0:         33          0          0   IO-APIC   2-edge      timer\n"
+    " 28:          0       5000          2 PCI-MSIX-0000:00:01.0   0-edge      virtio0-input\n"
+    "NMI:          1          2          3   Non-maskable interrupts\n"
+    "ERR:          7\n"
+    "MIS:          0\n";
+
+const char SOFTIRQS[] =
+    "                    CPU0       CPU1       CPU3       \n"
+    "          HI:          1          0          0\n"
+    "      NET_RX:        100        200        300\n";
+
+} // anonymous namespace
+
+TEST_CASE("Parse interrupts", "[procfs][interrupts]")
+{
+    temp_dir dir;
+    dir.create_file("interrupts", INTERRUPTS);
+    dir.create_file("softirqs", SOFTIRQS);
+
+    pfs::procfs procfs(dir.get_root());
+
+    auto interrupts = procfs.get_interrupts();
+    REQUIRE(interrupts.cpus == std::vector<int>({0, 1, 3}));
+    REQUIRE(interrupts.rows() == 5);
+    REQUIRE(interrupts.columns() == 3);
+    REQUIRE(interrupts.counts.size() == 15);
+
+    REQUIRE(interrupts.names[1] == "28");
+    REQUIRE(interrupts.descriptions[1] ==
+            "PCI-MSIX-0000:00:01.0   0-edge      virtio0-input");
+    REQUIRE(interrupts.at(1, 1) == 5000);
+    REQUIRE(interrupts.row(1)[2] == 2);
+
+    REQUIRE(interrupts.names[2] == "NMI");
+    REQUIRE(interrupts.descriptions[2] == "Non-maskable interrupts");
+
+    // Not per-CPU
+    REQUIRE(interrupts.names[3] == "ERR");
+    REQUIRE(interrupts.at(3, 0) == 7);
+    REQUIRE(interrupts.at(3, 1) == 0);
+    REQUIRE(interrupts.descriptions[3].empty());
+
+    auto softirqs = procfs.get_softirqs();
+    REQUIRE(softirqs.rows() == 2);
+    REQUIRE(softirqs.names[1] == "NET_RX");
+    REQUIRE(softirqs.at(1, 2) == 300);
+    REQUIRE(softirqs.descriptions[1].empty());
+
+    SECTION("Reuse output")
+    {
+        auto data = interrupts.counts.data();
+        procfs.get_interrupts(interrupts);
+        REQUIRE(interrupts.counts.data() == data);
+
+        procfs.get_softirqs(interrupts);
+        REQUIRE(interrupts.rows() == 2);
+        REQUIRE(interrupts.counts.size() == 6);
+        REQUIRE(interrupts.descriptions.size() == 2);
+    }
+
+    SECTION("Corrupted")
+    {
+        dir.create_file("interrupts", "");
+        REQUIRE_THROWS_AS(procfs.get_interrupts(), pfs::parser_error);
+
+        dir.create_file("interrupts", "   CPU0   CPUX\n");
+        REQUIRE_THROWS_AS(procfs.get_interrupts(), pfs::parser_error);
+
+        dir.create_file("interrupts", "   CPU0\n  0   12\n");
+        REQUIRE_THROWS_AS(procfs.get_interrupts(), pfs::parser_error);
+
+        dir.create_file("interrupts", "   CPU0\n  0:   12x\n");
+        REQUIRE_THROWS_AS(procfs.get_interrupts(), pfs::parser_error);
+
+        dir.create_file("interrupts", "   CPU0\nNMI:   Non-maskable\n");
+        REQUIRE_THROWS_AS(procfs.get_interrupts(), pfs::parser_error);
+    }
+}
+
+TEST_CASE("Compute interrupt deltas", "[procfs][interrupts]")
+{
+    temp_dir dir;
+    dir.create_file("interrupts", INTERRUPTS);
+
+    pfs::procfs procfs(dir.get_root());
+    auto before = procfs.get_interrupts();
+
+    SECTION("Same CPUs")
+    {
+        dir.create_file(
+            "interrupts",
+            "           CPU0       CPU1       CPU3       \n"
+            "  0:         43          0          0   IO-APIC   2-edge      timer\n"
+            " 28:          1       5900          2 PCI-MSIX-0000:00:01.0   0-edge      virtio0-input\n"
+            "NMI:          2          3          4   Non-maskable interrupts\n"
+            "ERR:          7\n"
+            "MIS:          0\n");
+        auto after  = procfs.get_interrupts();
+        auto deltas = after.deltas_since(before);
+
+        REQUIRE(deltas.size() == 3);
+
+        REQUIRE(after.names[deltas[0].row] == "28");
+        REQUIRE(deltas[0].total == 901);
+        REQUIRE(deltas[0].top_cpu == 1);
+        REQUIRE(deltas[0].top_count == 900);
+        REQUIRE(deltas[0].concentration == Approx(900.0 / 901));
+
+        REQUIRE(after.names[deltas[1].row] == "0");
+        REQUIRE(deltas[1].total == 10);
+        REQUIRE(deltas[1].concentration == Approx(1));
+
+        REQUIRE(after.names[deltas[2].row] == "NMI");
+        REQUIRE(deltas[2].total == 3);
+        REQUIRE(deltas[2].concentration == Approx(1.0 / 3));
+    }
+
+    SECTION("CPUs and rows changed")
+    {
+        // CPU 1 is offline, CPU 2 is back, and IRQ 29 is new
+        dir.create_file(
+            "interrupts",
+            "           CPU0       CPU2       CPU3       \n"
+            "  0:         33          9          0   IO-APIC   2-edge      timer\n"
+            " 29:         50          0          0   virtio0-output\n"
+            " 28:          0          7         12 PCI-MSIX-0000:00:01.0   0-edge      virtio0-input\n");
+        auto after = procfs.get_interrupts();
+
+        std::vector<pfs::irq_delta> deltas;
+        after.deltas_since(before, deltas);
+
+        REQUIRE(deltas.size() == 1);
+        REQUIRE(after.names[deltas[0].row] == "28");
+        REQUIRE(deltas[0].total == 10);
+        REQUIRE(deltas[0].top_cpu == 3);
+    }
+
+    SECTION("Wrapped counters")
+    {
+        dir.create_file(
+            "interrupts",
+            "           CPU0       CPU1       CPU3       \n"
+            "  0:          2          0          0   IO-APIC   2-edge      timer\n");
+        before = procfs.get_interrupts();
+        before.counts[0] = 0xFFFFFFFF;
+
+        auto deltas = procfs.get_interrupts().deltas_since(before);
+        REQUIRE(deltas.size() == 1);
+        REQUIRE(deltas[0].total == 3);
+    }
+}
+
+TEST_CASE("Parse system interrupts", "[procfs][interrupts]")
+{
+    pfs::procfs procfs;
+
+    auto interrupts = procfs.get_interrupts();
+    REQUIRE(!interrupts.cpus.empty());
+    REQUIRE(interrupts.counts.size() ==
+            interrupts.rows() * interrupts.columns());
+
+    auto softirqs = procfs.get_softirqs();
+    REQUIRE(softirqs.columns() == interrupts.columns());
+    REQUIRE(std::find(softirqs.names.begin(), softirqs.names.end(),
+                      "NET_RX") != softirqs.names.end());
+}
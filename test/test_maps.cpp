@@ -5,6 +5,7 @@
 #include "test_utils.hpp"
 
 #include "pfs/parsers/maps.hpp"
+#include "pfs/procfs.hpp"
 #include "pfs/parser_error.hpp"
 
 using namespace pfs::impl::parsers;
@@ -193,4 +194,75 @@ TEST_CASE("Parse maps", "[task][maps]")
     REQUIRE(region.device == MKDEV(dev_major, dev_minor));
     REQUIRE(region.inode == inode);
     REQUIRE(region.pathname == pathname);
+
+    pfs::string_pool pool;
+    auto compact = parse_compact_maps_line(line, pool);
+    REQUIRE(compact.start_address == start);
+    REQUIRE(compact.end_address == end);
+    REQUIRE(compact.device == MKDEV(dev_major, dev_minor));
+    REQUIRE(compact.inode == inode);
+    REQUIRE(pool.get(compact.pathname_id) == pathname);
+}
+
+TEST_CASE("Parse maps pathname with consecutive spaces", "[task][maps]")
+{
+    std::string line = "7f3fcf467000-7f3fcf666000 ---p 0019d000 fd:00 3801114"
+                       "                    /tmp/lib  m   2.25.so";
+
+    auto region = parse_maps_line(line);
+    REQUIRE(region.offset == 0x19d000);
+    REQUIRE(region.pathname == "/tmp/lib  m   2.25.so");
+}
+
+TEST_CASE("Intern maps pathnames", "[task][maps]")
+{
+    pfs::string_pool pool;
+
+    auto a = parse_compact_maps_line(
+        "7f0b476c6000-7f0b476c7000 r--p 00027000 fd:00 2097554 "
+        "/lib/x86_64-linux-gnu/ld-2.27.so",
+        pool);
+    auto b = parse_compact_maps_line(
+        "7f0b476c7000-7f0b476c8000 rw-p 00028000 fd:00 2097554 "
+        "/lib/x86_64-linux-gnu/ld-2.27.so",
+        pool);
+    auto anon = parse_compact_maps_line(
+        "7f0b476c8000-7f0b476c9000 rw-p 00000000 00:00 0", pool);
+
+    REQUIRE(a.pathname_id == b.pathname_id);
+    REQUIRE(anon.pathname_id == pfs::string_pool::EMPTY_ID);
+    REQUIRE(pool.size() == 2);
+}
+
+TEST_CASE("Collect processes maps", "[procfs][maps]")
+{
+    pfs::string_pool pool;
+    auto maps = pfs::procfs().get_processes_maps(pool, 2);
+
+    auto self = maps.find(getpid());
+    REQUIRE(self != maps.end());
+    REQUIRE(!self->second.empty());
+
+    auto expected = pfs::procfs().get_task().get_maps();
+    REQUIRE(self->second.front().start_address ==
+            expected.front().start_address);
+}
+
+TEST_CASE("Collect processes maps of a fake procfs", "[procfs][maps]")
+{
+    temp_dir dir;
+    dir.create_file("1/maps", "7f0b476c8000-7f0b476c9000 rw-p 00000000 "
+                              "00:00 0\n");
+    dir.create_file("2/comm", "exited\n"); // No maps, as if it exited
+
+    pfs::procfs procfs(dir.get_root());
+    pfs::string_pool pool;
+
+    auto maps = procfs.get_processes_maps(pool, 2);
+    REQUIRE(maps.size() == 1);
+    REQUIRE(maps.at(1).size() == 1);
+
+    // Corrupted files aren't mistaken for processes that exited
+    dir.create_file("3/maps", "7f0b476c8000-7f0b476c9000 rw-p\n");
+    REQUIRE_THROWS_AS(procfs.get_processes_maps(pool, 2), pfs::parser_error);
 }
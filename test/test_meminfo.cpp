@@ -5,6 +5,7 @@
 
 #include "pfs/parsers/meminfo.hpp"
 #include "pfs/parser_error.hpp"
+#include "pfs/procfs.hpp"
 
 using namespace pfs::impl::parsers;
 
@@ -55,3 +56,92 @@ TEST_CASE("Parse meminfo", "[procfs][meminfo]")
     REQUIRE(output.first == description);
     REQUIRE(output.second == amount);
 }
+
+TEST_CASE("Parse meminfo file", "[procfs][meminfo]")
+{
+    temp_dir dir;
+    dir.create_file("meminfo", "MemTotal:        6147400 kB\n"
+                               "MemFree:         4772444 kB\n"
+                               "MemAvailable:    5611284 kB\n"
+                               "Cached:           985116 kB\n"
+                               "Active(anon):         28 kB\n"
+                               "Dirty:               440 kB\n"
+                               "Slab:              42992 kB\n"
+                               "SReclaimable:      25044 kB\n"
+                               "Balloon:               7 kB\n"
+                               "VmallocTotal:   34359738367 kB\n"
+                               "AnonHugePages:      2048 kB\n"
+                               "HugePages_Total:       4\n"
+                               "NewKey:                9\n"
+                               "DirectMap1G:     6291456 kB");
+
+    pfs::procfs procfs(dir.get_root());
+
+    pfs::meminfo info;
+    info.buffers = 1; // Reset, since it's not in the file
+    procfs.get_meminfo(info);
+
+    REQUIRE(info.mem_total == 6147400);
+    REQUIRE(info.mem_free == 4772444);
+    REQUIRE(info.mem_available == 5611284);
+    REQUIRE(info.cached == 985116);
+    REQUIRE(info.active_anon == 28);
+    REQUIRE(info.dirty == 440);
+    REQUIRE(info.slab == 42992);
+    REQUIRE(info.sreclaimable == 25044);
+    REQUIRE(info.vmalloc_total == 34359738367ULL);
+    REQUIRE(info.anon_huge_pages == 2048);
+    REQUIRE(info.huge_pages_total == 4);
+    REQUIRE(info.direct_map_1g == 6291456);
+    REQUIRE(info.buffers == 0);
+
+    REQUIRE(info.other.size() == 2);
+    REQUIRE(info.other[0].first == "Balloon");
+    REQUIRE(info.other[0].second == 7);
+    REQUIRE(info.other[1].first == "NewKey");
+    REQUIRE(info.other[1].second == 9);
+
+    SECTION("Reuse output")
+    {
+        auto data = info.other.data();
+        procfs.get_meminfo(info);
+        REQUIRE(info.other.size() == 2);
+        REQUIRE(info.other.data() == data);
+        REQUIRE(info.mem_total == 6147400);
+    }
+
+    SECTION("Same as the map")
+    {
+        auto map = procfs.get_meminfo();
+        REQUIRE(map.at("Dirty") == info.dirty);
+        REQUIRE(map.at("HugePages_Total") == info.huge_pages_total);
+    }
+
+    SECTION("Corrupted")
+    {
+        dir.create_file("meminfo", "MemTotal 6147400 kB\n");
+        REQUIRE_THROWS_AS(procfs.get_meminfo(info), pfs::parser_error);
+
+        dir.create_file("meminfo", "MemTotal:  x6147400 kB\n");
+        REQUIRE_THROWS_AS(procfs.get_meminfo(info), pfs::parser_error);
+
+        dir.create_file("meminfo", "MemTotal:  6147400 MB\n");
+        REQUIRE_THROWS_AS(procfs.get_meminfo(info), pfs::parser_error);
+
+        dir.create_file("meminfo", "MemTotal:\n");
+        REQUIRE_THROWS_AS(procfs.get_meminfo(info), pfs::parser_error);
+    }
+}
+
+TEST_CASE("Parse system meminfo", "[procfs][meminfo]")
+{
+    pfs::procfs procfs;
+
+    pfs::meminfo info;
+    procfs.get_meminfo(info);
+    auto map = procfs.get_meminfo();
+
+    REQUIRE(info.mem_total == map.at("MemTotal"));
+    REQUIRE(info.mem_total > 0);
+    REQUIRE(info.mem_available <= info.mem_total);
+}
@@ -0,0 +1,241 @@
+#include <sstream>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+#include "pfs/parsers/net_counters.hpp"
+#include "pfs/parser_error.hpp"
+#include "pfs/procfs.hpp"
+
+using namespace pfs::impl::parsers;
+
+TEST_CASE("Parse snmp", "[net][net_counters]")
+{
+    std::istringstream in(
+        "Ip: Forwarding DefaultTTL InReceives InHdrErrors InAddrErrors "
+        "ForwDatagrams InUnknownProtos InDiscards InDelivers OutRequests "
+        "OutDiscards OutNoRoutes ReasmTimeout ReasmReqds ReasmOKs ReasmFails "
+        "FragOKs FragFails FragCreates OutTransmits\n"
+        "Ip: 1 64 1507258 0 2 0 0 0 1507160 1443427 10 40 0 0 0 0 0 0 0 "
+        "1443427\n"
+        "Icmp: InMsgs InErrors InCsumErrors InDestUnreachs OutMsgs "
+        "OutErrors OutRateLimitGlobal OutDestUnreachs\n"
+        "Icmp: 45 1 0 44 46 0 0 46\n"
+        "Tcp: RtoAlgorithm RtoMin RtoMax MaxConn ActiveOpens PassiveOpens "
+        "AttemptFails EstabResets CurrEstab InSegs OutSegs RetransSegs "
+        "InErrs OutRsts InCsumErrors\n"
+        "Tcp: 1 200 120000 -1 10542 341 5413 166 12 1488061 1530414 793 "
+        "3 6124 0\n"
+        "Udp: InDatagrams NoPorts InErrors OutDatagrams RcvbufErrors "
+        "SndbufErrors InCsumErrors IgnoredMulti MemErrors\n"
+        "Udp: 14297 46 7 14409 5 2 0 0 0\n"
+        "UdpLite: InDatagrams NoPorts InErrors OutDatagrams RcvbufErrors "
+        "SndbufErrors InCsumErrors IgnoredMulti MemErrors\n"
+        "UdpLite: 0 0 0 0 0 0 0 0 0\n");
+
+    pfs::net_snmp snmp;
+    parse_snmp(in, snmp);
+
+    REQUIRE(snmp.ip_in_receives == 1507258);
+    REQUIRE(snmp.ip_in_addr_errors == 2);
+    REQUIRE(snmp.ip_in_delivers == 1507160);
+    REQUIRE(snmp.ip_out_requests == 1443427);
+    REQUIRE(snmp.ip_out_discards == 10);
+    REQUIRE(snmp.ip_out_no_routes == 40);
+    REQUIRE(snmp.icmp_in_msgs == 45);
+    REQUIRE(snmp.icmp_in_errors == 1);
+    REQUIRE(snmp.icmp_out_dest_unreachs == 46);
+    REQUIRE(snmp.tcp_active_opens == 10542);
+    REQUIRE(snmp.tcp_passive_opens == 341);
+    REQUIRE(snmp.tcp_attempt_fails == 5413);
+    REQUIRE(snmp.tcp_estab_resets == 166);
+    REQUIRE(snmp.tcp_curr_estab == 12);
+    REQUIRE(snmp.tcp_in_segs == 1488061);
+    REQUIRE(snmp.tcp_out_segs == 1530414);
+    REQUIRE(snmp.tcp_retrans_segs == 793);
+    REQUIRE(snmp.tcp_in_errs == 3);
+    REQUIRE(snmp.tcp_out_rsts == 6124);
+    REQUIRE(snmp.udp_in_datagrams == 14297);
+    REQUIRE(snmp.udp_no_ports == 46);
+    REQUIRE(snmp.udp_in_errors == 7);
+    REQUIRE(snmp.udp_out_datagrams == 14409);
+    REQUIRE(snmp.udp_rcvbuf_errors == 5);
+    REQUIRE(snmp.udp_sndbuf_errors == 2);
+}
+
+TEST_CASE("Parse netstat", "[net][net_counters]")
+{
+    std::istringstream in(
+        "TcpExt: SyncookiesSent SyncookiesRecv SyncookiesFailed "
+        "EmbryonicRsts PruneCalled RcvPruned OfoPruned OutOfWindowIcmps "
+        "LockDroppedIcmps ArpFilter TW TWRecycled TWKilled PAWSActive "
+        "PAWSEstab DelayedACKs DelayedACKLocked DelayedACKLost "
+        "ListenOverflows ListenDrops TCPTimeouts TCPAbortOnMemory\n"
+        "TcpExt: 3 2 1 4 5 6 7 0 0 0 2466 0 0 0 0 1823 1 9 11 12 431 1\n"
+        "IpExt: InNoRoutes InTruncatedPkts InMcastPkts OutMcastPkts "
+        "InBcastPkts OutBcastPkts InOctets OutOctets\n"
+        "IpExt: 0 0 20 22 3 0 2146938722 209394732\n"
+        "MPTcpExt: MPCapableSYNRX MPCapableSYNTX\n"
+        "MPTcpExt: 0 0\n");
+
+    pfs::net_netstat netstat;
+    parse_netstat(in, netstat);
+
+    REQUIRE(netstat.syncookies_sent == 3);
+    REQUIRE(netstat.syncookies_recv == 2);
+    REQUIRE(netstat.syncookies_failed == 1);
+    REQUIRE(netstat.embryonic_rsts == 4);
+    REQUIRE(netstat.prune_called == 5);
+    REQUIRE(netstat.rcv_pruned == 6);
+    REQUIRE(netstat.ofo_pruned == 7);
+    REQUIRE(netstat.tw == 2466);
+    REQUIRE(netstat.delayed_acks == 1823);
+    REQUIRE(netstat.listen_overflows == 11);
+    REQUIRE(netstat.listen_drops == 12);
+    REQUIRE(netstat.tcp_timeouts == 431);
+    REQUIRE(netstat.tcp_abort_on_memory == 1);
+    REQUIRE(netstat.ip_in_mcast_pkts == 20);
+    REQUIRE(netstat.ip_out_mcast_pkts == 22);
+    REQUIRE(netstat.ip_in_bcast_pkts == 3);
+    REQUIRE(netstat.ip_in_octets == 2146938722);
+    REQUIRE(netstat.ip_out_octets == 209394732);
+}
+
+TEST_CASE("Parse corrupted net counters", "[net][net_counters]")
+{
+    pfs::net_snmp snmp;
+
+    SECTION("Missing values line")
+    {
+        std::istringstream in("Tcp: ActiveOpens PassiveOpens\n");
+        REQUIRE_THROWS_AS(parse_snmp(in, snmp), pfs::parser_error);
+    }
+
+    SECTION("Mismatching sections")
+    {
+        std::istringstream in("Tcp: ActiveOpens PassiveOpens\n"
+                              "Udp: 1 2\n");
+        REQUIRE_THROWS_AS(parse_snmp(in, snmp), pfs::parser_error);
+    }
+
+    SECTION("Not enough values")
+    {
+        std::istringstream in("Tcp: ActiveOpens PassiveOpens\n"
+                              "Tcp: 1\n");
+        REQUIRE_THROWS_AS(parse_snmp(in, snmp), pfs::parser_error);
+    }
+
+    SECTION("Invalid value")
+    {
+        std::istringstream in("Tcp: ActiveOpens PassiveOpens\n"
+                              "Tcp: 1 2x\n");
+        REQUIRE_THROWS_AS(parse_snmp(in, snmp), pfs::parser_error);
+    }
+
+    SECTION("Missing sockstat value")
+    {
+        pfs::net_sockstat sockstat;
+        std::istringstream in("TCP: inuse 4 orphan\n");
+        REQUIRE_THROWS_AS(parse_sockstat(in, sockstat), pfs::parser_error);
+    }
+}
+
+TEST_CASE("Parse sockstat", "[net][net_counters]")
+{
+    pfs::net_sockstat sockstat;
+
+    SECTION("IPv4")
+    {
+        std::istringstream in(
+            "sockets: used 181\n"
+            "TCP: inuse 4 orphan 1 tw 5 alloc 6 mem 2\n"
+            "UDP: inuse 3 mem 7\n"
+            "UDPLITE: inuse 0\n"
+            "RAW: inuse 1\n"
+            "FRAG: inuse 2 memory 512\n");
+        parse_sockstat(in, sockstat);
+
+        REQUIRE(sockstat.sockets_used == 181);
+        REQUIRE(sockstat.tcp_inuse == 4);
+        REQUIRE(sockstat.tcp_orphan == 1);
+        REQUIRE(sockstat.tcp_tw == 5);
+        REQUIRE(sockstat.tcp_alloc == 6);
+        REQUIRE(sockstat.tcp_mem == 2);
+        REQUIRE(sockstat.udp_inuse == 3);
+        REQUIRE(sockstat.udp_mem == 7);
+        REQUIRE(sockstat.raw_inuse == 1);
+        REQUIRE(sockstat.frag_inuse == 2);
+        REQUIRE(sockstat.frag_memory == 512);
+    }
+
+    SECTION("IPv6")
+    {
+        std::istringstream in(
+            "TCP6: inuse 2\n"
+            "UDP6: inuse 3\n"
+            "UDPLITE6: inuse 0\n"
+            "RAW6: inuse 1\n"
+            "FRAG6: inuse 0 memory 0\n");
+        parse_sockstat(in, sockstat);
+
+        REQUIRE(sockstat.sockets_used == 0);
+        REQUIRE(sockstat.tcp_inuse == 2);
+        REQUIRE(sockstat.udp_inuse == 3);
+        REQUIRE(sockstat.raw_inuse == 1);
+    }
+}
+
+TEST_CASE("Net counter rates", "[net][net_counters]")
+{
+    pfs::net_stats_sample previous;
+    previous.snmp.tcp_out_segs     = 1000;
+    previous.snmp.tcp_retrans_segs = 10;
+    previous.snmp.udp_in_errors    = 50;
+    previous.netstat.listen_drops  = 4;
+
+    pfs::net_stats_sample current = previous;
+    current.time += std::chrono::seconds(2);
+    current.snmp.tcp_out_segs     = 3000;
+    current.snmp.tcp_retrans_segs = 110;
+    current.netstat.listen_drops  = 8;
+
+    SECTION("Increasing counters")
+    {
+        auto rates = current.rates_since(previous);
+        REQUIRE(rates.tcp_out_segs == Approx(1000));
+        REQUIRE(rates.tcp_retrans_segs == Approx(50));
+        REQUIRE(rates.tcp_retrans_ratio == Approx(0.05));
+        REQUIRE(rates.listen_drops == Approx(2));
+        REQUIRE(rates.udp_in_errors == 0);
+    }
+
+    SECTION("Counter reset")
+    {
+        current.snmp.udp_in_errors = 1;
+
+        auto rates = current.rates_since(previous);
+        REQUIRE(rates.udp_in_errors == 0);
+        REQUIRE(rates.tcp_out_segs == Approx(1000));
+    }
+
+    SECTION("Same time")
+    {
+        auto rates = previous.rates_since(previous);
+        REQUIRE(rates.tcp_out_segs == 0);
+    }
+}
+
+TEST_CASE("Read net counters", "[net][net_counters]")
+{
+    auto net = pfs::procfs().get_net();
+
+    auto first = net.get_stats_sample();
+    REQUIRE(first.snmp.ip_in_receives > 0);
+
+    auto sockstat = net.get_sockstat();
+    REQUIRE(sockstat.sockets_used > 0);
+
+    auto second = net.get_stats_sample();
+    REQUIRE(second.snmp.ip_in_receives >= first.snmp.ip_in_receives);
+    REQUIRE(second.rates_since(first).tcp_retrans_ratio >= 0);
+}
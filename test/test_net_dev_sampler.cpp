@@ -0,0 +1,157 @@
+#include <stdint.h>
+
+#include <string>
+#include <thread>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+#include "pfs/parser_error.hpp"
+#include "pfs/procfs.hpp"
+
+namespace {
+
+static const std::string HEADER =
+    "Inter-|   Receive                                                |  Transmit\n"
+    " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n";
+
+std::string build_line(const std::string& interface, uint64_t rx_bytes,
+                       uint64_t rx_drop, uint64_t tx_bytes)
+{
+    return interface + ": " + std::to_string(rx_bytes) + " 10 1 " +
+           std::to_string(rx_drop) + " 0 0 0 0 " + std::to_string(tx_bytes) +
+           " 20 2 0 0 0 0 0\n";
+}
+
+} // anonymous namespace
+
+TEST_CASE("Sample net devices", "[net][net_dev_sampler]")
+{
+    static const int TASK_ID = 1;
+    static const std::string DEV_FILE = "1/net/dev";
+
+    temp_dir dir;
+    dir.create_file(DEV_FILE, HEADER + build_line("    lo", 1000, 0, 1000) +
+                                  build_line("  eth0", 1000, 5, 0));
+
+    auto sampler = pfs::procfs(dir.get_root()).get_net(TASK_ID).get_dev_sampler();
+
+    sampler.sample();
+    auto& interfaces = sampler.interfaces();
+    REQUIRE(interfaces.size() == 2);
+
+    size_t lo   = sampler.find("lo");
+    size_t eth0 = sampler.find("eth0");
+    REQUIRE(lo != pfs::net_dev_sampler::npos);
+    REQUIRE(eth0 != pfs::net_dev_sampler::npos);
+    REQUIRE(sampler.find("eth1") == pfs::net_dev_sampler::npos);
+
+    REQUIRE(interfaces[lo].present);
+    REQUIRE(interfaces[lo].counters.rx_bytes == 1000);
+    REQUIRE(interfaces[lo].counters.rx_errs == 1);
+    REQUIRE(interfaces[lo].counters.tx_packets == 20);
+    REQUIRE(interfaces[eth0].counters.rx_drop == 5);
+
+    // The first sample is a baseline
+    REQUIRE(interfaces[lo].rates.rx_bytes == 0);
+
+    auto first = sampler.time();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    SECTION("Rates")
+    {
+        // Reordered, and a new interface
+        dir.create_file(DEV_FILE, HEADER + build_line("  eth0", 1200, 15, 0) +
+                                      build_line("  eth1", 1, 1, 1) +
+                                      build_line("    lo", 3000, 0, 1500));
+        sampler.sample();
+
+        double seconds =
+            std::chrono::duration<double>(sampler.time() - first).count();
+
+        REQUIRE(interfaces.size() == 3);
+        REQUIRE(sampler.find("lo") == lo);
+        REQUIRE(sampler.find("eth0") == eth0);
+
+        REQUIRE(interfaces[lo].rates.rx_bytes == Approx(2000 / seconds));
+        REQUIRE(interfaces[lo].rates.tx_bytes == Approx(500 / seconds));
+        REQUIRE(interfaces[lo].rates.rx_packets == 0);
+        REQUIRE(interfaces[eth0].rates.rx_bytes == Approx(200 / seconds));
+        REQUIRE(interfaces[eth0].rates.rx_drop == Approx(10 / seconds));
+
+        size_t eth1 = sampler.find("eth1");
+        REQUIRE(interfaces[eth1].present);
+        REQUIRE(interfaces[eth1].rates.rx_bytes == 0);
+    }
+
+    SECTION("Removed interface")
+    {
+        dir.create_file(DEV_FILE, HEADER + build_line("    lo", 2000, 0, 1000));
+        sampler.sample();
+
+        REQUIRE(interfaces.size() == 2);
+        REQUIRE(interfaces[lo].present);
+        REQUIRE_FALSE(interfaces[eth0].present);
+        REQUIRE(interfaces[eth0].rates.rx_bytes == 0);
+
+        // Added back, so it's a new baseline
+        dir.create_file(DEV_FILE, HEADER + build_line("    lo", 3000, 0, 1000) +
+                                      build_line("  eth0", 5000, 0, 0));
+        sampler.sample();
+
+        REQUIRE(sampler.find("eth0") == eth0);
+        REQUIRE(interfaces[eth0].present);
+        REQUIRE(interfaces[eth0].counters.rx_bytes == 5000);
+        REQUIRE(interfaces[eth0].rates.rx_bytes == 0);
+        REQUIRE(interfaces[lo].rates.rx_bytes > 0);
+    }
+
+    SECTION("Reset counters")
+    {
+        // eth0 was re-created between the samples
+        dir.create_file(DEV_FILE, HEADER + build_line("    lo", 2000, 0, 1000) +
+                                      build_line("  eth0", 10, 0, 0));
+        sampler.sample();
+
+        REQUIRE(interfaces[eth0].present);
+        REQUIRE(interfaces[eth0].counters.rx_bytes == 10);
+        REQUIRE(interfaces[eth0].rates.rx_bytes == 0);
+        REQUIRE(interfaces[eth0].rates.rx_drop == 0);
+        REQUIRE(interfaces[lo].rates.rx_bytes > 0);
+
+        // Rates are back, relative to the new baseline
+        auto second = sampler.time();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        dir.create_file(DEV_FILE, HEADER + build_line("    lo", 2000, 0, 1000) +
+                                      build_line("  eth0", 110, 0, 0));
+        sampler.sample();
+
+        double seconds =
+            std::chrono::duration<double>(sampler.time() - second).count();
+        REQUIRE(interfaces[eth0].rates.rx_bytes == Approx(100 / seconds));
+    }
+
+    SECTION("Corrupted")
+    {
+        dir.create_file(DEV_FILE, HEADER + "  eth0: 1 2 3\n");
+        REQUIRE_THROWS_AS(sampler.sample(), pfs::parser_error);
+    }
+}
+
+TEST_CASE("Sample net devices of current namespace", "[net][net_dev_sampler]")
+{
+    auto net     = pfs::procfs().get_net();
+    auto sampler = net.get_dev_sampler();
+
+    sampler.sample();
+    sampler.sample();
+
+    auto devices = net.get_dev();
+    REQUIRE(sampler.interfaces().size() == devices.size());
+    for (const auto& device : devices)
+    {
+        size_t index = sampler.find(device.interface);
+        REQUIRE(index != pfs::net_dev_sampler::npos);
+        REQUIRE(sampler.interfaces()[index].present);
+    }
+}
@@ -0,0 +1,160 @@
+#include <sched.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+#include "pfs/defer.hpp"
+#include "pfs/procfs.hpp"
+
+namespace {
+
+const pfs::net_namespace* find_member(
+    const std::vector<pfs::net_namespace>& namespaces, int pid)
+{
+    for (const auto& ns : namespaces)
+    {
+        if (std::binary_search(ns.pids.begin(), ns.pids.end(), pid))
+        {
+            return &ns;
+        }
+    }
+    return nullptr;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Get net namespaces", "[procfs][net]")
+{
+    pfs::procfs pfs;
+
+    auto namespaces = pfs.get_net_namespaces();
+    REQUIRE(!namespaces.empty());
+
+    auto self = find_member(namespaces, getpid());
+    REQUIRE(self != nullptr);
+    REQUIRE(self->inode == pfs.get_task().get_ns("net"));
+
+    for (const auto& ns : namespaces)
+    {
+        REQUIRE(std::is_sorted(ns.pids.begin(), ns.pids.end()));
+    }
+}
+
+TEST_CASE("Collect net namespaces", "[procfs][net]")
+{
+    pfs::procfs pfs;
+
+    // A child in a namespace of its own, if allowed
+    int ready[2];
+    REQUIRE(pipe(ready) == 0);
+
+    pid_t child = fork();
+    REQUIRE(child >= 0);
+    if (child == 0)
+    {
+        char result = (unshare(CLONE_NEWNET) == 0) ? 1 : 0;
+        (void)!write(ready[1], &result, sizeof(result));
+        pause();
+        _exit(0);
+    }
+
+    pfs::impl::defer kill_child([child] {
+        kill(child, SIGKILL);
+        waitpid(child, nullptr, 0);
+    });
+
+    char isolated = 0;
+    REQUIRE(read(ready[0], &isolated, sizeof(isolated)) == sizeof(isolated));
+    close(ready[0]);
+    close(ready[1]);
+
+    size_t calls = 0;
+    auto results = pfs.collect_net_namespaces([&calls](const pfs::net& net) {
+        ++calls;
+        return net.get_unix().size();
+    });
+    REQUIRE(calls >= results.size());
+
+    std::vector<pfs::net_namespace> namespaces;
+    for (const auto& result : results)
+    {
+        namespaces.push_back(result.first);
+    }
+
+    auto self = find_member(namespaces, getpid());
+    REQUIRE(self != nullptr);
+
+    auto other = find_member(namespaces, child);
+    REQUIRE(other != nullptr);
+    if (isolated)
+    {
+        REQUIRE(other->inode != self->inode);
+        REQUIRE(other->pids.size() == 1);
+    }
+    else
+    {
+        REQUIRE(other == self);
+    }
+}
+
+TEST_CASE("Collect net namespaces of exited members", "[procfs][net]")
+{
+    temp_dir dir;
+
+    // Both members share a namespace, but the first exited, so its files
+    // are gone
+    dir.create_file("ns_net", "");
+    dir.create_file("1/comm", "exited\n");
+    dir.create_file("2/net/tcp",
+                    "  sl  local_address rem_address   st tx_queue rx_queue "
+                    "tr tm->when retrnsmt   uid  timeout inode\n"
+                    "   0: 0100007F:1F90 00000000:0000 0A 00000000:00000000 "
+                    "00:00000000 00000000     0        0 15979 1 0\n");
+    dir.create_file("2/net/nf_conntrack", "");
+    for (const std::string pid : {"1", "2"})
+    {
+        dir.create_file(pid + "/ns/.keep", "");
+        REQUIRE(symlink((dir.get_root() + "/ns_net").c_str(),
+                        (dir.get_root() + "/" + pid + "/ns/net").c_str()) ==
+                0);
+    }
+
+    pfs::procfs pfs(dir.get_root());
+    size_t calls = 0;
+
+    SECTION("Using a query")
+    {
+        pfs::net_socket_query query;
+        query.local_ports = {0x1F90};
+
+        auto results = pfs.collect_net_namespaces(
+            [&calls, &query](const pfs::net& net) {
+                ++calls;
+                return net.get_tcp(query).size();
+            });
+        REQUIRE(results.size() == 1);
+        REQUIRE(results[0].first.pids == std::vector<int>{1, 2});
+        REQUIRE(results[0].second == 1);
+    }
+
+    SECTION("Using conntrack")
+    {
+        auto results =
+            pfs.collect_net_namespaces([&calls](const pfs::net& net) {
+                ++calls;
+                size_t count = 0;
+                net.for_each_conntrack(
+                    [&count](const pfs::conntrack_entry&) { ++count; });
+                return count;
+            });
+        REQUIRE(results.size() == 1);
+        REQUIRE(results[0].second == 0);
+    }
+
+    REQUIRE(calls == 2);
+}
@@ -56,3 +56,50 @@ TEST_CASE("Parse net route", "[net][route]")
     REQUIRE(route.window == expected.window);
     REQUIRE(route.irtt == expected.irtt);
 }
+
+TEST_CASE("Parse net ipv6 route", "[net][route]")
+{
+    std::string line = "fd000000000000000000000000000001 80 "
+                       "00000000000000000000000000000000 00 "
+                       "fe800000000000000000000000000002 00000400 00000001 "
+                       "0000000a 00000003     eth0";
+
+    auto route = parse_net_ipv6_route_line(line);
+
+    // Addresses are in network byte order
+    auto bytes = reinterpret_cast<const uint8_t*>(route.destination.storage.data());
+    REQUIRE(route.destination.is_v6());
+    REQUIRE(bytes[0] == 0xfd);
+    REQUIRE(bytes[15] == 0x01);
+    REQUIRE(route.destination_prefix_len == 128);
+    REQUIRE(route.source == pfs::ip(pfs::ipv6({0, 0, 0, 0})));
+    REQUIRE(route.source_prefix_len == 0);
+
+    bytes = reinterpret_cast<const uint8_t*>(route.next_hop.storage.data());
+    REQUIRE(bytes[0] == 0xfe);
+    REQUIRE(bytes[1] == 0x80);
+    REQUIRE(bytes[15] == 0x02);
+
+    REQUIRE(route.metric == 0x400);
+    REQUIRE(route.refcnt == 1);
+    REQUIRE(route.use == 10);
+    REQUIRE(route.flags == 3);
+    REQUIRE(route.iface == "eth0");
+
+    SECTION("Corrupted")
+    {
+        // Short destination
+        line = "fd00000000000000000000000000001 80 "
+               "00000000000000000000000000000000 00 "
+               "00000000000000000000000000000000 00000400 00000001 "
+               "00000000 00000003     eth0";
+        REQUIRE_THROWS_AS(parse_net_ipv6_route_line(line), pfs::parser_error);
+
+        // Missing interface
+        line = "fd000000000000000000000000000001 80 "
+               "00000000000000000000000000000000 00 "
+               "00000000000000000000000000000000 00000400 00000001 "
+               "00000000 00000003";
+        REQUIRE_THROWS_AS(parse_net_ipv6_route_line(line), pfs::parser_error);
+    }
+}
@@ -106,3 +106,183 @@ TEST_CASE("Parse net socket", "[net][net_socket]")
     REQUIRE(socket.ref_count == expected.ref_count);
     REQUIRE(socket.skbuff == expected.skbuff);
 }
+
+TEST_CASE("Parse net socket in place", "[net][net_socket]")
+{
+    // As printed by the kernel, with a leading padding and hex retransmits
+    std::string line =
+        "   12: 0100007F:1F90 0200007F:DA94 01 0000002C:00000001 01:00000014 "
+        "00000011  1000        0 71261 4 b1420000 20 4 25 10 -1";
+
+    pfs::net_socket socket;
+    parse_net_socket(line.data(), line.data() + line.size(), socket);
+
+    REQUIRE(socket.slot == 12);
+    REQUIRE(socket.local_ip == pfs::ip(pfs::ipv4(0x0100007F)));
+    REQUIRE(socket.local_port == 0x1F90);
+    REQUIRE(socket.remote_ip == pfs::ip(pfs::ipv4(0x0200007F)));
+    REQUIRE(socket.remote_port == 0xDA94);
+    REQUIRE(socket.socket_net_state ==
+            pfs::net_socket::net_state::established);
+    REQUIRE(socket.tx_queue == 0x2C);
+    REQUIRE(socket.rx_queue == 1);
+    REQUIRE(socket.timer_active == pfs::net_socket::timer::retransmit);
+    REQUIRE(socket.timer_expire_jiffies == 0x14);
+    REQUIRE(socket.retransmits == 0x11);
+    REQUIRE(socket.uid == 1000);
+    REQUIRE(socket.timeouts == 0);
+    REQUIRE(socket.inode == 71261);
+    REQUIRE(socket.ref_count == 4);
+    REQUIRE(socket.skbuff == 0xb1420000);
+
+    SECTION("IPv6 address")
+    {
+        line = "0: 000080FE00000000FF005450B6AC08FE:0016 "
+               "00000000000000000000000000000000:0000 0A 00000000:00000000 "
+               "00:00000000 00000000     0        0 18668 1 0";
+
+        parse_net_socket(line.data(), line.data() + line.size(), socket);
+        REQUIRE(socket.local_ip ==
+                pfs::ip(pfs::ipv6({0x000080FE, 0x00000000, 0xFF005450,
+                                   0xB6AC08FE})));
+        REQUIRE(socket.local_port == 0x16);
+    }
+
+    SECTION("Corrupted")
+    {
+        // An invalid hex digit in the middle of an IPv6 word
+        line = "0: 000080FE00000000FF0054X0B6AC08FE:0016 "
+               "00000000000000000000000000000000:0000 0A 00000000:00000000 "
+               "00:00000000 00000000     0        0 18668 1 0";
+        REQUIRE_THROWS_AS(
+            parse_net_socket(line.data(), line.data() + line.size(), socket),
+            pfs::parser_error);
+
+        // Garbage right after a column
+        line = "0: 0100007F:1F90 0200007F:DA94 01x 00000000:00000000 "
+               "00:00000000 00000000     0        0 18668 1 0";
+        REQUIRE_THROWS_AS(
+            parse_net_socket(line.data(), line.data() + line.size(), socket),
+            pfs::parser_error);
+
+        // Missing the tx/rx delimiter
+        line = "0: 0100007F:1F90 0200007F:DA94 01 00000000 00000000 "
+               "00:00000000 00000000     0        0 18668 1 0";
+        REQUIRE_THROWS_AS(
+            parse_net_socket(line.data(), line.data() + line.size(), socket),
+            pfs::parser_error);
+    }
+}
+
+TEST_CASE("Net socket table", "[net][net_socket]")
+{
+    pfs::net_socket_table table;
+    REQUIRE(table.empty());
+
+    std::string line =
+        "1: 3500007F:0035 00000000:0000 0A 00000000:00000000 00:00000000 "
+        "00000000   101        0 15979 1 0";
+    auto first = parse_net_socket_line(line);
+    table.push_back(first);
+
+    line = "2: 0100007F:1F90 0200007F:DA94 01 0000002C:00000001 01:00000014 "
+           "00000000  1000        0 71261 4 0";
+    auto second = parse_net_socket_line(line);
+    table.push_back(second);
+
+    REQUIRE(table.size() == 2);
+    REQUIRE(table.inode[0] == 15979);
+    REQUIRE(table.local_port[1] == 0x1F90);
+
+    auto socket = table.at(1);
+    REQUIRE(socket.local_ip == second.local_ip);
+    REQUIRE(socket.remote_port == second.remote_port);
+    REQUIRE(socket.socket_net_state == second.socket_net_state);
+    REQUIRE(socket.tx_queue == second.tx_queue);
+    REQUIRE(socket.uid == second.uid);
+    REQUIRE(socket.ref_count == second.ref_count);
+    REQUIRE_THROWS_AS(table.at(2), std::out_of_range);
+
+    table.clear();
+    REQUIRE(table.empty());
+    REQUIRE(table.slot.capacity() >= 2);
+}
+
+TEST_CASE("Prefilter net socket lines", "[net][net_socket]")
+{
+    // Listening on port 0x1F90 (8080) by uid 1000
+    std::string listen_line =
+        "   0: 00000000:1F90 00000000:0000 0A 00000000:00000000 00:00000000 "
+        "00000000  1000        0 15734 1 0 100 0 0 10 0";
+    // Established from port 0x1F90 to 0xDA94 by uid 0
+    std::string established_line =
+        "   1: 0100007F:1F90 0200007F:DA94 01 00000000:00000000 00:00000000 "
+        "00000000     0        0 15735 1 0 20 4 25 10 -1";
+    std::string ipv6_line =
+        "   2: 00000000000000000000000000000000:0016 "
+        "00000000000000000000000000000000:0000 0A 00000000:00000000 "
+        "00:00000000 00000000     0        0 18668 1 0";
+
+    auto matches = [](const net_socket_prefilter& prefilter,
+                      const std::string& line) {
+        return prefilter.matches(line.data(), line.data() + line.size());
+    };
+
+    pfs::net_socket_query query;
+
+    SECTION("Empty")
+    {
+        net_socket_prefilter prefilter(query);
+        REQUIRE(matches(prefilter, listen_line));
+        REQUIRE(matches(prefilter, established_line));
+        REQUIRE(matches(prefilter, ipv6_line));
+    }
+
+    SECTION("State")
+    {
+        query.states = {pfs::net_socket::net_state::listen};
+
+        net_socket_prefilter prefilter(query);
+        REQUIRE(matches(prefilter, listen_line));
+        REQUIRE_FALSE(matches(prefilter, established_line));
+        REQUIRE(matches(prefilter, ipv6_line));
+    }
+
+    SECTION("Ports")
+    {
+        query.local_ports = {8080};
+
+        net_socket_prefilter local(query);
+        REQUIRE(matches(local, listen_line));
+        REQUIRE(matches(local, established_line));
+        REQUIRE_FALSE(matches(local, ipv6_line));
+
+        query.remote_ports = {0xDA94};
+
+        net_socket_prefilter both(query);
+        REQUIRE_FALSE(matches(both, listen_line));
+        REQUIRE(matches(both, established_line));
+    }
+
+    SECTION("Uid")
+    {
+        query.uids = {1000};
+
+        net_socket_prefilter prefilter(query);
+        REQUIRE(matches(prefilter, listen_line));
+        REQUIRE_FALSE(matches(prefilter, established_line));
+        REQUIRE_FALSE(matches(prefilter, ipv6_line));
+    }
+
+    SECTION("Corrupted lines pass")
+    {
+        query.states      = {pfs::net_socket::net_state::listen};
+        query.local_ports = {8080};
+
+        net_socket_prefilter prefilter(query);
+        REQUIRE(matches(prefilter, "0: 00000000:1F90 00000000:0000"));
+        REQUIRE(matches(prefilter, "0: 00000000:1F90 00000000:0000 XY"));
+        REQUIRE_THROWS_AS(parse_net_socket_line("0: 00000000:1F90"),
+                          pfs::parser_error);
+    }
+}
@@ -0,0 +1,114 @@
+#include <stdint.h>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+#include "pfs/parsers/net_softnet_stat.hpp"
+#include "pfs/parser_error.hpp"
+#include "pfs/procfs.hpp"
+
+using namespace pfs::impl::parsers;
+
+TEST_CASE("Parse softnet stat", "[net][net_softnet_stat]")
+{
+    SECTION("5.10+")
+    {
+        std::string line = "0000272d 00000003 00000011 00000000 00000000 "
+                           "00000000 00000000 00000000 00000000 00000004 "
+                           "00000005 00000002 0000000a";
+
+        auto stat = parse_net_softnet_stat_line(line, 1);
+        REQUIRE(stat.cpu == 10);
+        REQUIRE(stat.processed == 0x272d);
+        REQUIRE(stat.dropped == 3);
+        REQUIRE(stat.time_squeeze == 0x11);
+        REQUIRE(stat.received_rps == 4);
+        REQUIRE(stat.flow_limit_count == 5);
+        REQUIRE(stat.backlog_len == 2);
+    }
+
+    SECTION("Extra columns")
+    {
+        std::string line = "00001b59 00000000 00000001 00000000 00000000 "
+                           "00000000 00000000 00000000 00000000 00000000 "
+                           "00000000 00000000 00000003 00000000 00000000";
+
+        auto stat = parse_net_softnet_stat_line(line, 0);
+        REQUIRE(stat.cpu == 3);
+        REQUIRE(stat.processed == 0x1b59);
+        REQUIRE(stat.time_squeeze == 1);
+    }
+
+    SECTION("Pre 3.11")
+    {
+        std::string line = "ffffffff 00000001 00000002 00000000 00000000 "
+                           "00000000 00000000 00000000 00000000 00000007";
+
+        auto stat = parse_net_softnet_stat_line(line, 2);
+        REQUIRE(stat.cpu == 2);
+        REQUIRE(stat.processed == UINT32_MAX);
+        REQUIRE(stat.received_rps == 7);
+        REQUIRE(stat.flow_limit_count == 0);
+        REQUIRE(stat.backlog_len == 0);
+    }
+
+    SECTION("Corrupted")
+    {
+        REQUIRE_THROWS_AS(parse_net_softnet_stat_line("0000272d 00000000", 0),
+                          pfs::parser_error);
+        REQUIRE_THROWS_AS(
+            parse_net_softnet_stat_line("0000272d x0000000 00000000 00000000 "
+                                        "00000000 00000000 00000000 00000000 "
+                                        "00000000",
+                                        0),
+            pfs::parser_error);
+    }
+}
+
+TEST_CASE("Softnet stat rates", "[net][net_softnet_stat]")
+{
+    pfs::net_softnet_sample previous;
+    previous.cpus.resize(2);
+    previous.cpus[0].cpu          = 0;
+    previous.cpus[0].processed    = UINT32_MAX - 9;
+    previous.cpus[1].cpu          = 2;
+    previous.cpus[1].dropped      = 4;
+    previous.cpus[1].time_squeeze = 10;
+
+    pfs::net_softnet_sample current = previous;
+    current.time += std::chrono::seconds(2);
+    current.cpus[0].processed    = 10; // Wrapped around
+    current.cpus[1].dropped      = 8;
+    current.cpus[1].time_squeeze = 30;
+
+    SECTION("Same CPUs")
+    {
+        auto rates = current.rates_since(previous);
+        REQUIRE(rates.size() == 2);
+        REQUIRE(rates[0].cpu == 0);
+        REQUIRE(rates[0].processed == Approx(10));
+        REQUIRE(rates[1].cpu == 2);
+        REQUIRE(rates[1].dropped == Approx(2));
+        REQUIRE(rates[1].time_squeeze == Approx(10));
+    }
+
+    SECTION("CPU went offline and online")
+    {
+        current.cpus[0].cpu = 1;
+
+        auto rates = current.rates_since(previous);
+        REQUIRE(rates.size() == 1);
+        REQUIRE(rates[0].cpu == 2);
+    }
+}
+
+TEST_CASE("Read softnet stat", "[net][net_softnet_stat]")
+{
+    auto net = pfs::procfs().get_net();
+
+    auto first  = net.get_softnet_sample();
+    auto second = net.get_softnet_sample();
+
+    REQUIRE(!first.cpus.empty());
+    REQUIRE(second.rates_since(first).size() == second.cpus.size());
+}
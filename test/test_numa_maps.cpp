@@ -0,0 +1,157 @@
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+#include "pfs/parsers/numa_maps.hpp"
+#include "pfs/parser_error.hpp"
+#include "pfs/procfs.hpp"
+
+using namespace pfs::impl::parsers;
+
+TEST_CASE("Parse corrupted numa_maps", "[task][numa_maps]")
+{
+    std::string line;
+
+    SECTION("Missing policy")
+    {
+        line = "559a3ad05000";
+    }
+
+    SECTION("Invalid address")
+    {
+        line = "559a3ad0500g default";
+    }
+
+    SECTION("Invalid node")
+    {
+        line = "559a3ad05000 default anon=1 Nx=1 kernelpagesize_kB=4";
+    }
+
+    SECTION("Node out of range")
+    {
+        line = "559a3ad05000 default anon=1 N4294967295=1";
+    }
+
+    SECTION("Node wraps around")
+    {
+        line = "559a3ad05000 default anon=1 N18446744073709551615=1";
+    }
+
+    SECTION("Invalid value")
+    {
+        line = "559a3ad05000 default anon=one N0=1 kernelpagesize_kB=4";
+    }
+
+    REQUIRE_THROWS_AS(parse_numa_maps_line(line), pfs::parser_error);
+}
+
+TEST_CASE("Parse numa_maps", "[task][numa_maps]")
+{
+    SECTION("File mapping")
+    {
+        auto region = parse_numa_maps_line(
+            "559a3ad05000 default file=/usr/bin/head mapped=2 mapmax=3 N0=2 "
+            "kernelpagesize_kB=4");
+
+        REQUIRE(region.start_address == 0x559a3ad05000);
+        REQUIRE(region.policy == "default");
+        REQUIRE(region.pathname == "/usr/bin/head");
+        REQUIRE(region.mapped == 2);
+        REQUIRE(region.mapmax == 3);
+        REQUIRE(region.anon == 0);
+        REQUIRE(region.node_pages == std::vector<size_t>{2});
+        REQUIRE(region.page_size_kb == 4);
+        REQUIRE_FALSE(region.is_heap);
+    }
+
+    SECTION("Interleaved heap")
+    {
+        auto region = parse_numa_maps_line(
+            "559a3b4b8000 interleave:0-2 heap anon=33 dirty=32 active=1 "
+            "swapcache=2 N0=30 N2=3 kernelpagesize_kB=4");
+
+        REQUIRE(region.policy == "interleave:0-2");
+        REQUIRE(region.pathname.empty());
+        REQUIRE(region.is_heap);
+        REQUIRE(region.anon == 33);
+        REQUIRE(region.dirty == 32);
+        REQUIRE(region.active == 1);
+        REQUIRE(region.swapcache == 2);
+        REQUIRE(region.node_pages == std::vector<size_t>{30, 0, 3});
+    }
+
+    SECTION("Huge stack")
+    {
+        auto region = parse_numa_maps_line(
+            "7ffd7a3f1000 bind:1 stack:1234 huge anon=1 N1=1 unknown=5 "
+            "kernelpagesize_kB=2048");
+
+        REQUIRE(region.is_stack);
+        REQUIRE(region.is_huge);
+        REQUIRE(region.node_pages == std::vector<size_t>{0, 1});
+        REQUIRE(region.page_size_kb == 2048);
+    }
+
+    SECTION("No resident pages")
+    {
+        auto region = parse_numa_maps_line("7ffd7a3fa000 default");
+
+        REQUIRE(region.policy == "default");
+        REQUIRE(region.node_pages.empty());
+    }
+}
+
+TEST_CASE("Join numa_maps with maps", "[task][numa_maps]")
+{
+    // Only exists when the kernel was built with CONFIG_NUMA
+    if (access("/proc/self/numa_maps", F_OK) != 0)
+    {
+        WARN("numa_maps is not supported by the kernel");
+        return;
+    }
+
+    auto task = pfs::procfs().get_task();
+
+    auto joined = task.get_maps_with_numa();
+    REQUIRE(!joined.empty());
+    REQUIRE(joined.size() <= task.get_maps().size());
+
+    for (const auto& pair : joined)
+    {
+        REQUIRE(pair.first.start_address == pair.second.start_address);
+    }
+
+    // The heap and the stack are always there
+    auto stack = std::find_if(
+        joined.begin(), joined.end(),
+        [](const std::pair<pfs::mem_region, pfs::numa_region>& pair) {
+            return pair.second.is_stack;
+        });
+    REQUIRE(stack != joined.end());
+    REQUIRE(stack->first.pathname == "[stack]");
+}
+
+TEST_CASE("Collect processes NUMA usage", "[procfs][numa_maps]")
+{
+    if (access("/proc/self/numa_maps", F_OK) != 0)
+    {
+        WARN("numa_maps is not supported by the kernel");
+        return;
+    }
+
+    auto usage = pfs::procfs().get_processes_numa_usage(2);
+
+    auto self = usage.find(getpid());
+    REQUIRE(self != usage.end());
+    REQUIRE(!self->second.empty());
+
+    size_t total = 0;
+    for (auto kb : self->second)
+    {
+        total += kb;
+    }
+    REQUIRE(total > 0);
+}
@@ -0,0 +1,168 @@
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+#include "pfs/procfs.hpp"
+
+TEST_CASE("Decode pagemap entry", "[task][pagemap]")
+{
+    SECTION("Present")
+    {
+        pfs::pagemap_entry entry((1ULL << 63) | (1ULL << 56) | 0x1234);
+        REQUIRE(entry.is_present());
+        REQUIRE_FALSE(entry.is_swapped());
+        REQUIRE(entry.is_exclusive());
+        REQUIRE_FALSE(entry.is_soft_dirty());
+        REQUIRE(entry.pfn() == 0x1234);
+        REQUIRE(entry.swap_type() == 0);
+        REQUIRE(entry.swap_offset() == 0);
+    }
+
+    SECTION("Swapped")
+    {
+        pfs::pagemap_entry entry((1ULL << 62) | (1ULL << 55) | (0x42 << 5) | 3);
+        REQUIRE_FALSE(entry.is_present());
+        REQUIRE(entry.is_swapped());
+        REQUIRE(entry.is_soft_dirty());
+        REQUIRE(entry.pfn() == 0);
+        REQUIRE(entry.swap_type() == 3);
+        REQUIRE(entry.swap_offset() == 0x42);
+    }
+
+    SECTION("Not mapped")
+    {
+        pfs::pagemap_entry entry;
+        REQUIRE_FALSE(entry.is_present());
+        REQUIRE_FALSE(entry.is_swapped());
+        REQUIRE_FALSE(entry.is_file_or_shared_anon());
+    }
+}
+
+TEST_CASE("Read pagemap", "[task][pagemap]")
+{
+    static const size_t PAGES = 8;
+    const size_t page_size    = pfs::pagemap::page_size();
+
+    void* addr = mmap(nullptr, PAGES * page_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    REQUIRE(addr != MAP_FAILED);
+    pfs::impl::defer unmap([&] { munmap(addr, PAGES * page_size); });
+
+    // Touch every other page
+    auto bytes = static_cast<char*>(addr);
+    for (size_t i = 0; i < PAGES; i += 2)
+    {
+        bytes[i * page_size] = 1;
+    }
+
+    size_t start = reinterpret_cast<size_t>(addr);
+    size_t end   = start + PAGES * page_size;
+
+    auto self    = pfs::procfs().get_task();
+    auto pagemap = self.get_pagemap();
+
+    SECTION("Entries")
+    {
+        auto entries = pagemap.read(start, end);
+        REQUIRE(entries.size() == PAGES);
+        for (size_t i = 0; i < PAGES; ++i)
+        {
+            REQUIRE(entries[i].is_present() == (i % 2 == 0));
+        }
+    }
+
+    SECTION("Residency")
+    {
+        auto residency = pagemap.read_residency(start, end);
+        REQUIRE(residency.start_address == start);
+        REQUIRE(residency.page_size == page_size);
+        REQUIRE(residency.present.size() == PAGES);
+        REQUIRE(residency.swapped.size() == PAGES);
+        for (size_t i = 0; i < PAGES; ++i)
+        {
+            REQUIRE(residency.present[i] == (i % 2 == 0));
+            REQUIRE_FALSE(residency.swapped[i]);
+        }
+    }
+
+    SECTION("Page counts")
+    {
+        auto entries = pagemap.read(start, end);
+        if (geteuid() == 0 && entries[0].pfn() != 0)
+        {
+            auto counts = pfs::procfs().get_kpagecount().read(entries);
+            REQUIRE(counts.size() == entries.size());
+            for (size_t i = 0; i < PAGES; ++i)
+            {
+                REQUIRE((counts[i] > 0) == entries[i].is_present());
+            }
+        }
+    }
+}
+
+TEST_CASE("Track soft-dirty pages", "[task][pagemap]")
+{
+    static const size_t PAGES = 8;
+    const size_t page_size    = pfs::pagemap::page_size();
+
+    void* addr = mmap(nullptr, PAGES * page_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    REQUIRE(addr != MAP_FAILED);
+    pfs::impl::defer unmap([&] { munmap(addr, PAGES * page_size); });
+
+    auto bytes = static_cast<char*>(addr);
+    for (size_t i = 0; i < PAGES; ++i)
+    {
+        bytes[i * page_size] = 1;
+    }
+
+    pfs::mem_region region;
+    region.start_address = reinterpret_cast<size_t>(addr);
+    region.end_address   = region.start_address + PAGES * page_size;
+
+    auto self    = pfs::procfs().get_task();
+    auto pagemap = self.get_pagemap();
+
+    // New mappings are always soft-dirty, unless the kernel was built
+    // without CONFIG_MEM_SOFT_DIRTY.
+    if (!pagemap.read(region)[0].is_soft_dirty())
+    {
+        WARN("Soft-dirty bits are not supported by the kernel");
+        return;
+    }
+
+    self.clear_refs(pfs::clear_refs_mode::soft_dirty);
+
+    // Dirty pages 1, 2 and 5
+    bytes[1 * page_size] = 'a';
+    bytes[2 * page_size] = 'b';
+    bytes[5 * page_size] = 'c';
+
+    SECTION("Separate runs")
+    {
+        auto dirty = pagemap.read_soft_dirty(region);
+        REQUIRE(dirty.size() == 2);
+        REQUIRE(dirty[0].start_address == region.start_address + 1 * page_size);
+        REQUIRE(dirty[0].end_address == region.start_address + 3 * page_size);
+        REQUIRE(dirty[1].start_address == region.start_address + 5 * page_size);
+        REQUIRE(dirty[1].end_address == region.start_address + 6 * page_size);
+
+        auto buffers = self.get_mem().read(dirty);
+        REQUIRE(buffers.size() == 2);
+        REQUIRE(buffers[0].size() == 2 * page_size);
+        REQUIRE(buffers[0][0] == 'a');
+        REQUIRE(buffers[0][page_size] == 'b');
+        REQUIRE(buffers[1].size() == page_size);
+        REQUIRE(buffers[1][0] == 'c');
+    }
+
+    SECTION("Merged runs")
+    {
+        auto dirty = pagemap.read_soft_dirty(region, 2 /* max_gap_pages */);
+        REQUIRE(dirty.size() == 1);
+        REQUIRE(dirty[0].start_address == region.start_address + 1 * page_size);
+        REQUIRE(dirty[0].end_address == region.start_address + 6 * page_size);
+    }
+}
@@ -1,8 +1,11 @@
 #include "catch.hpp"
+#include "test_utils.hpp"
 
 #include <cstdlib>
 #include <numeric>
+#include <sstream>
 
+#include "pfs/parser_error.hpp"
 #include "pfs/procfs.hpp"
 
 TEST_CASE("Parse stat", "[procfs][proc_stat]")
@@ -34,3 +37,127 @@ TEST_CASE("Parse stat", "[procfs][proc_stat]")
         REQUIRE(sum == stats.softirq.total);
     }
 }
+
+namespace {
+
+std::string build_stat_file(size_t cpus, size_t irqs)
+{
+    std::ostringstream out;
+    out << "cpu  100 2 30 4000 5 0 6 0 0 0\n";
+    for (size_t i = 0; i < cpus; ++i)
+    {
+        out << "cpu" << i << " " << (10 + i) << " 1 3 400 1 0 1 0 0 0\n";
+    }
+
+    out << "intr " << irqs * (irqs + 1) / 2;
+    for (size_t i = 1; i <= irqs; ++i)
+    {
+        out << " " << i;
+    }
+    out << "\n";
+
+    out << "ctxt 1953372737\n"
+           "btime 1688388813\n"
+           "processes 4164913\n"
+           "procs_running 2\n"
+           "procs_blocked 1\n"
+           "softirq 10 1 2 3 4\n";
+    return out.str();
+}
+
+} // anonymous namespace
+
+TEST_CASE("Parse stat file", "[procfs][proc_stat]")
+{
+    static const size_t CPUS = 4;
+    // Spans several read chunks
+    static const size_t IRQS = 8000;
+
+    temp_dir dir;
+    dir.create_file("stat", build_stat_file(CPUS, IRQS));
+
+    pfs::procfs procfs(dir.get_root());
+
+    SECTION("All sections")
+    {
+        auto stats = procfs.get_stat();
+
+        REQUIRE(stats.cpus.total.user == 100);
+        REQUIRE(stats.cpus.total.idle == 4000);
+        REQUIRE(stats.cpus.total.softirq == 6);
+        REQUIRE(stats.cpus.per_item.size() == CPUS);
+        REQUIRE(stats.cpus.per_item[3].user == 13);
+        REQUIRE(stats.cpus.per_item[3].id == 3);
+        REQUIRE(stats.cpus.total.id == -1);
+
+        REQUIRE(stats.intr.total == IRQS * (IRQS + 1) / 2);
+        REQUIRE(stats.intr.per_item.size() == IRQS);
+        REQUIRE(stats.intr.per_item.back() == IRQS);
+        REQUIRE(std::accumulate(stats.intr.per_item.begin(),
+                                stats.intr.per_item.end(),
+                                0ULL) == stats.intr.total);
+
+        REQUIRE(stats.ctxt == 1953372737);
+        REQUIRE(stats.btime ==
+                std::chrono::system_clock::from_time_t(1688388813));
+        REQUIRE(stats.processes == 4164913);
+        REQUIRE(stats.procs_running == 2);
+        REQUIRE(stats.procs_blocked == 1);
+        REQUIRE(stats.softirq.total == 10);
+        REQUIRE(stats.softirq.per_item.size() == 4);
+    }
+
+    SECTION("Skip sections")
+    {
+        unsigned sections = pfs::proc_stat::section::CPUS |
+                            pfs::proc_stat::section::PROCS;
+        auto stats = procfs.get_stat(sections);
+
+        REQUIRE(stats.cpus.per_item.size() == CPUS);
+        REQUIRE(stats.procs_running == 2);
+        REQUIRE(stats.intr.total == 0);
+        REQUIRE(stats.intr.per_item.empty());
+        REQUIRE(stats.softirq.per_item.empty());
+        REQUIRE(stats.ctxt == 0);
+    }
+
+    SECTION("Reuse output")
+    {
+        pfs::proc_stat stats;
+        procfs.get_stat(stats);
+        auto capacity = stats.intr.per_item.capacity();
+        auto data     = stats.intr.per_item.data();
+
+        procfs.get_stat(stats);
+        REQUIRE(stats.intr.per_item.size() == IRQS);
+        REQUIRE(stats.intr.per_item.capacity() == capacity);
+        REQUIRE(stats.intr.per_item.data() == data);
+
+        // Fewer CPUs, such as after taking some offline
+        dir.create_file("stat", build_stat_file(CPUS - 2, IRQS));
+        procfs.get_stat(stats, pfs::proc_stat::section::CPUS);
+        REQUIRE(stats.cpus.per_item.size() == CPUS - 2);
+        REQUIRE(stats.intr.per_item.empty());
+    }
+
+    SECTION("Corrupted")
+    {
+        dir.create_file("stat", "cpu  100 2 30\n");
+        REQUIRE_THROWS_AS(procfs.get_stat(), pfs::parser_error);
+
+        dir.create_file("stat", "cpu  100 2 30 4000 5 0 6 0 0 0 1\n");
+        REQUIRE_THROWS_AS(procfs.get_stat(), pfs::parser_error);
+
+        dir.create_file("stat", "cpux 100 2 30 4000\n");
+        REQUIRE_THROWS_AS(procfs.get_stat(), pfs::parser_error);
+
+        dir.create_file("stat", "ctxt 12x\n");
+        REQUIRE_THROWS_AS(procfs.get_stat(), pfs::parser_error);
+
+        dir.create_file("stat", "procs_running 1 2\n");
+        REQUIRE_THROWS_AS(procfs.get_stat(), pfs::parser_error);
+
+        // Not parsed, so not validated
+        REQUIRE_NOTHROW(procfs.get_stat(pfs::proc_stat::section::CPUS));
+    }
+}
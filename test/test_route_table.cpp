@@ -0,0 +1,209 @@
+#include <arpa/inet.h>
+#include <net/route.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+#include "pfs/procfs.hpp"
+#include "pfs/route_table.hpp"
+
+namespace {
+
+pfs::ip make_ipv4(const std::string& str)
+{
+    in_addr addr;
+    REQUIRE(inet_pton(AF_INET, str.c_str(), &addr) == 1);
+    return pfs::ip(static_cast<pfs::ipv4>(addr.s_addr));
+}
+
+pfs::ip make_ipv6(const std::string& str)
+{
+    pfs::ipv6 raw;
+    REQUIRE(inet_pton(AF_INET6, str.c_str(), raw.data()) == 1);
+    return pfs::ip(raw);
+}
+
+pfs::net_route make_route(const std::string& iface,
+                          const std::string& destination,
+                          const std::string& mask,
+                          const std::string& gateway = "0.0.0.0",
+                          int metric = 0)
+{
+    pfs::net_route route;
+    route.iface       = iface;
+    route.destination = make_ipv4(destination);
+    route.gateway     = make_ipv4(gateway);
+    route.mask        = make_ipv4(mask);
+    route.flags       = RTF_UP;
+    route.refcnt      = 0;
+    route.use         = 0;
+    route.metric      = metric;
+    route.mtu         = 0;
+    route.window      = 0;
+    route.irtt        = 0;
+    return route;
+}
+
+pfs::net_ipv6_route make_ipv6_route(const std::string& iface,
+                                    const std::string& destination,
+                                    unsigned prefix_len,
+                                    const std::string& next_hop = "::")
+{
+    pfs::net_ipv6_route route;
+    route.destination            = make_ipv6(destination);
+    route.destination_prefix_len = prefix_len;
+    route.source                 = make_ipv6("::");
+    route.source_prefix_len      = 0;
+    route.next_hop               = make_ipv6(next_hop);
+    route.metric                 = 256;
+    route.refcnt                 = 0;
+    route.use                    = 0;
+    route.flags                  = RTF_UP;
+    route.iface                  = iface;
+    return route;
+}
+
+std::string iface_of(const pfs::route_table& table, const pfs::ip& addr)
+{
+    auto route = table.lookup(addr);
+    return route ? route->iface : "";
+}
+
+} // anonymous namespace
+
+TEST_CASE("Route table IPv4 lookup", "[net][route_table]")
+{
+    std::vector<pfs::net_route> routes = {
+        make_route("eth0", "0.0.0.0", "0.0.0.0", "192.0.2.1"),
+        make_route("eth0", "192.0.2.0", "255.255.255.0"),
+        make_route("eth1", "10.0.0.0", "255.0.0.0"),
+        make_route("eth2", "10.1.0.0", "255.255.0.0"),
+        make_route("eth3", "10.1.2.0", "255.255.254.0"),
+        make_route("eth4", "10.1.2.128", "255.255.255.128"),
+        make_route("eth5", "10.1.2.130", "255.255.255.255"),
+    };
+
+    // Inserting longer prefixes first must not matter
+    std::reverse(routes.begin(), routes.end());
+
+    pfs::route_table table(routes);
+    REQUIRE(table.routes().size() == routes.size());
+
+    REQUIRE(iface_of(table, make_ipv4("8.8.8.8")) == "eth0");
+    REQUIRE(table.lookup(make_ipv4("8.8.8.8"))->gateway ==
+            make_ipv4("192.0.2.1"));
+    REQUIRE(table.lookup(make_ipv4("8.8.8.8"))->prefix_len == 0);
+
+    REQUIRE(iface_of(table, make_ipv4("192.0.2.77")) == "eth0");
+    REQUIRE(table.lookup(make_ipv4("192.0.2.77"))->prefix_len == 24);
+
+    REQUIRE(iface_of(table, make_ipv4("10.200.0.1")) == "eth1");
+    REQUIRE(iface_of(table, make_ipv4("10.1.200.1")) == "eth2");
+    REQUIRE(iface_of(table, make_ipv4("10.1.3.1")) == "eth3");
+    REQUIRE(iface_of(table, make_ipv4("10.1.2.127")) == "eth3");
+    REQUIRE(iface_of(table, make_ipv4("10.1.2.129")) == "eth4");
+    REQUIRE(iface_of(table, make_ipv4("10.1.2.130")) == "eth5");
+    REQUIRE(iface_of(table, make_ipv4("10.1.2.131")) == "eth4");
+    REQUIRE(iface_of(table, make_ipv4("10.1.4.1")) == "eth2");
+
+    // No IPv6 routes
+    REQUIRE(table.lookup(make_ipv6("2001:db8::1")) == nullptr);
+    REQUIRE(table.lookup(pfs::ip()) == nullptr);
+
+    SECTION("Batch")
+    {
+        std::vector<pfs::ip> destinations;
+        for (int i = 0; i < 64; ++i)
+        {
+            destinations.push_back(make_ipv4("10.1.2." + std::to_string(i * 4)));
+        }
+
+        std::vector<const pfs::route_entry*> out;
+        table.lookup(destinations, out);
+        REQUIRE(out.size() == destinations.size());
+
+        size_t mismatches = 0;
+        for (size_t i = 0; i < destinations.size(); ++i)
+        {
+            mismatches += (out[i] != table.lookup(destinations[i])) ? 1 : 0;
+        }
+        REQUIRE(mismatches == 0);
+    }
+}
+
+TEST_CASE("Route table picks the lowest metric", "[net][route_table]")
+{
+    std::vector<pfs::net_route> routes = {
+        make_route("eth1", "0.0.0.0", "0.0.0.0", "192.0.2.1", 600),
+        make_route("eth0", "0.0.0.0", "0.0.0.0", "198.51.100.1", 100),
+        make_route("eth2", "0.0.0.0", "0.0.0.0", "203.0.113.1", 100),
+    };
+
+    // A route that is down
+    routes.push_back(make_route("eth3", "8.8.8.0", "255.255.255.0"));
+    routes.back().flags = 0;
+
+    pfs::route_table table(routes);
+    REQUIRE(table.routes().size() == 3);
+    REQUIRE(iface_of(table, make_ipv4("8.8.8.8")) == "eth0");
+
+    SECTION("Non-contiguous mask")
+    {
+        routes.push_back(make_route("eth4", "10.0.0.0", "255.0.255.0"));
+        REQUIRE_THROWS_AS(pfs::route_table(routes), std::invalid_argument);
+    }
+}
+
+TEST_CASE("Route table IPv6 lookup", "[net][route_table]")
+{
+    std::vector<pfs::net_ipv6_route> routes = {
+        make_ipv6_route("eth0", "::", 0, "fe80::1"),
+        make_ipv6_route("eth1", "2001:db8::", 32),
+        make_ipv6_route("eth2", "2001:db8:1::", 48),
+        make_ipv6_route("eth3", "2001:db8:1:2::", 63),
+        make_ipv6_route("lo", "2001:db8:1:2::5", 128),
+        make_ipv6_route("eth4", "fe80::", 10),
+    };
+
+    pfs::route_table table({}, routes);
+
+    REQUIRE(iface_of(table, make_ipv6("2606:4700::1")) == "eth0");
+    REQUIRE(table.lookup(make_ipv6("2606:4700::1"))->gateway ==
+            make_ipv6("fe80::1"));
+    REQUIRE(iface_of(table, make_ipv6("2001:db8:ffff::1")) == "eth1");
+    REQUIRE(iface_of(table, make_ipv6("2001:db8:1:ffff::1")) == "eth2");
+    REQUIRE(iface_of(table, make_ipv6("2001:db8:1:2::4")) == "eth3");
+    REQUIRE(iface_of(table, make_ipv6("2001:db8:1:3::4")) == "eth3");
+    REQUIRE(iface_of(table, make_ipv6("2001:db8:1:4::4")) == "eth2");
+    REQUIRE(iface_of(table, make_ipv6("2001:db8:1:2::5")) == "lo");
+    REQUIRE(iface_of(table, make_ipv6("febf::1")) == "eth4");
+    REQUIRE(iface_of(table, make_ipv6("fec0::1")) == "eth0");
+
+    // No IPv4 routes
+    REQUIRE(table.lookup(make_ipv4("10.0.0.1")) == nullptr);
+}
+
+TEST_CASE("Route table of current namespace", "[net][route_table]")
+{
+    auto net   = pfs::procfs().get_net();
+    auto table = net.get_route_table();
+
+    for (const auto& route : net.get_route())
+    {
+        if (!(route.flags & RTF_UP))
+        {
+            continue;
+        }
+
+        // The route's own network always resolves to at least as specific
+        auto found = table.lookup(route.destination);
+        REQUIRE(found != nullptr);
+        REQUIRE(found->prefix_len >=
+                static_cast<unsigned>(__builtin_popcount(route.mask.storage[0])));
+    }
+}
@@ -0,0 +1,147 @@
+#include <algorithm>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+#include "pfs/parsers/smaps.hpp"
+#include "pfs/parser_error.hpp"
+#include "pfs/procfs.hpp"
+
+using namespace pfs::impl::parsers;
+
+TEST_CASE("Identify smaps header", "[task][smaps]")
+{
+    REQUIRE(is_smaps_header_line(
+        "55741c5bc000-55741c5be000 r--p 00000000 fe:00 467394 /usr/bin/head"));
+    REQUIRE(is_smaps_header_line("7f0b476b9000-7f0b476be000 rw-p 00000000 00:00 0"));
+    REQUIRE_FALSE(is_smaps_header_line("Size:                  8 kB"));
+    REQUIRE_FALSE(is_smaps_header_line("VmFlags: rd mr mw me"));
+}
+
+TEST_CASE("Parse corrupted smaps", "[task][smaps]")
+{
+    pfs::smaps_region region;
+
+    SECTION("Missing key")
+    {
+        REQUIRE_THROWS_AS(parse_smaps_value_line("Rss", region),
+                          pfs::parser_error);
+    }
+
+    SECTION("Missing value")
+    {
+        REQUIRE_THROWS_AS(parse_smaps_value_line("Rss:    kB", region),
+                          pfs::parser_error);
+    }
+}
+
+TEST_CASE("Parse smaps", "[task][smaps]")
+{
+    pfs::smaps_region region;
+
+    parse_smaps_value_line("Size:                 24 kB", region);
+    parse_smaps_value_line("Rss:                  20 kB", region);
+    parse_smaps_value_line("Pss:                  10 kB", region);
+    parse_smaps_value_line("Pss_Dirty:             4 kB", region);
+    parse_smaps_value_line("Shared_Clean:         16 kB", region);
+    parse_smaps_value_line("Private_Dirty:         4 kB", region);
+    parse_smaps_value_line("Swap:                  8 kB", region);
+    parse_smaps_value_line("SwapPss:               2 kB", region);
+    parse_smaps_value_line("THPeligible:           0", region);
+    parse_smaps_value_line("VmFlags: rd mr mw me", region);
+
+    REQUIRE(region.size == 24);
+    REQUIRE(region.rss == 20);
+    REQUIRE(region.pss == 10);
+    REQUIRE(region.shared_clean == 16);
+    REQUIRE(region.shared_dirty == 0);
+    REQUIRE(region.private_clean == 0);
+    REQUIRE(region.private_dirty == 4);
+    REQUIRE(region.swap == 8);
+    REQUIRE(region.swap_pss == 2);
+}
+
+TEST_CASE("Read smaps", "[task][smaps]")
+{
+    auto task  = pfs::procfs().get_task();
+    auto maps  = task.get_maps();
+    auto smaps = task.get_smaps();
+
+    REQUIRE(!smaps.empty());
+    REQUIRE(smaps.front().region.start_address == maps.front().start_address);
+    REQUIRE(smaps.front().size * 1024 == smaps.front().region.end_address -
+                                             smaps.front().region.start_address);
+}
+
+TEST_CASE("Group mapped objects", "[procfs][smaps]")
+{
+    auto exe = pfs::procfs().get_task().get_maps().front();
+    REQUIRE(exe.inode != pfs::INVALID_INODE);
+
+    pfs::procfs::mapping_source source;
+
+    SECTION("Using maps")
+    {
+        source = pfs::procfs::mapping_source::maps;
+    }
+
+    SECTION("Using smaps")
+    {
+        source = pfs::procfs::mapping_source::smaps;
+    }
+
+    auto objects = pfs::procfs().get_mapped_objects(source, 2);
+
+    auto iter = std::find_if(objects.begin(), objects.end(),
+                             [&exe](const pfs::mapped_object& object) {
+                                 return object.device == exe.device &&
+                                        object.inode == exe.inode;
+                             });
+    REQUIRE(iter != objects.end());
+    REQUIRE(iter->mappers >= 1);
+    REQUIRE(iter->pathname == exe.pathname);
+    REQUIRE(iter->mapped_bytes >= exe.end_address - exe.start_address);
+
+    if (source == pfs::procfs::mapping_source::smaps)
+    {
+        REQUIRE(iter->rss_bytes == iter->private_bytes + iter->shared_bytes);
+        REQUIRE(iter->pss_bytes <= iter->rss_bytes);
+        REQUIRE(iter->pss_bytes == iter->unique_bytes + iter->shared_pss_bytes);
+        REQUIRE(iter->unique_bytes <= iter->private_bytes);
+    }
+}
+
+TEST_CASE("Group mapped objects of a fake procfs", "[procfs][smaps]")
+{
+    static const std::string HEADER =
+        "7f0b476b9000-7f0b476be000 r-xp 00000000 fe:00 467394 /usr/lib/libc.so\n";
+
+    temp_dir dir;
+
+    // Both processes map 8 kB shared with each other, and 4 kB of their own
+    dir.create_file("1/smaps", HEADER + "Rss:                  12 kB\n"
+                                       "Pss:                   8 kB\n"
+                                       "Shared_Clean:          8 kB\n"
+                                       "Private_Dirty:         4 kB\n"
+                                       "SwapPss:               2 kB\n");
+    dir.create_file("2/smaps", HEADER + "Rss:                  12 kB\n"
+                                       "Pss:                   8 kB\n"
+                                       "Shared_Clean:          8 kB\n"
+                                       "Private_Clean:         4 kB\n");
+
+    auto objects = pfs::procfs(dir.get_root()).get_mapped_objects(
+        pfs::procfs::mapping_source::smaps, 2);
+    REQUIRE(objects.size() == 1);
+
+    const auto& object = objects[0];
+    REQUIRE(object.pathname == "/usr/lib/libc.so");
+    REQUIRE(object.mappers == 2);
+    REQUIRE(object.mapped_bytes == 2 * 0x5000);
+    REQUIRE(object.rss_bytes == 24 * 1024);
+    REQUIRE(object.pss_bytes == 16 * 1024);
+    REQUIRE(object.unique_bytes == 8 * 1024);
+    REQUIRE(object.shared_pss_bytes == 8 * 1024);
+    REQUIRE(object.swap_pss_bytes == 2 * 1024);
+    REQUIRE(object.private_bytes == 8 * 1024);
+    REQUIRE(object.shared_bytes == 16 * 1024);
+}
@@ -0,0 +1,362 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "catch.hpp"
+#include "test_utils.hpp"
+
+#include "pfs/defer.hpp"
+#include "pfs/procfs.hpp"
+#include "pfs/sock_diag.hpp"
+
+namespace {
+
+struct bound_socket
+{
+    int fd;
+    uint16_t port;
+    ino_t inode;
+};
+
+bound_socket bind_loopback(int type)
+{
+    bound_socket sock;
+    sock.fd = socket(AF_INET, type, 0);
+    REQUIRE(sock.fd >= 0);
+
+    sockaddr_in addr     = {};
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    REQUIRE(bind(sock.fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) ==
+            0);
+
+    socklen_t len = sizeof(addr);
+    REQUIRE(getsockname(sock.fd, reinterpret_cast<sockaddr*>(&addr), &len) ==
+            0);
+    sock.port = ntohs(addr.sin_port);
+
+    struct stat st;
+    REQUIRE(fstat(sock.fd, &st) == 0);
+    sock.inode = st.st_ino;
+
+    return sock;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Build sock_diag bytecode", "[net][sock_diag]")
+{
+    pfs::net_socket_query query;
+
+    SECTION("Empty")
+    {
+        REQUIRE(pfs::impl::sock_diag::build_inet_bytecode(query).empty());
+    }
+
+    SECTION("Ports and addresses")
+    {
+        query.local_ports = {80, 443};
+        query.remote_ips  = {pfs::ip(pfs::ipv4(htonl(INADDR_LOOPBACK)))};
+
+        auto bytecode = pfs::impl::sock_diag::build_inet_bytecode(query);
+
+        // Every port is a pair of 8-byte comparisons followed by a jump,
+        // and the IPv4 address is a host condition followed by a jump.
+        size_t expected = 2 * (8 + 8 + 4) +
+                          (4 + sizeof(inet_diag_hostcond) + 4 + 4);
+        REQUIRE(bytecode.size() == expected);
+
+        // Every 'yes' offset points to the next operation
+        auto first = reinterpret_cast<const inet_diag_bc_op*>(bytecode.data());
+        REQUIRE(first->code == INET_DIAG_BC_S_GE);
+        REQUIRE(first->yes == 8);
+        REQUIRE(first->no == 20); // The next port
+    }
+}
+
+TEST_CASE("Collect TCP sockets using sock_diag", "[net][sock_diag]")
+{
+    auto sock = bind_loopback(SOCK_STREAM);
+    pfs::impl::defer close_sock([&sock] { close(sock.fd); });
+    REQUIRE(listen(sock.fd, 16) == 0);
+
+    auto net = pfs::procfs().get_net();
+
+    pfs::net_socket_query query;
+    query.local_ports = {sock.port};
+
+    net.set_backend(pfs::net::backend::procfs);
+    auto expected = net.get_tcp(query);
+    REQUIRE(expected.size() == 1);
+
+    net.set_backend(pfs::net::backend::sock_diag);
+    auto sockets = net.get_tcp(query);
+    REQUIRE(sockets.size() == 1);
+
+    auto& socket = sockets.front();
+    REQUIRE(socket.inode == sock.inode);
+    REQUIRE(socket.local_ip == expected.front().local_ip);
+    REQUIRE(socket.local_port == sock.port);
+    REQUIRE(socket.remote_ip == expected.front().remote_ip);
+    REQUIRE(socket.socket_net_state == pfs::net_socket::net_state::listen);
+    REQUIRE(socket.uid == expected.front().uid);
+    REQUIRE(socket.tx_queue == expected.front().tx_queue);
+
+    SECTION("Filter by state")
+    {
+        query.states = {pfs::net_socket::net_state::established};
+        REQUIRE(net.get_tcp(query).empty());
+    }
+
+    SECTION("Filter by address")
+    {
+        query.local_ips = {pfs::ip(pfs::ipv4(htonl(INADDR_LOOPBACK)))};
+        REQUIRE(net.get_tcp(query).size() == 1);
+
+        query.local_ips = {pfs::ip(pfs::ipv4(htonl(INADDR_LOOPBACK + 1)))};
+        REQUIRE(net.get_tcp(query).empty());
+    }
+
+    SECTION("Filter by remote port")
+    {
+        query.remote_ports = {1};
+        REQUIRE(net.get_tcp(query).empty());
+    }
+
+    SECTION("Filter in user-space")
+    {
+        auto none = [](const pfs::net_socket&) {
+            return pfs::filter::action::drop;
+        };
+        REQUIRE(net.get_tcp(query, none).empty());
+    }
+
+    SECTION("Unfiltered")
+    {
+        auto all = net.get_tcp();
+        auto iter =
+            std::find_if(all.begin(), all.end(), [&sock](const pfs::net_socket& s) {
+                return s.inode == sock.inode;
+            });
+        REQUIRE(iter != all.end());
+    }
+}
+
+TEST_CASE("Skip bound TCP sockets that don't listen", "[net][sock_diag]")
+{
+    auto sock = bind_loopback(SOCK_STREAM);
+    pfs::impl::defer close_sock([&sock] { close(sock.fd); });
+
+    auto net = pfs::procfs().get_net();
+
+    pfs::net_socket_query query;
+    query.local_ports = {sock.port};
+
+    SECTION("procfs")
+    {
+        net.set_backend(pfs::net::backend::procfs);
+    }
+
+    SECTION("sock_diag")
+    {
+        net.set_backend(pfs::net::backend::sock_diag);
+    }
+
+    REQUIRE(net.get_tcp(query).empty());
+
+    auto all = net.get_tcp();
+    REQUIRE(std::find_if(all.begin(), all.end(),
+                         [&sock](const pfs::net_socket& s) {
+                             return s.inode == sock.inode;
+                         }) == all.end());
+}
+
+TEST_CASE("Collect TCP sockets into a table", "[net][sock_diag]")
+{
+    auto sock = bind_loopback(SOCK_STREAM);
+    pfs::impl::defer close_sock([&sock] { close(sock.fd); });
+    REQUIRE(listen(sock.fd, 16) == 0);
+
+    auto net = pfs::procfs().get_net();
+
+    pfs::net_socket_query query;
+    query.local_ports = {sock.port};
+
+    pfs::net_socket_table table;
+    table.push_back(pfs::net_socket()); // Replaced by the collection
+
+    SECTION("procfs")
+    {
+        net.set_backend(pfs::net::backend::procfs);
+    }
+
+    SECTION("sock_diag")
+    {
+        net.set_backend(pfs::net::backend::sock_diag);
+    }
+
+    net.collect_tcp(table, query);
+    REQUIRE(table.size() == 1);
+    REQUIRE(table.inode[0] == sock.inode);
+    REQUIRE(table.local_port[0] == sock.port);
+    REQUIRE(table.socket_net_state[0] == pfs::net_socket::net_state::listen);
+
+    net.collect_tcp(table);
+    REQUIRE(std::find(table.inode.begin(), table.inode.end(), sock.inode) !=
+            table.inode.end());
+}
+
+TEST_CASE("Query sockets by uid", "[net][sock_diag]")
+{
+    auto sock = bind_loopback(SOCK_STREAM);
+    pfs::impl::defer close_sock([&sock] { close(sock.fd); });
+    REQUIRE(listen(sock.fd, 16) == 0);
+
+    auto net = pfs::procfs().get_net();
+
+    SECTION("procfs")
+    {
+        net.set_backend(pfs::net::backend::procfs);
+    }
+
+    SECTION("sock_diag")
+    {
+        net.set_backend(pfs::net::backend::sock_diag);
+    }
+
+    pfs::net_socket_query query;
+    query.states      = {pfs::net_socket::net_state::listen};
+    query.local_ports = {sock.port};
+    query.uids        = {geteuid()};
+
+    auto sockets = net.get_tcp(query);
+    REQUIRE(sockets.size() == 1);
+    REQUIRE(sockets.front().inode == sock.inode);
+
+    query.uids = {geteuid() + 1};
+    REQUIRE(net.get_tcp(query).empty());
+
+    pfs::net_socket_table table;
+    net.collect_tcp(table, query);
+    REQUIRE(table.empty());
+}
+
+TEST_CASE("Collect UDP sockets using automatic backend", "[net][sock_diag]")
+{
+    auto sock = bind_loopback(SOCK_DGRAM);
+    pfs::impl::defer close_sock([&sock] { close(sock.fd); });
+
+    pfs::net_socket_query query;
+    query.local_ports = {sock.port};
+
+    auto sockets = pfs::procfs().get_net().get_udp(query);
+    REQUIRE(sockets.size() == 1);
+    REQUIRE(sockets.front().inode == sock.inode);
+}
+
+TEST_CASE("Collect unix sockets using sock_diag", "[net][sock_diag]")
+{
+    temp_dir dir;
+    auto path = dir.get_root() + "/listener";
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    REQUIRE(listener >= 0);
+    pfs::impl::defer close_listener([listener] { close(listener); });
+
+    sockaddr_un addr = {};
+    addr.sun_family  = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    REQUIRE(bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) ==
+            0);
+    REQUIRE(listen(listener, 8) == 0);
+
+    // Leave the connection pending, without accepting it
+    int client = socket(AF_UNIX, SOCK_STREAM, 0);
+    REQUIRE(client >= 0);
+    pfs::impl::defer close_client([client] { close(client); });
+    REQUIRE(connect(client, reinterpret_cast<sockaddr*>(&addr),
+                    sizeof(addr)) == 0);
+
+    struct stat listener_st;
+    REQUIRE(fstat(listener, &listener_st) == 0);
+    struct stat client_st;
+    REQUIRE(fstat(client, &client_st) == 0);
+    struct stat path_st;
+    REQUIRE(stat(path.c_str(), &path_st) == 0);
+
+    auto net = pfs::procfs().get_net();
+    net.set_backend(pfs::net::backend::sock_diag);
+
+    pfs::unix_socket_query query;
+    query.states     = {pfs::net_socket::net_state::listen};
+    query.show_peer  = true;
+    query.show_rqlen = true;
+    query.show_vfs   = true;
+
+    auto find = [](const std::vector<pfs::unix_socket>& sockets, ino_t inode) {
+        return std::find_if(sockets.begin(), sockets.end(),
+                            [inode](const pfs::unix_socket& socket) {
+                                return socket.inode == inode;
+                            });
+    };
+
+    auto listening = net.get_unix(query);
+    REQUIRE(find(listening, client_st.st_ino) == listening.end());
+
+    auto iter = find(listening, listener_st.st_ino);
+    REQUIRE(iter != listening.end());
+    REQUIRE(iter->path == path);
+    REQUIRE(iter->socket_state == pfs::unix_socket::state::unconnected);
+    REQUIRE(iter->rqueue == 1);
+    REQUIRE(iter->wqueue == 8);
+    REQUIRE(iter->pending_connections.size() == 1);
+    REQUIRE(iter->vfs_inode == path_st.st_ino);
+
+    SECTION("Peers")
+    {
+        int pair[2];
+        REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0);
+        pfs::impl::defer close_pair([&pair] {
+            close(pair[0]);
+            close(pair[1]);
+        });
+
+        struct stat first;
+        REQUIRE(fstat(pair[0], &first) == 0);
+        struct stat second;
+        REQUIRE(fstat(pair[1], &second) == 0);
+
+        query.states   = {pfs::net_socket::net_state::established};
+        auto connected = net.get_unix(query);
+
+        auto first_iter = find(connected, first.st_ino);
+        REQUIRE(first_iter != connected.end());
+        REQUIRE(first_iter->socket_state ==
+                pfs::unix_socket::state::connected);
+        REQUIRE(first_iter->peer_inode == second.st_ino);
+
+        REQUIRE(find(connected, client_st.st_ino) != connected.end());
+    }
+
+    SECTION("Same as procfs")
+    {
+        net.set_backend(pfs::net::backend::procfs);
+
+        auto text      = net.get_unix(query);
+        auto text_iter = find(text, listener_st.st_ino);
+        REQUIRE(text_iter != text.end());
+        REQUIRE(text_iter->path == path);
+        REQUIRE(text_iter->socket_type == iter->socket_type);
+        REQUIRE(text_iter->socket_state == iter->socket_state);
+        REQUIRE(text_iter->flags == iter->flags);
+        REQUIRE(text_iter->vfs_inode == pfs::INVALID_INODE);
+
+        REQUIRE(find(text, client_st.st_ino) == text.end());
+    }
+}
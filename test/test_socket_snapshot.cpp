@@ -0,0 +1,181 @@
+#include <arpa/inet.h>
+
+#include "catch.hpp"
+
+#include "pfs/socket_snapshot.hpp"
+
+namespace {
+
+pfs::net_socket make_socket(uint32_t local_ip, uint16_t local_port,
+                            uint32_t remote_ip, uint16_t remote_port,
+                            ino_t inode)
+{
+    pfs::net_socket sock;
+    sock.local_ip        = pfs::ip(pfs::ipv4(htonl(local_ip)));
+    sock.local_port      = local_port;
+    sock.remote_ip       = pfs::ip(pfs::ipv4(htonl(remote_ip)));
+    sock.remote_port     = remote_port;
+    sock.inode           = inode;
+    return sock;
+}
+
+pfs::ip make_ip(uint32_t addr)
+{
+    return pfs::ip(pfs::ipv4(htonl(addr)));
+}
+
+} // anonymous namespace
+
+TEST_CASE("Socket snapshot", "[net][socket_snapshot]")
+{
+    static const uint32_t ANY       = 0;
+    static const uint32_t LOOPBACK  = 0x7f000001;
+    static const uint32_t REMOTE    = 0x0a000002;
+    static const uint16_t HTTP_PORT = 80;
+
+    std::vector<pfs::net_socket> sockets = {
+        make_socket(ANY, HTTP_PORT, ANY, 0, 100),
+        make_socket(LOOPBACK, HTTP_PORT, REMOTE, 50000, 101),
+        make_socket(LOOPBACK, HTTP_PORT, REMOTE, 50001, 102),
+        make_socket(LOOPBACK, 53, ANY, 0, 103),
+        make_socket(LOOPBACK, 8080, REMOTE, 50002, 0), // TIME_WAIT
+    };
+
+    pfs::unix_socket unix_sock;
+    unix_sock.inode            = 200;
+    unix_sock.path             = "/run/test.sock";
+
+    pfs::socket_snapshot snapshot(sockets, {unix_sock});
+    REQUIRE(snapshot.sockets().size() == sockets.size());
+    REQUIRE(snapshot.unix_sockets().size() == 1);
+
+    SECTION("By inode")
+    {
+        for (const auto& sock : sockets)
+        {
+            if (sock.inode == 0)
+            {
+                REQUIRE(snapshot.find_by_inode(sock.inode) == nullptr);
+                continue;
+            }
+
+            auto found = snapshot.find_by_inode(sock.inode);
+            REQUIRE(found != nullptr);
+            REQUIRE(found->inode == sock.inode);
+        }
+
+        REQUIRE(snapshot.find_by_inode(999) == nullptr);
+        REQUIRE(snapshot.find_by_inode(200) == nullptr);
+
+        auto found = snapshot.find_unix_by_inode(200);
+        REQUIRE(found != nullptr);
+        REQUIRE(found->path == unix_sock.path);
+        REQUIRE(snapshot.find_unix_by_inode(100) == nullptr);
+    }
+
+    SECTION("By local address")
+    {
+        auto found = snapshot.find_by_local(make_ip(LOOPBACK), HTTP_PORT);
+        REQUIRE(found != nullptr);
+        REQUIRE(found->inode == 101);
+
+        // Falls back to the wildcard listener
+        found = snapshot.find_by_local(make_ip(REMOTE), HTTP_PORT);
+        REQUIRE(found != nullptr);
+        REQUIRE(found->inode == 100);
+
+        REQUIRE(snapshot.find_by_local(make_ip(LOOPBACK), 443) == nullptr);
+
+        std::vector<ino_t> inodes;
+        auto count = snapshot.for_each_local(
+            make_ip(LOOPBACK), HTTP_PORT,
+            [&inodes](const pfs::net_socket& sock) {
+                inodes.push_back(sock.inode);
+            });
+        REQUIRE(count == 2);
+        REQUIRE(inodes == std::vector<ino_t>{101, 102});
+
+        REQUIRE(snapshot.for_each_local(make_ip(ANY), HTTP_PORT, nullptr) ==
+                1);
+    }
+
+    SECTION("By 4-tuple")
+    {
+        auto found = snapshot.find_by_tuple(make_ip(LOOPBACK), HTTP_PORT,
+                                            make_ip(REMOTE), 50001);
+        REQUIRE(found != nullptr);
+        REQUIRE(found->inode == 102);
+
+        found = snapshot.find_by_tuple(make_ip(LOOPBACK), 8080,
+                                       make_ip(REMOTE), 50002);
+        REQUIRE(found != nullptr);
+        REQUIRE(found->inode == 0);
+
+        REQUIRE(snapshot.find_by_tuple(make_ip(LOOPBACK), HTTP_PORT,
+                                       make_ip(REMOTE), 50003) == nullptr);
+    }
+
+    SECTION("Moved")
+    {
+        pfs::socket_snapshot moved(std::move(snapshot));
+        REQUIRE(moved.sockets().size() == sockets.size());
+        REQUIRE(moved.find_by_inode(101) != nullptr);
+        REQUIRE(moved.find_unix_by_inode(200) != nullptr);
+
+        // The moved-from snapshot is empty
+        REQUIRE(snapshot.sockets().empty());
+        REQUIRE(snapshot.find_by_inode(101) == nullptr);
+        REQUIRE(snapshot.find_unix_by_inode(200) == nullptr);
+        REQUIRE(snapshot.find_by_local(make_ip(LOOPBACK), HTTP_PORT) ==
+                nullptr);
+        REQUIRE(snapshot.find_by_tuple(make_ip(LOOPBACK), HTTP_PORT,
+                                       make_ip(REMOTE), 50000) == nullptr);
+    }
+
+    SECTION("IPv6 doesn't match IPv4")
+    {
+        pfs::ip any6(pfs::ipv6{{0, 0, 0, 0}});
+        REQUIRE(snapshot.find_by_local(any6, HTTP_PORT) == nullptr);
+    }
+}
+
+TEST_CASE("Empty socket snapshot", "[net][socket_snapshot]")
+{
+    pfs::socket_snapshot snapshot({});
+    REQUIRE(snapshot.find_by_inode(1) == nullptr);
+    REQUIRE(snapshot.find_unix_by_inode(1) == nullptr);
+    REQUIRE(snapshot.find_by_local(make_ip(0), 80) == nullptr);
+    REQUIRE(snapshot.find_by_tuple(make_ip(0), 80, make_ip(0), 0) == nullptr);
+}
+
+TEST_CASE("Large socket snapshot", "[net][socket_snapshot]")
+{
+    static const size_t COUNT = 10000;
+
+    std::vector<pfs::net_socket> sockets;
+    for (size_t i = 0; i < COUNT; ++i)
+    {
+        sockets.push_back(make_socket(0x0a000000 + (i % 100), 443,
+                                      0x0b000000 + i, 40000 + (i % 1000),
+                                      1000 + i));
+    }
+
+    pfs::socket_snapshot snapshot(std::move(sockets));
+
+    size_t found_count = 0;
+    for (size_t i = 0; i < COUNT; ++i)
+    {
+        auto found = snapshot.find_by_tuple(
+            make_ip(0x0a000000 + (i % 100)), 443, make_ip(0x0b000000 + i),
+            40000 + (i % 1000));
+        if (found && found->inode == 1000 + i &&
+            snapshot.find_by_inode(1000 + i) == found)
+        {
+            ++found_count;
+        }
+    }
+    REQUIRE(found_count == COUNT);
+
+    REQUIRE(snapshot.for_each_local(make_ip(0x0a000000), 443, nullptr) ==
+            COUNT / 100);
+}
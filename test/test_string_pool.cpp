@@ -0,0 +1,58 @@
+#include <thread>
+
+#include "catch.hpp"
+
+#include "pfs/string_pool.hpp"
+
+TEST_CASE("Intern strings", "[string_pool]")
+{
+    pfs::string_pool pool;
+
+    REQUIRE(pool.size() == 1);
+    REQUIRE(pool.intern("") == pfs::string_pool::EMPTY_ID);
+    REQUIRE(pool.get(pfs::string_pool::EMPTY_ID).empty());
+
+    auto libc = pool.intern("/usr/lib/libc.so.6");
+    auto ld   = pool.intern("/usr/lib/ld-linux-x86-64.so.2");
+    REQUIRE(libc != ld);
+    REQUIRE(libc != pfs::string_pool::EMPTY_ID);
+    REQUIRE(pool.size() == 3);
+
+    REQUIRE(pool.intern(std::string("/usr/lib/libc.so.6")) == libc);
+    REQUIRE(pool.get(libc) == "/usr/lib/libc.so.6");
+    REQUIRE(pool.get(ld) == "/usr/lib/ld-linux-x86-64.so.2");
+    REQUIRE(pool.size() == 3);
+
+    REQUIRE_THROWS_AS(pool.get(1000), std::out_of_range);
+}
+
+TEST_CASE("Intern strings concurrently", "[string_pool]")
+{
+    static const size_t THREADS = 4;
+    static const size_t STRINGS = 100;
+
+    pfs::string_pool pool;
+
+    std::vector<std::vector<pfs::string_pool::id_type>> ids(THREADS);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < THREADS; ++t)
+    {
+        threads.emplace_back([&pool, &ids, t] {
+            for (size_t i = 0; i < STRINGS; ++i)
+            {
+                ids[t].push_back(pool.intern("/lib/" + std::to_string(i)));
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    REQUIRE(pool.size() == STRINGS + 1);
+    for (size_t t = 1; t < THREADS; ++t)
+    {
+        REQUIRE(ids[t] == ids[0]);
+    }
+}
@@ -0,0 +1,306 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "catch.hpp"
+
+#include "pfs/defer.hpp"
+#include "pfs/procfs.hpp"
+#include "pfs/tcp_churn.hpp"
+
+namespace {
+
+using state = pfs::net_socket::net_state;
+using event_type = pfs::tcp_churn_event::type;
+
+pfs::net_socket make_socket(uint32_t remote_ip, uint16_t remote_port,
+                            ino_t inode, state st = state::established)
+{
+    pfs::net_socket sock;
+    sock.local_ip         = pfs::ip(pfs::ipv4(htonl(0x0a000001)));
+    sock.local_port       = 443;
+    sock.remote_ip        = pfs::ip(pfs::ipv4(htonl(remote_ip)));
+    sock.remote_port      = remote_port;
+    sock.inode            = inode;
+    sock.socket_net_state = st;
+    return sock;
+}
+
+struct recorder
+{
+    std::vector<pfs::tcp_churn_event> events;
+
+    pfs::tcp_churn_tracker::event_handler handler()
+    {
+        return [this](const pfs::tcp_churn_event& event) {
+            events.push_back(event);
+        };
+    }
+
+    size_t count(event_type type) const
+    {
+        return std::count_if(events.begin(), events.end(),
+                             [type](const pfs::tcp_churn_event& event) {
+                                 return event.event_type == type;
+                             });
+    }
+};
+
+} // anonymous namespace
+
+TEST_CASE("Track TCP churn", "[net][tcp_churn]")
+{
+    static const uint32_t REMOTE = 0x0b000001;
+    static const uint32_t OTHER  = 0x0b000002;
+
+    pfs::tcp_churn_tracker tracker;
+    recorder rec;
+
+    std::vector<pfs::net_socket> sockets = {
+        make_socket(REMOTE, 50000, 100),
+        make_socket(REMOTE, 50001, 101),
+        make_socket(OTHER, 50000, 102),
+    };
+
+    // The baseline reports nothing
+    tracker.update(sockets, rec.handler());
+    REQUIRE(rec.events.empty());
+    REQUIRE(tracker.size() == 3);
+    REQUIRE(tracker.count(state::established) == 3);
+
+    SECTION("No changes")
+    {
+        tracker.update(sockets, rec.handler());
+        REQUIRE(rec.events.empty());
+        REQUIRE(tracker.size() == 3);
+    }
+
+    SECTION("Opened, closed and changed")
+    {
+        sockets.erase(sockets.begin());                           // Closed
+        sockets[0].socket_net_state = state::time_wait;           // Changed
+        sockets[0].inode            = 0;                          // Orphaned
+        sockets.push_back(make_socket(REMOTE, 50002, 103));       // Opened
+        sockets.push_back(make_socket(REMOTE, 50003, 104));       // Opened
+
+        tracker.update(sockets, rec.handler());
+        REQUIRE(rec.count(event_type::opened) == 2);
+        REQUIRE(rec.count(event_type::closed) == 1);
+        REQUIRE(rec.count(event_type::state_changed) == 1);
+
+        auto changed = std::find_if(
+            rec.events.begin(), rec.events.end(),
+            [](const pfs::tcp_churn_event& event) {
+                return event.event_type == event_type::state_changed;
+            });
+        REQUIRE(changed->inode == 101);
+        REQUIRE(changed->previous_state == state::established);
+        REQUIRE(changed->state == state::time_wait);
+
+        auto closed = std::find_if(
+            rec.events.begin(), rec.events.end(),
+            [](const pfs::tcp_churn_event& event) {
+                return event.event_type == event_type::closed;
+            });
+        REQUIRE(closed->inode == 100);
+        REQUIRE(closed->remote_port == 50000);
+
+        REQUIRE(tracker.size() == 4);
+        REQUIRE(tracker.count(state::established) == 3);
+        REQUIRE(tracker.count(state::time_wait) == 1);
+
+        auto remotes = tracker.get_remote_churn();
+        REQUIRE(remotes.size() == 2);
+        auto remote = std::find_if(remotes.begin(), remotes.end(),
+                                   [](const pfs::tcp_remote_churn& churn) {
+                                       return churn.remote_ip ==
+                                              pfs::ip(pfs::ipv4(htonl(REMOTE)));
+                                   });
+        REQUIRE(remote != remotes.end());
+        REQUIRE(remote->connections == 3);
+        REQUIRE(remote->opened == 2);
+        REQUIRE(remote->closed == 1);
+        REQUIRE(remote->open_rate > 0);
+        REQUIRE(remote->close_rate > 0);
+    }
+
+    SECTION("Same 4-tuple with a new inode")
+    {
+        sockets[0].inode = 200;
+
+        tracker.update(sockets, rec.handler());
+        REQUIRE(rec.count(event_type::opened) == 1);
+        REQUIRE(rec.count(event_type::closed) == 1);
+    }
+
+    SECTION("Orphaned, then reused with a new inode")
+    {
+        sockets[1].socket_net_state = state::fin_wait2;
+        sockets[1].inode            = 0;
+
+        tracker.update(sockets, rec.handler());
+        REQUIRE(rec.count(event_type::state_changed) == 1);
+        REQUIRE(rec.count(event_type::opened) == 0);
+        REQUIRE(rec.count(event_type::closed) == 0);
+
+        // Still orphaned
+        rec.events.clear();
+        tracker.update(sockets, rec.handler());
+        REQUIRE(rec.events.empty());
+
+        sockets[1] = make_socket(REMOTE, 50001, 300);
+
+        tracker.update(sockets, rec.handler());
+        REQUIRE(rec.count(event_type::opened) == 1);
+        REQUIRE(rec.count(event_type::closed) == 1);
+        REQUIRE(rec.events.back().event_type == event_type::closed);
+        REQUIRE(rec.events.back().inode == 101);
+        REQUIRE(rec.events.back().state == state::fin_wait2);
+        REQUIRE(tracker.size() == 3);
+        REQUIRE(tracker.count(state::fin_wait2) == 0);
+    }
+
+    SECTION("Idle remotes are forgotten")
+    {
+        sockets.pop_back();
+        tracker.update(sockets);
+        REQUIRE(tracker.get_remote_churn().size() == 2);
+
+        tracker.update(sockets);
+        REQUIRE(tracker.get_remote_churn().size() == 1);
+    }
+}
+
+TEST_CASE("Track TCP churn at scale", "[net][tcp_churn]")
+{
+    static const size_t COUNT = 5000;
+
+    pfs::tcp_churn_tracker tracker;
+
+    std::vector<pfs::net_socket> sockets;
+    for (size_t i = 0; i < COUNT; ++i)
+    {
+        sockets.push_back(
+            make_socket(0x0b000000 + (i % 50), 10000 + i, 1000 + i));
+    }
+    tracker.update(sockets);
+    REQUIRE(tracker.size() == COUNT);
+
+    // Close every other connection, and open as many new ones
+    std::vector<pfs::net_socket> next;
+    for (size_t i = 0; i < COUNT; ++i)
+    {
+        next.push_back((i % 2) ? sockets[i]
+                               : make_socket(0x0c000000, 10000 + i, 9000 + i));
+    }
+
+    recorder rec;
+    tracker.update(next, rec.handler());
+    REQUIRE(rec.count(event_type::opened) == COUNT / 2);
+    REQUIRE(rec.count(event_type::closed) == COUNT / 2);
+    REQUIRE(tracker.size() == COUNT);
+
+    // Everything closed
+    rec.events.clear();
+    tracker.update(std::vector<pfs::net_socket>(), rec.handler());
+    REQUIRE(rec.count(event_type::closed) == COUNT);
+    REQUIRE(tracker.size() == 0);
+    REQUIRE(tracker.count(state::established) == 0);
+}
+
+TEST_CASE("Track TCP churn of live sockets", "[net][tcp_churn]")
+{
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    REQUIRE(listener >= 0);
+    pfs::impl::defer close_listener([listener] { close(listener); });
+
+    sockaddr_in addr     = {};
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    REQUIRE(bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) ==
+            0);
+    REQUIRE(listen(listener, 4) == 0);
+
+    socklen_t len = sizeof(addr);
+    REQUIRE(getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &len) ==
+            0);
+
+    auto net = pfs::procfs().get_net();
+
+    pfs::net_socket_query query;
+    query.remote_ports = {ntohs(addr.sin_port)};
+
+    pfs::tcp_churn_tracker tracker;
+    recorder rec;
+
+    SECTION("Collected")
+    {
+        pfs::net_socket_table table;
+        net.collect_tcp(table, query);
+        tracker.update(table, rec.handler());
+
+        int client = socket(AF_INET, SOCK_STREAM, 0);
+        REQUIRE(client >= 0);
+        pfs::impl::defer close_client([client] { close(client); });
+        REQUIRE(connect(client, reinterpret_cast<sockaddr*>(&addr),
+                        sizeof(addr)) == 0);
+
+        net.collect_tcp(table, query);
+        tracker.update(table, rec.handler());
+        REQUIRE(rec.count(event_type::opened) == 1);
+    }
+
+    SECTION("Closed by the client")
+    {
+        int client = socket(AF_INET, SOCK_STREAM, 0);
+        REQUIRE(client >= 0);
+        REQUIRE(connect(client, reinterpret_cast<sockaddr*>(&addr),
+                        sizeof(addr)) == 0);
+
+        pfs::net_socket_table table;
+        net.collect_tcp(table, query);
+        tracker.update(table, rec.handler());
+        REQUIRE(tracker.count(state::established) == 1);
+
+        // The socket is orphaned, and reported with inode 0 in FIN_WAIT
+        close(client);
+
+        net.collect_tcp(table, query);
+        REQUIRE(table.size() == 1);
+        REQUIRE(table.inode[0] == 0);
+
+        tracker.update(table, rec.handler());
+        REQUIRE(rec.count(event_type::state_changed) == 1);
+        REQUIRE(rec.count(event_type::opened) == 0);
+        REQUIRE(rec.count(event_type::closed) == 0);
+        REQUIRE(rec.events[0].inode != 0);
+        REQUIRE(tracker.count(state::established) == 0);
+    }
+
+    SECTION("Streamed")
+    {
+        auto stream = [&] {
+            tracker.begin();
+            net.get_tcp(query, [&](const pfs::net_socket& socket) {
+                tracker.add(socket, rec.handler());
+                return pfs::filter::action::drop;
+            });
+            tracker.end(rec.handler());
+        };
+
+        stream();
+
+        int client = socket(AF_INET, SOCK_STREAM, 0);
+        REQUIRE(client >= 0);
+        pfs::impl::defer close_client([client] { close(client); });
+        REQUIRE(connect(client, reinterpret_cast<sockaddr*>(&addr),
+                        sizeof(addr)) == 0);
+
+        stream();
+        REQUIRE(rec.count(event_type::opened) == 1);
+        REQUIRE(tracker.count(state::established) == 1);
+    }
+}
@@ -0,0 +1,155 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "catch.hpp"
+
+#include "pfs/defer.hpp"
+#include "pfs/procfs.hpp"
+
+namespace {
+
+struct connection
+{
+    int listener;
+    int client;
+    int server;
+    uint16_t port;
+};
+
+connection connect_loopback()
+{
+    connection conn;
+
+    conn.listener = socket(AF_INET, SOCK_STREAM, 0);
+    REQUIRE(conn.listener >= 0);
+
+    sockaddr_in addr     = {};
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    REQUIRE(bind(conn.listener, reinterpret_cast<sockaddr*>(&addr),
+                 sizeof(addr)) == 0);
+    REQUIRE(listen(conn.listener, 1) == 0);
+
+    socklen_t len = sizeof(addr);
+    REQUIRE(getsockname(conn.listener, reinterpret_cast<sockaddr*>(&addr),
+                        &len) == 0);
+    conn.port = ntohs(addr.sin_port);
+
+    conn.client = socket(AF_INET, SOCK_STREAM, 0);
+    REQUIRE(conn.client >= 0);
+    REQUIRE(connect(conn.client, reinterpret_cast<sockaddr*>(&addr),
+                    sizeof(addr)) == 0);
+
+    conn.server = accept(conn.listener, nullptr, nullptr);
+    REQUIRE(conn.server >= 0);
+
+    return conn;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Log2 histogram", "[net][tcp_health]")
+{
+    pfs::log2_histogram hist;
+
+    REQUIRE(hist.mean() == 0);
+    REQUIRE(hist.percentile(50) == 0);
+
+    for (uint64_t value : {0, 1, 2, 3, 100, 1000})
+    {
+        hist.add(value);
+    }
+
+    REQUIRE(hist.count == 6);
+    REQUIRE(hist.sum == 1106);
+    REQUIRE(hist.min == 0);
+    REQUIRE(hist.max == 1000);
+    REQUIRE(hist.mean() == 184);
+
+    REQUIRE(hist.buckets[0] == 1);
+    REQUIRE(hist.buckets[1] == 1);
+    REQUIRE(hist.buckets[2] == 2);
+    REQUIRE(hist.buckets[7] == 1);
+    REQUIRE(hist.buckets[10] == 1);
+
+    REQUIRE(hist.percentile(0) == 0);
+    REQUIRE(hist.percentile(50) == 3);
+    REQUIRE(hist.percentile(80) == 127);
+    REQUIRE(hist.percentile(100) == 1000);
+
+    hist.add(UINT64_MAX);
+    REQUIRE(hist.buckets[64] == 1);
+    REQUIRE(hist.percentile(100) == UINT64_MAX);
+}
+
+TEST_CASE("Get TCP health", "[net][tcp_health]")
+{
+    auto conn = connect_loopback();
+    pfs::impl::defer cleanup([&conn] {
+        close(conn.server);
+        close(conn.client);
+        close(conn.listener);
+    });
+
+    auto net = pfs::procfs().get_net();
+
+    pfs::tcp_health_options options;
+    options.query.remote_ports = {conn.port};
+
+    SECTION("By remote subnet")
+    {
+        options.ipv4_prefix_len = 8;
+
+        auto health = net.get_tcp_health(options);
+        REQUIRE(health.size() == 1);
+        REQUIRE(health[0].remote_subnet ==
+                pfs::ip(pfs::ipv4(htonl(0x7f000000))));
+        REQUIRE(health[0].prefix_len == 8);
+        REQUIRE(health[0].sockets == 1);
+        REQUIRE(health[0].rtt.count == 1);
+        REQUIRE(health[0].snd_cwnd.min > 0);
+    }
+
+    SECTION("By local port")
+    {
+        options.group_by = pfs::tcp_health::grouping::local_port;
+        options.query.remote_ports.clear();
+        options.query.local_ports = {conn.port};
+
+        // The listener is never included
+        auto health = net.get_tcp_health(options);
+        REQUIRE(health.size() == 1);
+        REQUIRE(health[0].local_port == conn.port);
+        REQUIRE(health[0].sockets == 1);
+    }
+
+    SECTION("By owner")
+    {
+        options.group_by = pfs::tcp_health::grouping::owner;
+        REQUIRE_THROWS_AS(net.get_tcp_health(options), std::invalid_argument);
+
+        auto owners    = pfs::procfs().get_socket_owners();
+        options.owners = &owners;
+
+        auto health = net.get_tcp_health(options);
+        REQUIRE(health.size() == 1);
+        REQUIRE(health[0].pid == getpid());
+        REQUIRE(health[0].sockets == 1);
+    }
+
+    SECTION("Only listening sockets")
+    {
+        options.query.states = {pfs::net_socket::net_state::listen};
+        REQUIRE(net.get_tcp_health(options).empty());
+    }
+
+    SECTION("Without sock_diag")
+    {
+        net.set_backend(pfs::net::backend::procfs);
+        REQUIRE_THROWS_AS(net.get_tcp_health(options), std::runtime_error);
+    }
+}
@@ -239,3 +239,43 @@ TEST_CASE("Readfile", "[utils]")
     file = create_temp_file(content);
     REQUIRE(readfile(file, max, trim) == expected);
 }
+
+TEST_CASE("Parse number in-place", "[utils]")
+{
+    SECTION("Hex, stops at delimiter")
+    {
+        std::string str = "7f0b476c6000-7f0b476c7000";
+        size_t value;
+        auto next = parse_number(str.data(), str.data() + str.size(), value,
+                                 base::hex);
+        REQUIRE(value == 0x7f0b476c6000);
+        REQUIRE(*next == '-');
+    }
+
+    SECTION("Signed")
+    {
+        std::string str = "-1 ";
+        int value;
+        auto next = parse_number(str.data(), str.data() + str.size(), value);
+        REQUIRE(value == -1);
+        REQUIRE(*next == ' ');
+    }
+
+    SECTION("No digits")
+    {
+        std::string str = " 12";
+        unsigned value;
+        REQUIRE_THROWS_AS(
+            parse_number(str.data(), str.data() + str.size(), value),
+            std::invalid_argument);
+    }
+
+    SECTION("Out of range")
+    {
+        std::string str = "1FF";
+        uint8_t value;
+        REQUIRE_THROWS_AS(parse_number(str.data(), str.data() + str.size(),
+                                       value, base::hex),
+                          std::out_of_range);
+    }
+}